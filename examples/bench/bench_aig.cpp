@@ -0,0 +1,233 @@
+#include <sandbox/concurrent_thread_manager.hpp>
+
+#include <mockturtle/aig.hpp>
+#include <mockturtle/compaction.hpp>
+#include <mockturtle/cut.hpp>
+#include <mockturtle/memory_report.hpp>
+#include <mockturtle/parallel_cuts.hpp>
+#include <mockturtle/verilog_reader.hpp>
+#include <lorina/verilog.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* End-to-end benchmark of the AIG flow over a corpus of netlists.
+ *
+ * Every netlist runs through the phases
+ *   read             parse the Verilog file and build the strashed AIG
+ *   strash           rebuild the AIG through a fresh strash table (`compact`)
+ *   cuts_sequential  one `create_static_cut` per gate on one thread
+ *   cuts_parallel    `parallel_cuts` for every thread count, with shared
+ *                    ("shared") and private ("deterministic") marks
+ * and every measurement is printed as one JSON object per line, e.g.
+ *   {"bench":"cuts_parallel","netlist":"adder.v","variant":"shared","threads":4,"nodes":..,"ns":..,"nodes_per_sec":..,"speedup":..,"peak_rss":..}
+ * where `speedup` is relative to `cuts_sequential` and `peak_rss` is the
+ * peak resident memory of the process so far.  Without netlists, a
+ * random AIG with `--generate` gates is benchmarked instead ("read"
+ * then builds it).
+ *
+ * usage: bench_aig [--threads 1,2,4] [--repetitions N] [--generate N] [netlist.v ...]
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+  std::vector<std::uint64_t> threads{1u, 2u, 4u};
+  std::uint64_t repetitions{3u};
+  std::uint64_t generate{1000000u};
+  std::vector<std::string> netlists;
+}; /* options */
+
+std::vector<std::uint64_t> parse_list( std::string_view s )
+{
+  std::vector<std::uint64_t> result;
+  while ( !s.empty() )
+  {
+    auto const comma = s.find( ',' );
+    result.emplace_back( std::stoull( std::string( s.substr( 0, comma ) ) ) );
+    s = comma == std::string_view::npos ? std::string_view{} : s.substr( comma + 1 );
+  }
+  return result;
+}
+
+options parse_options( int argc, char* argv[] )
+{
+  options opts;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string_view const key = argv[i];
+    if ( !key.starts_with( "--" ) )
+      opts.netlists.emplace_back( key );
+    else if ( i + 1 == argc )
+      std::cerr << "[w] missing value of option " << key << '\n';
+    else if ( key == "--threads" )
+      opts.threads = parse_list( argv[++i] );
+    else if ( key == "--repetitions" )
+      opts.repetitions = std::max<std::uint64_t>( 1u, std::stoull( argv[++i] ) );
+    else if ( key == "--generate" )
+      opts.generate = std::stoull( argv[++i] );
+    else
+      std::cerr << "[w] unknown option " << key << '\n';
+  }
+  return opts;
+}
+
+std::uint64_t elapsed_ns( clock_type::time_point start )
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count();
+}
+
+std::string json_string( std::string_view s )
+{
+  std::string result{"\""};
+  for ( char const c : s )
+  {
+    if ( c == '"' || c == '\\' )
+      result += '\\';
+    result += c;
+  }
+  return result + '"';
+}
+
+struct measurement
+{
+  std::string_view bench;
+  std::string_view netlist;
+  std::string_view variant{"-"};
+  std::uint64_t threads{1u};
+  std::uint64_t nodes{0u};
+  std::uint64_t ns{0u};
+  std::uint64_t baseline_ns{0u}; /* for the speedup, if not 0 */
+}; /* measurement */
+
+void report( measurement const& m )
+{
+  std::cout << "{\"bench\":\"" << m.bench << "\",\"netlist\":" << json_string( m.netlist ) << ",\"variant\":\"" << m.variant
+            << "\",\"threads\":" << m.threads << ",\"nodes\":" << m.nodes << ",\"ns\":" << m.ns
+            << ",\"nodes_per_sec\":" << ( m.ns ? m.nodes * 1e9 / m.ns : 0.0 );
+  if ( m.baseline_ns != 0u )
+  {
+    std::cout << ",\"speedup\":" << ( m.ns ? static_cast<double>( m.baseline_ns ) / m.ns : 0.0 );
+  }
+  std::cout << ",\"peak_rss\":" << aig::process_memory_usage().peak_rss << "}\n";
+}
+
+/* `num_gates` random gates over 256 PIs, each with fanins among the 1024 nodes before it */
+void generate_aig( aig::network& ntk, std::uint64_t num_gates )
+{
+  std::mt19937_64 rng( 1u );
+  std::vector<aig::signal> signals;
+  for ( std::uint32_t i = 0; i < 256u; ++i )
+  {
+    signals.emplace_back( ntk.create_pi() );
+  }
+  while ( ntk.num_gates() < num_gates )
+  {
+    std::uint64_t const window = std::min<std::uint64_t>( signals.size(), 1024u );
+    aig::signal const a = signals[signals.size() - 1u - rng() % window];
+    aig::signal const b = signals[signals.size() - 1u - rng() % window];
+    std::uint64_t const size = ntk.size();
+    aig::signal const f = ntk.create_and( rng() & 1u ? a : !a, rng() & 2u ? b : !b );
+    if ( ntk.size() != size )
+    {
+      /* keep only new gates, so that the window never fills with duplicates or constants */
+      signals.emplace_back( f );
+    }
+  }
+  for ( std::uint32_t i = 0; i < 256u; ++i )
+  {
+    ntk.create_po( signals[signals.size() - 1u - i] );
+  }
+}
+
+/* builds the AIG of `netlist` (or a random one if empty) into `store` */
+bool build( aig::storage& store, std::string const& netlist, std::uint64_t num_gates )
+{
+  store = aig::storage();
+  aig::network ntk( store );
+  if ( netlist.empty() )
+  {
+    generate_aig( ntk, num_gates );
+    return true;
+  }
+  return lorina::read_verilog( netlist, aig::verilog_reader( ntk ) ) == lorina::return_code::success;
+}
+
+void bench_netlist( std::string const& netlist, options const& opts )
+{
+  std::string_view const name = netlist.empty() ? std::string_view{"generated"} : std::string_view{netlist};
+
+  aig::storage store;
+  for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+  {
+    auto const start = clock_type::now();
+    if ( !build( store, netlist, opts.generate ) )
+    {
+      std::cerr << "[e] could not read " << netlist << '\n';
+      return;
+    }
+    report( {"read", name, "-", 1u, store.num_nodes(), elapsed_ns( start )} );
+  }
+
+  for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+  {
+    auto const start = clock_type::now();
+    aig::compact( store );
+    report( {"strash", name, "-", 1u, store.num_nodes(), elapsed_ns( start )} );
+  }
+
+  aig::network const ntk( store );
+  std::uint64_t sequential_ns{0u};
+  for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+  {
+    std::uint64_t leaves{0u};
+    auto const start = clock_type::now();
+    std::uint32_t token = ntk.traversal_token( 1u );
+    ntk.foreach_node( [&]( aig::node n ){
+      if ( ntk.is_constant( n ) || ntk.is_pi( n ) )
+        return;
+
+      leaves += aig::create_static_cut( ntk, n, token ).size();
+      token = ntk.release_marks( 1u );
+    } );
+    std::uint64_t const ns = elapsed_ns( start );
+    sequential_ns = r == 0u ? ns : std::min( sequential_ns, ns );
+    report( {"cuts_sequential", name, "-", 1u, ntk.num_gates(), ns} );
+    if ( leaves == 0u && ntk.num_gates() != 0u )
+    {
+      std::cerr << "[e] no cuts in " << name << '\n';
+    }
+  }
+
+  for ( bool const deterministic : {false, true} )
+  {
+    for ( auto const threads : opts.threads )
+    {
+      sandbox::bounded_depth_task_manager<64> tm( threads );
+      for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+      {
+        auto const start = clock_type::now();
+        auto const cuts = aig::parallel_cuts( ntk, tm, aig::parallel_cuts_params{0u, deterministic} );
+        report( {"cuts_parallel", name, deterministic ? "deterministic" : "shared", threads, ntk.num_gates(), elapsed_ns( start ), sequential_ns} );
+      }
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  auto const opts = parse_options( argc, argv );
+  if ( opts.netlists.empty() )
+  {
+    bench_netlist( "", opts );
+  }
+  for ( auto const& netlist : opts.netlists )
+  {
+    bench_netlist( netlist, opts );
+  }
+  return 0;
+}
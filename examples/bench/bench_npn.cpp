@@ -0,0 +1,137 @@
+#include <mockturtle/npn.hpp>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Microbenchmark of `npn_canonize` on five- and six-variable functions.
+ *
+ * Every family of `--functions` functions is canonized without a cache:
+ *   parity     the XOR of all variables (fully symmetric)
+ *   majority   threshold functions on the number of ones (fully symmetric)
+ *   symmetric  random functions of the number of ones
+ *   random     uniformly random truth tables
+ *   sparse     random truth tables with few minterms
+ * and every measurement is printed as one JSON object per line, e.g.
+ *   {"bench":"npn_canonize","family":"random","vars":6,"functions":1000,"ns":..,"ns_per_function":..}
+ *
+ * usage: bench_npn [--vars 5,6] [--functions N] [--repetitions N]
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+  std::vector<std::uint64_t> vars{5u, 6u};
+  std::uint64_t functions{1000u}; /* per family */
+  std::uint64_t repetitions{3u};
+}; /* options */
+
+std::vector<std::uint64_t> parse_list( std::string_view s )
+{
+  std::vector<std::uint64_t> result;
+  while ( !s.empty() )
+  {
+    auto const comma = s.find( ',' );
+    result.emplace_back( std::stoull( std::string( s.substr( 0, comma ) ) ) );
+    s = comma == std::string_view::npos ? std::string_view{} : s.substr( comma + 1 );
+  }
+  return result;
+}
+
+options parse_options( int argc, char* argv[] )
+{
+  options opts;
+  for ( int i = 1; i + 1 < argc; i += 2 )
+  {
+    std::string_view const key = argv[i];
+    if ( key == "--vars" )
+      opts.vars = parse_list( argv[i + 1] );
+    else if ( key == "--functions" )
+      opts.functions = std::max<std::uint64_t>( 1u, std::stoull( argv[i + 1] ) );
+    else if ( key == "--repetitions" )
+      opts.repetitions = std::max<std::uint64_t>( 1u, std::stoull( argv[i + 1] ) );
+    else
+      std::cerr << "[w] unknown option " << key << '\n';
+  }
+  return opts;
+}
+
+std::uint64_t elapsed_ns( clock_type::time_point start )
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count();
+}
+
+void report( std::string_view family, std::uint64_t vars, std::uint64_t functions, std::uint64_t ns )
+{
+  std::cout << "{\"bench\":\"npn_canonize\",\"family\":\"" << family << "\",\"vars\":" << vars
+            << ",\"functions\":" << functions << ",\"ns\":" << ns
+            << ",\"ns_per_function\":" << ( functions ? static_cast<double>( ns ) / functions : 0.0 ) << "}\n";
+}
+
+/* the function of `num_vars` variables that is `values` bit `popcount( x )` at every minterm `x` */
+std::uint64_t symmetric_function( std::uint32_t num_vars, std::uint64_t values )
+{
+  std::uint64_t tt{0};
+  for ( std::uint64_t x = 0; x < ( 1ull << num_vars ); ++x )
+  {
+    tt |= ( ( values >> std::popcount( x ) ) & 1u ) << x;
+  }
+  return tt;
+}
+
+void bench_family( std::string_view family, std::uint32_t num_vars, std::vector<std::uint64_t> const& functions, options const& opts )
+{
+  for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+  {
+    std::uint64_t checksum{0};
+    auto const start = clock_type::now();
+    for ( auto const tt : functions )
+    {
+      checksum += aig::npn_canonize( tt, num_vars ).representative;
+    }
+    std::uint64_t const ns = elapsed_ns( start );
+    std::uint64_t volatile sink = checksum; /* keeps the canonization alive */
+    (void)sink;
+    report( family, num_vars, functions.size(), ns );
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  auto const opts = parse_options( argc, argv );
+
+  std::mt19937_64 rng( 0x5eed );
+  for ( auto const vars : opts.vars )
+  {
+    if ( vars < 5u || vars > 6u )
+    {
+      std::cerr << "[w] skipping " << vars << " variables (only 5 and 6 are searched)\n";
+      continue;
+    }
+    std::uint32_t const num_vars = static_cast<std::uint32_t>( vars );
+    std::uint64_t const mask = aig::detail::truth_table_mask( num_vars );
+
+    std::vector<std::uint64_t> parity, majority, symmetric, random, sparse;
+    for ( std::uint64_t i = 0; i < opts.functions; ++i )
+    {
+      parity.emplace_back( symmetric_function( num_vars, 0xaaaaaaaaaaaaaaaaull ) );
+      majority.emplace_back( symmetric_function( num_vars, ~0ull << ( 1u + i % num_vars ) ) );
+      symmetric.emplace_back( symmetric_function( num_vars, rng() ) );
+      random.emplace_back( rng() & mask );
+      sparse.emplace_back( rng() & rng() & rng() & mask );
+    }
+    bench_family( "parity", num_vars, parity, opts );
+    bench_family( "majority", num_vars, majority, opts );
+    bench_family( "symmetric", num_vars, symmetric, opts );
+    bench_family( "random", num_vars, random, opts );
+    bench_family( "sparse", num_vars, sparse, opts );
+  }
+
+  return 0;
+}
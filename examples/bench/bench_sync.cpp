@@ -0,0 +1,223 @@
+#include <sandbox/concurrent_thread_manager.hpp>
+#include <sandbox/work_stealing_task_manager.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Microbenchmarks for the synchronization primitives and task managers.
+ *
+ * Every measurement is printed as one JSON object per line, e.g.
+ *   {"bench":"queue_throughput","variant":"lock_free","threads":4,"ops":1000000,"ns":..,"ops_per_sec":..}
+ *
+ * usage: bench_sync [--threads 1,2,4] [--ops N] [--task-size N] [--repetitions N]
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+  std::vector<std::uint64_t> threads{1u, 2u, 4u};
+  std::uint64_t ops{200000u};
+  std::uint64_t task_size{0u};  /* busy-loop iterations per task */
+  std::uint64_t repetitions{3u};
+}; /* options */
+
+std::vector<std::uint64_t> parse_list( std::string_view s )
+{
+  std::vector<std::uint64_t> result;
+  while ( !s.empty() )
+  {
+    auto const comma = s.find( ',' );
+    result.emplace_back( std::stoull( std::string( s.substr( 0, comma ) ) ) );
+    s = comma == std::string_view::npos ? std::string_view{} : s.substr( comma + 1 );
+  }
+  return result;
+}
+
+options parse_options( int argc, char* argv[] )
+{
+  options opts;
+  for ( int i = 1; i + 1 < argc; i += 2 )
+  {
+    std::string_view const key = argv[i];
+    if ( key == "--threads" )
+      opts.threads = parse_list( argv[i + 1] );
+    else if ( key == "--ops" )
+      opts.ops = std::stoull( argv[i + 1] );
+    else if ( key == "--task-size" )
+      opts.task_size = std::stoull( argv[i + 1] );
+    else if ( key == "--repetitions" )
+      opts.repetitions = std::stoull( argv[i + 1] );
+    else
+      std::cerr << "[w] unknown option " << key << '\n';
+  }
+  return opts;
+}
+
+std::uint64_t elapsed_ns( clock_type::time_point start )
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count();
+}
+
+/* keeps the compiler from optimizing the busy loop away */
+inline void busy_work( std::uint64_t iterations )
+{
+  std::uint64_t volatile sink = 0;
+  for ( std::uint64_t i = 0; i < iterations; ++i )
+  {
+    sink = sink + i;
+  }
+}
+
+void report( std::string_view bench, std::string_view variant, std::uint64_t threads, std::uint64_t ops, std::uint64_t ns )
+{
+  std::cout << "{\"bench\":\"" << bench << "\",\"variant\":\"" << variant << "\",\"threads\":" << threads
+            << ",\"ops\":" << ops << ",\"ns\":" << ns
+            << ",\"ns_per_op\":" << ( ops ? static_cast<double>( ns ) / ops : 0.0 )
+            << ",\"ops_per_sec\":" << ( ns ? ops * 1e9 / ns : 0.0 ) << "}\n";
+}
+
+/* `threads` producers and `threads` consumers move `ops` items through the queue */
+template<typename Queue>
+void bench_queue( std::string_view variant, options const& opts )
+{
+  for ( auto const threads : opts.threads )
+  {
+    for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+    {
+      Queue q;
+      std::uint64_t const per_thread = opts.ops / threads;
+      std::atomic<std::uint64_t> checksum{0};
+
+      auto const start = clock_type::now();
+      {
+        std::vector<std::jthread> members;
+        for ( std::uint64_t t = 0; t < threads; ++t )
+        {
+          members.emplace_back( [&]{
+            for ( std::uint64_t i = 0; i < per_thread; ++i )
+            {
+              q.enqueue( i );
+            }
+          } );
+          members.emplace_back( [&]{
+            std::uint64_t sum{0};
+            for ( std::uint64_t i = 0; i < per_thread; ++i )
+            {
+              sum += q.dequeue();
+            }
+            checksum.fetch_add( sum );
+          } );
+        }
+      }
+      report( "queue_throughput", variant, threads, per_thread * threads, elapsed_ns( start ) );
+    }
+  }
+}
+
+/* lock/unlock of an uncontended lock, then `threads` threads incrementing one counter under the lock */
+template<typename Mutex>
+void bench_lock( std::string_view variant, options const& opts )
+{
+  for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+  {
+    Mutex m;
+    std::uint64_t counter{0};
+    auto const start = clock_type::now();
+    for ( std::uint64_t i = 0; i < opts.ops; ++i )
+    {
+      std::scoped_lock l( m );
+      ++counter;
+    }
+    report( "lock_uncontended", variant, 1u, counter, elapsed_ns( start ) );
+  }
+
+  for ( auto const threads : opts.threads )
+  {
+    for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+    {
+      Mutex m;
+      std::uint64_t counter{0};
+      std::uint64_t const per_thread = opts.ops / threads;
+
+      auto const start = clock_type::now();
+      {
+        std::vector<std::jthread> members;
+        for ( std::uint64_t t = 0; t < threads; ++t )
+        {
+          members.emplace_back( [&]{
+            for ( std::uint64_t i = 0; i < per_thread; ++i )
+            {
+              std::scoped_lock l( m );
+              ++counter;
+              busy_work( opts.task_size );
+            }
+          } );
+        }
+      }
+      report( "lock_contended", variant, threads, counter, elapsed_ns( start ) );
+    }
+  }
+}
+
+/* time from `submit` until the task starts running, as percentiles over all tasks */
+template<typename TaskManager>
+void bench_task_latency( std::string_view variant, options const& opts )
+{
+  for ( auto const threads : opts.threads )
+  {
+    for ( std::uint64_t r = 0; r < opts.repetitions; ++r )
+    {
+      std::vector<std::uint64_t> latencies( opts.ops );
+      auto const start = clock_type::now();
+      {
+        TaskManager tm( threads );
+        for ( std::uint64_t i = 0; i < opts.ops; ++i )
+        {
+          tm.submit( [&latencies, i, submitted = clock_type::now(), size = opts.task_size]{
+            latencies[i] = elapsed_ns( submitted );
+            busy_work( size );
+          } );
+        }
+      }
+      auto const total = elapsed_ns( start );
+
+      std::sort( latencies.begin(), latencies.end() );
+      auto const percentile = [&]( double p ){
+        return latencies.empty() ? 0u : latencies[static_cast<std::size_t>( p * ( latencies.size() - 1 ) )];
+      };
+      std::cout << "{\"bench\":\"submit_latency\",\"variant\":\"" << variant << "\",\"threads\":" << threads
+                << ",\"ops\":" << opts.ops << ",\"task_size\":" << opts.task_size << ",\"ns\":" << total
+                << ",\"p50_ns\":" << percentile( 0.5 ) << ",\"p90_ns\":" << percentile( 0.9 )
+                << ",\"p99_ns\":" << percentile( 0.99 ) << ",\"max_ns\":" << percentile( 1.0 ) << "}\n";
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  auto const opts = parse_options( argc, argv );
+
+  constexpr std::uint64_t depth = 1024u;
+  bench_queue<sandbox::concurrent_bounded_queue<std::uint64_t, depth, sandbox::spin_mutex>>( "bounded/spin_mutex", opts );
+  bench_queue<sandbox::concurrent_bounded_queue<std::uint64_t, depth, sandbox::ticket_mutex>>( "bounded/ticket_mutex", opts );
+  bench_queue<sandbox::concurrent_bounded_queue<std::uint64_t, depth, sandbox::padded_ticket_mutex<>>>( "bounded/padded_ticket_mutex", opts );
+  bench_queue<sandbox::concurrent_bounded_queue<std::uint64_t, depth, sandbox::hybrid_mutex<>>>( "bounded/hybrid_mutex", opts );
+  bench_queue<sandbox::concurrent_bounded_queue<std::uint64_t, depth, std::mutex>>( "bounded/std_mutex", opts );
+  bench_queue<sandbox::lock_free_bounded_queue<std::uint64_t, depth>>( "lock_free", opts );
+
+  bench_lock<sandbox::spin_mutex>( "spin_mutex", opts );
+  bench_lock<sandbox::ticket_mutex>( "ticket_mutex", opts );
+  bench_lock<sandbox::padded_ticket_mutex<>>( "padded_ticket_mutex", opts );
+  bench_lock<sandbox::hybrid_mutex<>>( "hybrid_mutex", opts );
+  bench_lock<std::mutex>( "std_mutex", opts );
+
+  bench_task_latency<sandbox::bounded_depth_task_manager<depth>>( "bounded_depth", opts );
+  bench_task_latency<sandbox::bounded_depth_task_manager<depth, sandbox::lock_free_bounded_queue>>( "bounded_depth/lock_free", opts );
+  bench_task_latency<sandbox::work_stealing_task_manager<depth>>( "work_stealing", opts );
+
+  return 0;
+}
@@ -1,7 +1,9 @@
+#include <atomic>
 #include <concepts>
 #include <thread>
 #include <vector>
 #include <iostream>
+#include <ranges>
 
 namespace stdv = std::views;
 
@@ -1,6 +1,7 @@
 #include <atomic_wait/atomic_wait.hpp>
 #include <queue>
 #include <mutex>
+#include <optional>
 
 template<typename T, std::uint64_t QueueDepth>
 struct concurrent_bounded_queue
@@ -1,7 +1,9 @@
 #include <sandbox/concurrent_thread_manager.hpp>
+#include <sandbox/verilog_pipeline.hpp>
 
 #include <mockturtle/aig.hpp>
 #include <mockturtle/cut.hpp>
+#include <mockturtle/parallel_cuts.hpp>
 #include <mockturtle/verilog_reader.hpp>
 #include <lorina/verilog.hpp>
 #include <iostream>
@@ -11,8 +13,9 @@ int main()
   aig::storage store;
   aig::network aig( store );
 
+  /* parse on a second thread while the AIG is built on this one */
   lorina::diagnostic_engine diag;
-  if ( lorina::read_verilog( "voter.v", aig::verilog_reader( aig ), &diag ) != lorina::return_code::success )
+  if ( sandbox::read_verilog_pipelined( "voter.v", aig::verilog_reader( aig ), &diag ) != lorina::return_code::success )
   {
     std::cerr << "parsing failed" << std::endl;
     return EXIT_FAILURE;
@@ -37,21 +40,16 @@ int main()
   }
 #endif
 
-#if 0
+#if 1
   {
-    /* concurrently iterate over all nodes */
+    /* concurrently compute one cut per node, then print them in node order */
     sandbox::bounded_depth_task_manager<64> tm( 6 );
+    auto const cuts = aig::parallel_cuts( aig, tm );
     aig.foreach_node( [&]( aig::node n ){
       if ( aig.is_constant( n ) )
         return;
 
-      tm.submit( [&]{
-        auto cut = aig::create_cut( aig, n, 1u );
-        print_cut( cut );
-        aig::release_cut( aig, n, cut, 1u );
-      });
-
-      return;
+      print_cut( cuts.cut( n ) );
     });
   }
 #endif
@@ -2,14 +2,81 @@
 
 #include <atomic_wait/atomic_wait.hpp>
 #include <any_invocable/any_invocable.hpp>
+#include <sandbox/cpu_topology.hpp>
+#include <algorithm>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace sandbox
 {
 
+/* 64 bytes on x86-64; fixed here since std::hardware_destructive_interference_size varies with -mtune */
+inline constexpr std::size_t cache_line_size = 64u;
+
+namespace detail
+{
+
+/* identifies the worker thread (and the task manager owning it) that executes the current code */
+struct worker_info
+{
+  void const* owner{nullptr};
+  std::uint64_t index{0};
+}; /* worker_info */
+
+inline thread_local worker_info current_worker;
+
+/* number of indices per task; a grain of zero picks enough chunks to keep every worker busy a few times over */
+inline std::uint64_t chunk_size( std::uint64_t count, std::uint64_t grain, std::uint64_t num_workers )
+{
+  if ( grain != 0 )
+  {
+    return grain;
+  }
+  return std::max<std::uint64_t>( 1u, count / ( 4u * ( num_workers + 1u ) ) );
+}
+
+/* fire-and-forget submission of `fn( i )` for all i in [first, last), one task per chunk */
+template<typename TaskManager, typename T, typename Fn>
+void submit_chunks( TaskManager& tm, T first, T last, std::uint64_t grain, Fn const& fn )
+{
+  if ( first == last )
+  {
+    return;
+  }
+
+  auto const chunk = chunk_size( last - first, grain, tm.num_workers() );
+  for ( auto begin = first; begin != last; )
+  {
+    auto const end = static_cast<T>( begin + std::min<std::uint64_t>( chunk, last - begin ) );
+    tm.submit( [fn, begin, end]{
+      for ( auto i = begin; i != end; ++i )
+      {
+        fn( i );
+      }
+    } );
+    begin = end;
+  }
+}
+
+} // detail
+
 struct spin_mutex
 {
 public:
@@ -59,6 +126,137 @@ private:
   std::atomic<int> out = ATOMIC_VAR_INIT( 0 );
 }; /* ticket_mutex */
 
+namespace detail
+{
+
+/* hint to the CPU that we are busy-waiting */
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile( "yield" ::: "memory" );
+#else
+  std::this_thread::yield();
+#endif
+}
+
+} // detail
+
+/* A ticket lock for contended use.
+ *
+ * `in` and `out` live on separate cache lines, so taking a ticket does
+ * not invalidate the line that the waiters are polling.  A waiter
+ * backs off proportionally to its distance to the head of the line
+ * and parks after `SpinLimit` rounds; `unlock` only notifies if
+ * somebody is parked.
+ */
+template<std::uint32_t BackoffBase = 32u, std::uint32_t SpinLimit = 64u>
+struct padded_ticket_mutex
+{
+public:
+  void lock()
+  {
+    auto const my = in.fetch_add( 1, std::memory_order_relaxed );
+    std::uint32_t rounds{0};
+    while ( true )
+    {
+      auto const now = out.load( std::memory_order_acquire );
+      if ( now == my )
+      {
+        return;
+      }
+
+      if ( rounds++ < SpinLimit )
+      {
+        for ( std::uint32_t i = 0; i < ( my - now ) * BackoffBase; ++i )
+        {
+          detail::cpu_relax();
+        }
+        continue;
+      }
+
+      waiters.fetch_add( 1 );
+      if ( out.load() == now )
+      {
+        std::atomic_wait_explicit( &out, now, std::memory_order_relaxed );
+      }
+      waiters.fetch_sub( 1, std::memory_order_relaxed );
+    }
+  }
+
+  bool try_lock()
+  {
+    auto now = out.load( std::memory_order_acquire );
+    return in.compare_exchange_strong( now, now + 1, std::memory_order_acquire, std::memory_order_relaxed );
+  }
+
+  void unlock()
+  {
+    out.fetch_add( 1 );
+    if ( waiters.load() > 0u )
+    {
+      std::atomic_notify_all( &out );
+    }
+  }
+
+private:
+  alignas( cache_line_size ) std::atomic<std::uint32_t> in = ATOMIC_VAR_INIT( 0 );
+  alignas( cache_line_size ) std::atomic<std::uint32_t> out = ATOMIC_VAR_INIT( 0 );
+  alignas( cache_line_size ) std::atomic<std::uint32_t> waiters = ATOMIC_VAR_INIT( 0 );
+}; /* padded_ticket_mutex */
+
+/* A spin-then-park mutex.
+ *
+ * The state is 0 (free), 1 (locked) or 2 (locked, possibly with
+ * parked waiters).  A contended `lock` first spins for `SpinLimit`
+ * pause rounds, polling with plain loads, before it marks the lock as
+ * contended and parks; `unlock` only notifies if the lock was marked.
+ */
+template<std::uint32_t SpinLimit = 128u>
+struct hybrid_mutex
+{
+public:
+  void lock()
+  {
+    if ( try_lock() )
+    {
+      return;
+    }
+
+    for ( std::uint32_t i = 0; i < SpinLimit; ++i )
+    {
+      detail::cpu_relax();
+      if ( state.load( std::memory_order_relaxed ) == 0u && try_lock() )
+      {
+        return;
+      }
+    }
+
+    while ( state.exchange( 2u, std::memory_order_acquire ) != 0u )
+    {
+      std::atomic_wait_explicit( &state, 2u, std::memory_order_relaxed );
+    }
+  }
+
+  bool try_lock()
+  {
+    std::uint32_t expected{0};
+    return state.compare_exchange_strong( expected, 1u, std::memory_order_acquire, std::memory_order_relaxed );
+  }
+
+  void unlock()
+  {
+    if ( state.exchange( 0u, std::memory_order_release ) == 2u )
+    {
+      std::atomic_notify_one( &state );
+    }
+  }
+
+private:
+  alignas( cache_line_size ) std::atomic<std::uint32_t> state = ATOMIC_VAR_INIT( 0 );
+}; /* hybrid_mutex */
+
 struct thread_group
 {
 public:
@@ -70,11 +268,43 @@ public:
     }
   }
 
+  /* each member is started with its index in the group */
+  thread_group( std::uint64_t n, std::invocable<std::stop_token, std::uint64_t> auto&& f )
+    : thread_group( n, thread_placement::none(), f )
+  {}
+
+  /* each member is started with its index in the group and pinned according to `placement` */
+  thread_group( std::uint64_t n, thread_placement const& placement, std::invocable<std::stop_token, std::uint64_t> auto&& f )
+  {
+    auto const& topology = cpu_topology::system();
+    std::vector<std::optional<std::uint32_t>> cpus;
+    for ( auto i : std::views::iota( 0ul, n ) )
+    {
+      cpus.emplace_back( placement.cpu_for( i, topology ) );
+      nodes.emplace_back( cpus.back() ? topology.node_of( *cpus.back() ) : 0u );
+    }
+
+    for ( auto i : std::views::iota( 0ul, n ) )
+    {
+      members.emplace_back( f, i );
+      if ( cpus[i] )
+      {
+        detail::pin_thread( members.back(), *cpus[i] );
+      }
+    }
+  }
+
   auto size() const
   {
     return members.size();
   }
 
+  /* NUMA node the member with index `index` is pinned to (0 for unpinned members) */
+  std::uint32_t numa_node( std::uint64_t index ) const
+  {
+    return index < nodes.size() ? nodes[index] : 0u;
+  }
+
   void request_stop()
   {
     for ( std::jthread& t : members )
@@ -83,11 +313,23 @@ public:
     }
   }
 
+  void join()
+  {
+    for ( std::jthread& t : members )
+    {
+      if ( t.joinable() )
+      {
+        t.join();
+      }
+    }
+  }
+
 private:
   std::vector<std::jthread> members;
+  std::vector<std::uint32_t> nodes;
 };
 
-template<typename T, std::uint64_t QueueDepth>
+template<typename T, std::uint64_t QueueDepth, typename Mutex = ticket_mutex>
 struct concurrent_bounded_queue
 {
 public:
@@ -148,17 +390,472 @@ private:
 
 private:
   std::queue<T> items;
-  ticket_mutex items_mutex;
+  Mutex items_mutex;
   std::counting_semaphore<QueueDepth> items_produced{0};
   std::counting_semaphore<QueueDepth> remaining_space{QueueDepth};
 }; /* concurrent_bounded_queue */
 
-template<std::uint64_t QueueDepth>
+/* A bounded multi-producer multi-consumer queue on a fixed ring of slots.
+ *
+ * Each slot carries a sequence number that tells producers and
+ * consumers whether the slot is free or filled for the current lap
+ * around the ring, so the hot path is a single CAS on the head or
+ * tail counter and items are constructed in place without any heap
+ * allocation.  The blocking `enqueue` and `dequeue` only park on an
+ * atomic event counter when the queue is full or empty, and the
+ * opposite side only notifies when somebody is actually waiting.
+ */
+template<typename T, std::uint64_t QueueDepth>
+struct lock_free_bounded_queue
+{
+  static_assert( QueueDepth > 0u && ( QueueDepth & ( QueueDepth - 1u ) ) == 0u, "QueueDepth must be a power of two" );
+
+public:
+  lock_free_bounded_queue()
+    : slots( std::make_unique<slot[]>( QueueDepth ) )
+  {
+    for ( auto i : std::views::iota( 0ul, QueueDepth ) )
+    {
+      slots[i].sequence.store( i, std::memory_order_relaxed );
+    }
+  }
+
+  ~lock_free_bounded_queue()
+  {
+    while ( try_dequeue() )
+      ;
+  }
+
+  lock_free_bounded_queue( lock_free_bounded_queue const& ) = delete;
+  lock_free_bounded_queue& operator=( lock_free_bounded_queue const& ) = delete;
+
+  void enqueue( std::convertible_to<T> auto&& u )
+  {
+    while ( !try_enqueue( std::forward<decltype( u )>( u ) ) )
+    {
+      wait( not_full, [&]{ return enqueue_pos.load() - dequeue_pos.load() < QueueDepth; } );
+    }
+  }
+
+  bool try_enqueue( std::convertible_to<T> auto&& u )
+  {
+    std::uint64_t pos = enqueue_pos.load( std::memory_order_relaxed );
+    slot* s;
+    while ( true )
+    {
+      s = &slots[pos & mask];
+      auto const seq = s->sequence.load( std::memory_order_acquire );
+      auto const diff = static_cast<std::int64_t>( seq ) - static_cast<std::int64_t>( pos );
+      if ( diff == 0 )
+      {
+        if ( enqueue_pos.compare_exchange_weak( pos, pos + 1u, std::memory_order_relaxed ) )
+        {
+          break;
+        }
+      }
+      else if ( diff < 0 )
+      {
+        /* the slot still holds an item from the previous lap */
+        return false;
+      }
+      else
+      {
+        pos = enqueue_pos.load( std::memory_order_relaxed );
+      }
+    }
+
+    new ( s->data() ) T( std::forward<decltype( u )>( u ) );
+    s->sequence.store( pos + 1u, std::memory_order_release );
+    notify( not_empty );
+    return true;
+  }
+
+  T dequeue()
+  {
+    while ( true )
+    {
+      if ( auto tmp = try_dequeue() )
+      {
+        return std::move( *tmp );
+      }
+      wait( not_empty, [&]{ return enqueue_pos.load() != dequeue_pos.load(); } );
+    }
+  }
+
+  std::optional<T> try_dequeue()
+  {
+    std::uint64_t pos = dequeue_pos.load( std::memory_order_relaxed );
+    slot* s;
+    while ( true )
+    {
+      s = &slots[pos & mask];
+      auto const seq = s->sequence.load( std::memory_order_acquire );
+      auto const diff = static_cast<std::int64_t>( seq ) - static_cast<std::int64_t>( pos + 1u );
+      if ( diff == 0 )
+      {
+        if ( dequeue_pos.compare_exchange_weak( pos, pos + 1u, std::memory_order_relaxed ) )
+        {
+          break;
+        }
+      }
+      else if ( diff < 0 )
+      {
+        /* the slot has not been filled for this lap yet */
+        return {};
+      }
+      else
+      {
+        pos = dequeue_pos.load( std::memory_order_relaxed );
+      }
+    }
+
+    std::optional<T> tmp( std::move( *s->data() ) );
+    s->data()->~T();
+    s->sequence.store( pos + QueueDepth, std::memory_order_release );
+    notify( not_full );
+    return tmp;
+  }
+
+private:
+  static constexpr std::uint64_t mask = QueueDepth - 1u;
+
+  struct slot
+  {
+    T* data()
+    {
+      return std::launder( reinterpret_cast<T*>( storage ) );
+    }
+
+    std::atomic<std::uint64_t> sequence;
+    alignas( T ) std::byte storage[sizeof( T )];
+  }; /* slot */
+
+  struct alignas( cache_line_size ) event
+  {
+    std::atomic<std::uint32_t> epoch = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint32_t> waiters = ATOMIC_VAR_INIT( 0 );
+  }; /* event */
+
+  void notify( event& e )
+  {
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( e.waiters.load( std::memory_order_relaxed ) > 0u )
+    {
+      e.epoch.fetch_add( 1u, std::memory_order_release );
+      std::atomic_notify_one( &e.epoch );
+    }
+  }
+
+  void wait( event& e, auto&& ready )
+  {
+    auto const epoch = e.epoch.load( std::memory_order_acquire );
+    e.waiters.fetch_add( 1u );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( !ready() )
+    {
+      std::atomic_wait_explicit( &e.epoch, epoch, std::memory_order_acquire );
+    }
+    e.waiters.fetch_sub( 1u );
+  }
+
+private:
+  alignas( cache_line_size ) std::atomic<std::uint64_t> enqueue_pos = ATOMIC_VAR_INIT( 0 );
+  alignas( cache_line_size ) std::atomic<std::uint64_t> dequeue_pos = ATOMIC_VAR_INIT( 0 );
+  event not_empty;
+  event not_full;
+  std::unique_ptr<slot[]> slots;
+}; /* lock_free_bounded_queue */
+
+/* tag selecting the `submit` overloads that return a `task_future` */
+struct use_future_t
+{
+  explicit use_future_t() = default;
+}; /* use_future_t */
+
+inline constexpr use_future_t use_future{};
+
+/* A future for the result of a submitted task.
+ *
+ * Waiting does not block the calling thread: until the result is
+ * available, it executes other tasks of the task manager the task was
+ * submitted to.
+ */
+template<typename T>
+class task_future
+{
+public:
+  using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+  struct shared_state
+  {
+    std::atomic<bool> ready = ATOMIC_VAR_INIT( false );
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    void* task_manager{nullptr};
+    bool ( *progress )( void* ){nullptr};
+  }; /* shared_state */
+
+  task_future() = default;
+
+  explicit task_future( std::shared_ptr<shared_state> state )
+    : state( std::move( state ) )
+  {}
+
+  bool valid() const
+  {
+    return state != nullptr;
+  }
+
+  bool is_ready() const
+  {
+    return state->ready.load( std::memory_order_acquire );
+  }
+
+  void wait() const
+  {
+    while ( !is_ready() )
+    {
+      if ( !state->progress( state->task_manager ) )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  T get()
+  {
+    wait();
+    if ( state->error )
+    {
+      std::rethrow_exception( state->error );
+    }
+    if constexpr ( !std::is_void_v<T> )
+    {
+      return std::move( *state->value );
+    }
+  }
+
+private:
+  std::shared_ptr<shared_state> state;
+}; /* task_future */
+
+namespace detail
+{
+
+/* awaitable returned by `schedule()`: suspends the coroutine and resumes it as a task of `tm` */
+template<typename TaskManager>
+struct schedule_awaiter
+{
+  TaskManager& tm;
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void await_suspend( std::coroutine_handle<> h )
+  {
+    tm.submit( [h]{ h.resume(); } );
+  }
+
+  void await_resume() const noexcept
+  {}
+}; /* schedule_awaiter */
+
+} // detail
+
+namespace detail
+{
+
+template<typename TaskManager, typename Fn>
+auto submit_with_future( TaskManager& tm, Fn&& fn )
+{
+  using result_type = std::invoke_result_t<std::decay_t<Fn>&>;
+  using state_type = typename task_future<result_type>::shared_state;
+
+  auto state = std::make_shared<state_type>();
+  state->task_manager = &tm;
+  state->progress = []( void* p ){ return static_cast<TaskManager*>( p )->make_progress(); };
+
+  tm.submit( [state, fn = std::forward<Fn>( fn )]() mutable {
+    try
+    {
+      if constexpr ( std::is_void_v<result_type> )
+      {
+        fn();
+        state->value.emplace();
+      }
+      else
+      {
+        state->value.emplace( fn() );
+      }
+    }
+    catch ( ... )
+    {
+      state->error = std::current_exception();
+    }
+    state->ready.store( true, std::memory_order_release );
+  } );
+
+  return task_future<result_type>( std::move( state ) );
+}
+
+} // detail
+
+/* scheduler counters of one worker (or of all external threads) */
+struct worker_statistics
+{
+  std::uint64_t tasks_executed{0};
+  std::uint64_t blocked_ns{0};          /* time spent waiting for a task in `dequeue` (or parked) */
+  std::uint64_t submit_backpressure{0}; /* `submit` found the queue full and fell back to `make_progress` */
+  std::uint64_t steal_attempts{0};
+  std::uint64_t steal_successes{0};
+
+  worker_statistics& operator+=( worker_statistics const& other )
+  {
+    tasks_executed += other.tasks_executed;
+    blocked_ns += other.blocked_ns;
+    submit_backpressure += other.submit_backpressure;
+    steal_attempts += other.steal_attempts;
+    steal_successes += other.steal_successes;
+    return *this;
+  }
+}; /* worker_statistics */
+
+/* snapshot of the counters of a task manager; the last entry accumulates all non-worker threads */
+struct scheduler_statistics
+{
+  std::vector<worker_statistics> workers;
+
+  worker_statistics total() const
+  {
+    worker_statistics sum;
+    for ( auto const& w : workers )
+    {
+      sum += w;
+    }
+    return sum;
+  }
+}; /* scheduler_statistics */
+
+namespace detail
+{
+
+/* Per-worker scheduler counters, enabled by a task manager's `Telemetry` parameter.
+ *
+ * Each worker updates its own cache line with relaxed increments; the
+ * disabled specialization is empty and all of its members are no-ops.
+ */
+template<bool Enabled>
+class scheduler_telemetry
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit scheduler_telemetry( std::uint64_t num_workers )
+    : counters( num_workers + 1u )
+  {}
+
+  void executed( std::uint64_t index )
+  {
+    counters[index].tasks_executed.fetch_add( 1u, std::memory_order_relaxed );
+  }
+
+  void backpressure( std::uint64_t index )
+  {
+    counters[index].submit_backpressure.fetch_add( 1u, std::memory_order_relaxed );
+  }
+
+  void steal( std::uint64_t index, bool success )
+  {
+    counters[index].steal_attempts.fetch_add( 1u, std::memory_order_relaxed );
+    if ( success )
+    {
+      counters[index].steal_successes.fetch_add( 1u, std::memory_order_relaxed );
+    }
+  }
+
+  clock::time_point start_blocking() const
+  {
+    return clock::now();
+  }
+
+  void stop_blocking( std::uint64_t index, clock::time_point start )
+  {
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - start ).count();
+    counters[index].blocked_ns.fetch_add( static_cast<std::uint64_t>( ns ), std::memory_order_relaxed );
+  }
+
+  scheduler_statistics snapshot() const
+  {
+    scheduler_statistics st;
+    for ( auto const& c : counters )
+    {
+      st.workers.emplace_back( worker_statistics{c.tasks_executed.load( std::memory_order_relaxed ),
+                                                 c.blocked_ns.load( std::memory_order_relaxed ),
+                                                 c.submit_backpressure.load( std::memory_order_relaxed ),
+                                                 c.steal_attempts.load( std::memory_order_relaxed ),
+                                                 c.steal_successes.load( std::memory_order_relaxed )} );
+    }
+    return st;
+  }
+
+private:
+  struct alignas( cache_line_size ) worker_counters
+  {
+    std::atomic<std::uint64_t> tasks_executed = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint64_t> blocked_ns = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint64_t> submit_backpressure = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint64_t> steal_attempts = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint64_t> steal_successes = ATOMIC_VAR_INIT( 0 );
+  }; /* worker_counters */
+
+  std::vector<worker_counters> counters;
+}; /* scheduler_telemetry */
+
+template<>
+class scheduler_telemetry<false>
+{
+public:
+  struct time_point
+  {
+  }; /* time_point */
+
+  explicit scheduler_telemetry( std::uint64_t )
+  {}
+
+  void executed( std::uint64_t )
+  {}
+
+  void backpressure( std::uint64_t )
+  {}
+
+  void steal( std::uint64_t, bool )
+  {}
+
+  time_point start_blocking() const
+  {
+    return {};
+  }
+
+  void stop_blocking( std::uint64_t, time_point )
+  {}
+}; /* scheduler_telemetry<false> */
+
+} // detail
+
+template<std::uint64_t QueueDepth,
+         template<typename, std::uint64_t> typename Queue = concurrent_bounded_queue,
+         typename Task = ofats::any_invocable<void()>,
+         bool Telemetry = false>
 struct bounded_depth_task_manager
 {
 public:
-  bounded_depth_task_manager( std::uint64_t n )
-    : threads( n, [&]( std::stop_token s ){ process_tasks( s ); } )
+  using task_type = Task;
+
+  bounded_depth_task_manager( std::uint64_t n, thread_placement const& placement = thread_placement::none() )
+    : telemetry( n )
+    , threads( n, placement, [&]( std::stop_token s, std::uint64_t index ){ process_tasks( s, index ); } )
   {}
 
   ~bounded_depth_task_manager()
@@ -169,45 +866,408 @@ public:
       submit( [&]{ l.arrive_and_wait(); } );
     }
     threads.request_stop();
-    l.count_down();
+    l.arrive_and_wait();
+
+    /* workers may still be inside the latch, keep it alive until they are gone */
+    threads.join();
   }
 
   void submit( std::invocable auto&& f )
   {
     while ( !tasks.try_enqueue( std::forward<decltype( f )>( f ) ) )
     {
+      telemetry.backpressure( worker_index() );
       make_progress();
     }
   }
 
-  void make_progress()
+  /* submits `f` and returns a future for its result */
+  auto submit( use_future_t, std::invocable auto&& f )
+  {
+    return detail::submit_with_future( *this, std::forward<decltype( f )>( f ) );
+  }
+
+  /* `co_await tm.schedule()` continues the awaiting coroutine on a worker of this manager */
+  auto schedule()
+  {
+    return detail::schedule_awaiter<bounded_depth_task_manager>{*this};
+  }
+
+  /* submits one task per chunk of `grain` consecutive indices of `r` (e.g., `mockturtle::detail::range`), each calling `fn( index )` */
+  void submit_bulk( auto&& r, std::uint64_t grain, auto&& fn )
+  {
+    detail::submit_chunks( *this, *r.begin(), *r.end(), grain, fn );
+  }
+
+  /* calls `fn( index )` for all indices of `r` in chunks of `grain` (adaptive if 0) and waits for their completion */
+  void parallel_for( auto&& r, std::uint64_t grain, auto&& fn )
+  {
+    auto const first = *r.begin();
+    auto const last = *r.end();
+    if ( first == last )
+    {
+      return;
+    }
+
+    auto const chunk = detail::chunk_size( last - first, grain, num_workers() );
+    std::atomic<std::uint64_t> remaining( ( last - first + chunk - 1 ) / chunk );
+    for ( auto begin = first; begin != last; )
+    {
+      auto const end = static_cast<decltype( first )>( begin + std::min<std::uint64_t>( chunk, last - begin ) );
+      submit( [&fn, &remaining, begin, end]{
+        for ( auto i = begin; i != end; ++i )
+        {
+          fn( i );
+        }
+        remaining.fetch_sub( 1, std::memory_order_release );
+      } );
+      begin = end;
+    }
+
+    /* help instead of blocking */
+    while ( remaining.load( std::memory_order_acquire ) != 0 )
+    {
+      if ( !make_progress() )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  bool make_progress()
   {
     if ( auto f = tasks.try_dequeue() )
     {
       std::move( *f )();
+      telemetry.executed( worker_index() );
+      return true;
     }
+    return false;
+  }
+
+  std::uint64_t num_workers() const
+  {
+    return threads.size();
+  }
+
+  /* snapshot of the per-worker counters (requires `Telemetry`) */
+  scheduler_statistics statistics() const requires Telemetry
+  {
+    return telemetry.snapshot();
+  }
+
+  /* index of the calling worker thread, or `num_workers()` if the caller is not a worker of this manager */
+  std::uint64_t worker_index() const
+  {
+    return detail::current_worker.owner == this ? detail::current_worker.index : num_workers();
   }
 
 private:
-  void process_tasks( std::stop_token s )
+  void process_tasks( std::stop_token s, std::uint64_t index )
   {
+    detail::current_worker = {this, index};
+
     while ( !s.stop_requested() )
     {
-      tasks.dequeue()();
+      auto const start = telemetry.start_blocking();
+      auto f = tasks.dequeue();
+      telemetry.stop_blocking( index, start );
+      std::move( f )();
+      telemetry.executed( index );
     }
 
     while ( true )
     {
       if ( auto f = tasks.try_dequeue() )
+      {
         std::move( *f )();
+        telemetry.executed( index );
+      }
       else
         break;
     }
   }
 
 private:
-  concurrent_bounded_queue<ofats::any_invocable<void()>, QueueDepth> tasks;
+  Queue<task_type, QueueDepth> tasks;
+  [[no_unique_address]] detail::scheduler_telemetry<Telemetry> telemetry;
   thread_group threads;
 };
 
+namespace detail
+{
+
+/* The state shared by the tasks of a group: the number of unfinished
+ * tasks and the first exception one of them threw.
+ */
+class task_group_state
+{
+public:
+  /* counts a task as finished when it goes out of scope, even if the task throws */
+  class finish_guard
+  {
+  public:
+    explicit finish_guard( task_group_state& state )
+      : state( state )
+    {}
+
+    finish_guard( finish_guard const& ) = delete;
+    finish_guard& operator=( finish_guard const& ) = delete;
+
+    ~finish_guard()
+    {
+      state.pending.fetch_sub( 1, std::memory_order_release );
+    }
+
+  private:
+    task_group_state& state;
+  }; /* finish_guard */
+
+  void start()
+  {
+    pending.fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  /* keeps the first exception for `rethrow` */
+  void fail( std::exception_ptr e )
+  {
+    if ( !failed.exchange( true, std::memory_order_relaxed ) )
+    {
+      error = std::move( e );
+    }
+  }
+
+  bool done() const
+  {
+    return pending.load( std::memory_order_acquire ) == 0;
+  }
+
+  /* rethrows (and forgets) the first exception of a task; call once `done` */
+  void rethrow()
+  {
+    if ( error )
+    {
+      failed.store( false, std::memory_order_relaxed );
+      std::rethrow_exception( std::exchange( error, nullptr ) );
+    }
+  }
+
+private:
+  std::atomic<std::uint64_t> pending = ATOMIC_VAR_INIT( 0 );
+  std::atomic<bool> failed = ATOMIC_VAR_INIT( false );
+  std::exception_ptr error;
+}; /* task_group_state */
+
+} // detail
+
+/* A group of tasks that can be waited for without tearing down the task manager.
+ *
+ * `wait` executes queued tasks of the task manager until all tasks run
+ * through the group have finished, so a long-lived task manager can
+ * serve several phases one after the other.  If tasks throw, `wait`
+ * rethrows the first exception once all tasks have finished; the
+ * destructor only waits.
+ */
+template<typename TaskManager>
+class task_group
+{
+public:
+  explicit task_group( TaskManager& tm )
+    : tm( tm )
+  {}
+
+  task_group( task_group const& ) = delete;
+  task_group& operator=( task_group const& ) = delete;
+
+  ~task_group()
+  {
+    drain();
+  }
+
+  void run( std::invocable auto&& f )
+  {
+    state.start();
+    tm.submit( [this, f = std::forward<decltype( f )>( f )]() mutable {
+      detail::task_group_state::finish_guard const guard( state );
+      try
+      {
+        f();
+      }
+      catch ( ... )
+      {
+        state.fail( std::current_exception() );
+      }
+    } );
+  }
+
+  void wait()
+  {
+    drain();
+    state.rethrow();
+  }
+
+private:
+  void drain()
+  {
+    while ( !state.done() )
+    {
+      if ( !tm.make_progress() )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  TaskManager& tm;
+  detail::task_group_state state;
+}; /* task_group */
+
+/* A source of stop requests for the tasks of one job, optionally with a deadline.
+ *
+ * `cancel` (or reaching the deadline, which a timer thread of the scope
+ * waits for) requests a stop on `token()`; it cannot be undone.  Must
+ * outlive all tasks run in a `cancellable_task_group` of the scope.
+ */
+class cancellation_scope
+{
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  cancellation_scope() = default;
+
+  explicit cancellation_scope( clock_type::time_point deadline )
+    : timer( [this, deadline]( std::stop_token s ){
+        std::mutex m;
+        std::condition_variable_any cv;
+        std::unique_lock lock( m );
+        if ( !cv.wait_until( lock, s, deadline, []{ return false; } ) && !s.stop_requested() )
+        {
+          source.request_stop();
+        }
+      } )
+  {}
+
+  /* cancels after `budget` from now */
+  template<typename Rep, typename Period>
+  explicit cancellation_scope( std::chrono::duration<Rep, Period> budget )
+    : cancellation_scope( clock_type::now() + std::chrono::duration_cast<clock_type::duration>( budget ) )
+  {}
+
+  cancellation_scope( cancellation_scope const& ) = delete;
+  cancellation_scope& operator=( cancellation_scope const& ) = delete;
+
+  void cancel()
+  {
+    source.request_stop();
+  }
+
+  bool cancelled() const
+  {
+    return source.stop_requested();
+  }
+
+  std::stop_token token() const
+  {
+    return source.get_token();
+  }
+
+private:
+  std::stop_source source;
+  std::jthread timer; /* declared last: stops and joins before `source` goes away */
+}; /* cancellation_scope */
+
+/* A `task_group` whose tasks are shed once its scope is cancelled.
+ *
+ * A task receives the stop token of the scope (if it takes a
+ * `std::stop_token`) to give up early.  Once the scope is cancelled,
+ * tasks that have not started yet are dropped when the task manager
+ * dequeues them, and `run` drops new ones right away; `wait` then
+ * returns as soon as the running tasks have finished.
+ */
+template<typename TaskManager>
+class cancellable_task_group
+{
+public:
+  cancellable_task_group( TaskManager& tm, cancellation_scope const& scope )
+    : tm( tm )
+    , scope( scope )
+  {}
+
+  cancellable_task_group( cancellable_task_group const& ) = delete;
+  cancellable_task_group& operator=( cancellable_task_group const& ) = delete;
+
+  ~cancellable_task_group()
+  {
+    drain();
+  }
+
+  template<typename Fn>
+    requires std::invocable<Fn&, std::stop_token> || std::invocable<Fn&>
+  void run( Fn&& f )
+  {
+    if ( scope.cancelled() )
+    {
+      shed.fetch_add( 1, std::memory_order_relaxed );
+      return;
+    }
+
+    state.start();
+    tm.submit( [this, f = std::forward<Fn>( f )]() mutable {
+      detail::task_group_state::finish_guard const guard( state );
+      if ( scope.cancelled() )
+      {
+        shed.fetch_add( 1, std::memory_order_relaxed );
+        return;
+      }
+      try
+      {
+        if constexpr ( std::invocable<Fn&, std::stop_token> )
+        {
+          f( scope.token() );
+        }
+        else
+        {
+          f();
+        }
+      }
+      catch ( ... )
+      {
+        state.fail( std::current_exception() );
+      }
+    } );
+  }
+
+  /* waits for all tasks run so far; returns false if some were shed, rethrows as `task_group::wait` */
+  bool wait()
+  {
+    drain();
+    state.rethrow();
+    return num_shed() == 0u;
+  }
+
+  std::uint64_t num_shed() const
+  {
+    return shed.load( std::memory_order_relaxed );
+  }
+
+private:
+  void drain()
+  {
+    while ( !state.done() )
+    {
+      if ( !tm.make_progress() )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  TaskManager& tm;
+  cancellation_scope const& scope;
+  detail::task_group_state state;
+  std::atomic<std::uint64_t> shed = ATOMIC_VAR_INIT( 0 );
+}; /* cancellable_task_group */
+
 } // sandbox
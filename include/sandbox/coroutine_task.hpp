@@ -0,0 +1,435 @@
+#pragma once
+
+#include <sandbox/concurrent_thread_manager.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace sandbox
+{
+
+template<typename T = void>
+class task;
+
+namespace detail
+{
+
+/* result slot of a coroutine; `void` results are stored as `std::monostate` */
+template<typename T>
+using coroutine_value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template<typename T>
+struct task_promise_base
+{
+  /* resumes whoever awaited the task (symmetric transfer, no stack growth) */
+  struct final_awaiter
+  {
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend( std::coroutine_handle<Promise> h ) noexcept
+    {
+      if ( auto c = h.promise().continuation )
+      {
+        return c;
+      }
+      return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept
+    {}
+  }; /* final_awaiter */
+
+  std::suspend_always initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  final_awaiter final_suspend() const noexcept
+  {
+    return {};
+  }
+
+  void unhandled_exception() noexcept
+  {
+    result.template emplace<2>( std::current_exception() );
+  }
+
+  T get()
+  {
+    if ( result.index() == 2 )
+    {
+      std::rethrow_exception( std::get<2>( result ) );
+    }
+    if constexpr ( !std::is_void_v<T> )
+    {
+      return std::move( std::get<1>( result ) );
+    }
+  }
+
+  std::coroutine_handle<> continuation;
+  std::variant<std::monostate, coroutine_value_t<T>, std::exception_ptr> result;
+}; /* task_promise_base */
+
+template<typename T>
+struct task_promise : task_promise_base<T>
+{
+  task<T> get_return_object() noexcept;
+
+  template<typename U>
+  requires std::convertible_to<U&&, T>
+  void return_value( U&& value )
+  {
+    this->result.template emplace<1>( std::forward<U>( value ) );
+  }
+}; /* task_promise */
+
+template<>
+struct task_promise<void> : task_promise_base<void>
+{
+  task<void> get_return_object() noexcept;
+
+  void return_void() noexcept
+  {
+    this->result.template emplace<1>();
+  }
+}; /* task_promise<void> */
+
+} // detail
+
+/* A lazily started coroutine producing a `T`.
+ *
+ * The body does not run until the task is awaited; the awaiting
+ * coroutine is resumed directly when the body finishes.  A task does
+ * not move itself onto a thread pool: use `co_await tm.schedule()`
+ * inside the body to continue on a worker of `tm`.
+ */
+template<typename T>
+class task
+{
+public:
+  using promise_type = detail::task_promise<T>;
+  using value_type = T;
+
+  task() = default;
+
+  explicit task( std::coroutine_handle<promise_type> h ) noexcept
+    : handle( h )
+  {}
+
+  task( task&& other ) noexcept
+    : handle( std::exchange( other.handle, {} ) )
+  {}
+
+  task& operator=( task&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      if ( handle )
+      {
+        handle.destroy();
+      }
+      handle = std::exchange( other.handle, {} );
+    }
+    return *this;
+  }
+
+  task( task const& ) = delete;
+  task& operator=( task const& ) = delete;
+
+  ~task()
+  {
+    if ( handle )
+    {
+      handle.destroy();
+    }
+  }
+
+  bool done() const
+  {
+    return !handle || handle.done();
+  }
+
+  auto operator co_await() && noexcept
+  {
+    struct awaiter
+    {
+      std::coroutine_handle<promise_type> h;
+
+      bool await_ready() const noexcept
+      {
+        return !h || h.done();
+      }
+
+      std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiting ) noexcept
+      {
+        h.promise().continuation = awaiting;
+        return h;
+      }
+
+      T await_resume()
+      {
+        return h.promise().get();
+      }
+    }; /* awaiter */
+
+    return awaiter{handle};
+  }
+
+  auto operator co_await() & noexcept
+  {
+    return std::move( *this ).operator co_await();
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle;
+}; /* task */
+
+namespace detail
+{
+
+template<typename T>
+task<T> task_promise<T>::get_return_object() noexcept
+{
+  return task<T>{std::coroutine_handle<task_promise<T>>::from_promise( *this )};
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+  return task<void>{std::coroutine_handle<task_promise<void>>::from_promise( *this )};
+}
+
+/* Joins the children of a `when_all`.
+ *
+ * The counter starts at the number of children plus one: every child
+ * arrives once when it finishes and the awaiting coroutine arrives
+ * once after it has started all children.  Whoever arrives last
+ * resumes the awaiting coroutine.
+ */
+struct when_all_latch
+{
+  explicit when_all_latch( std::size_t n )
+    : count( n + 1u )
+  {}
+
+  void arrive()
+  {
+    /* the latch may be gone as soon as the counter drops to zero */
+    auto const h = awaiting;
+    if ( count.fetch_sub( 1u, std::memory_order_acq_rel ) == 1u )
+    {
+      h.resume();
+    }
+  }
+
+  std::atomic<std::size_t> count;
+  std::coroutine_handle<> awaiting;
+}; /* when_all_latch */
+
+/* coroutine running one child of a `when_all`; its frame is destroyed by the `when_all` */
+struct when_all_child
+{
+  struct promise_type
+  {
+    when_all_child get_return_object() noexcept
+    {
+      return when_all_child{std::coroutine_handle<promise_type>::from_promise( *this )};
+    }
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+      return {};
+    }
+
+    auto final_suspend() const noexcept
+    {
+      struct awaiter
+      {
+        bool await_ready() const noexcept
+        {
+          return false;
+        }
+
+        void await_suspend( std::coroutine_handle<promise_type> h ) const noexcept
+        {
+          h.promise().latch->arrive();
+        }
+
+        void await_resume() const noexcept
+        {}
+      }; /* awaiter */
+      return awaiter{};
+    }
+
+    void return_void() noexcept
+    {}
+
+    void unhandled_exception() noexcept
+    {
+      std::terminate(); /* children catch everything themselves */
+    }
+
+    when_all_latch* latch{nullptr};
+  }; /* promise_type */
+
+  std::coroutine_handle<promise_type> handle;
+}; /* when_all_child */
+
+template<typename T>
+struct when_all_slot
+{
+  std::optional<coroutine_value_t<T>> value;
+  std::exception_ptr error;
+}; /* when_all_slot */
+
+template<typename T>
+when_all_child make_when_all_child( task<T>& t, when_all_slot<T>& slot )
+{
+  try
+  {
+    if constexpr ( std::is_void_v<T> )
+    {
+      co_await t;
+      slot.value.emplace();
+    }
+    else
+    {
+      slot.value.emplace( co_await t );
+    }
+  }
+  catch ( ... )
+  {
+    slot.error = std::current_exception();
+  }
+}
+
+/* starts all children and suspends the awaiting coroutine until the last one has finished */
+struct when_all_awaiter
+{
+  std::vector<when_all_child>& children;
+  when_all_latch& latch;
+
+  bool await_ready() const noexcept
+  {
+    return children.empty();
+  }
+
+  bool await_suspend( std::coroutine_handle<> h )
+  {
+    latch.awaiting = h;
+    for ( auto& c : children )
+    {
+      c.handle.promise().latch = &latch;
+      c.handle.resume();
+    }
+    return latch.count.fetch_sub( 1u, std::memory_order_acq_rel ) != 1u;
+  }
+
+  void await_resume() const noexcept
+  {}
+}; /* when_all_awaiter */
+
+inline void destroy_children( std::vector<when_all_child>& children )
+{
+  for ( auto& c : children )
+  {
+    c.handle.destroy();
+  }
+}
+
+} // detail
+
+/* awaits all `tasks` concurrently and returns their results in order; rethrows the first exception */
+template<typename T>
+task<std::vector<detail::coroutine_value_t<T>>> when_all( std::vector<task<T>> tasks )
+{
+  std::vector<detail::when_all_slot<T>> slots( tasks.size() );
+  std::vector<detail::when_all_child> children;
+  children.reserve( tasks.size() );
+  for ( std::size_t i = 0; i < tasks.size(); ++i )
+  {
+    children.emplace_back( detail::make_when_all_child( tasks[i], slots[i] ) );
+  }
+
+  detail::when_all_latch latch( children.size() );
+  co_await detail::when_all_awaiter{children, latch};
+  detail::destroy_children( children );
+
+  std::vector<detail::coroutine_value_t<T>> results;
+  results.reserve( slots.size() );
+  for ( auto& s : slots )
+  {
+    if ( s.error )
+    {
+      std::rethrow_exception( s.error );
+    }
+    results.emplace_back( std::move( *s.value ) );
+  }
+  co_return results;
+}
+
+/* awaits tasks of different types concurrently and returns their results as a tuple (`void` as `std::monostate`) */
+template<typename... Ts>
+task<std::tuple<detail::coroutine_value_t<Ts>...>> when_all( task<Ts>... tasks )
+{
+  std::tuple<detail::when_all_slot<Ts>...> slots;
+  std::vector<detail::when_all_child> children;
+  children.reserve( sizeof...( Ts ) );
+  [&]<std::size_t... Is>( std::index_sequence<Is...> ) {
+    ( children.emplace_back( detail::make_when_all_child( tasks, std::get<Is>( slots ) ) ), ... );
+  }( std::index_sequence_for<Ts...>{} );
+
+  detail::when_all_latch latch( children.size() );
+  co_await detail::when_all_awaiter{children, latch};
+  detail::destroy_children( children );
+
+  co_return std::apply( []( auto&... s ) {
+    ( ( s.error ? std::rethrow_exception( s.error ) : void() ), ... );
+    return std::tuple<detail::coroutine_value_t<Ts>...>( std::move( *s.value )... );
+  }, slots );
+}
+
+/* runs `t` to completion from a thread outside the coroutine world, executing tasks of `tm` while waiting */
+template<typename TaskManager, typename T>
+T sync_wait( TaskManager& tm, task<T> t )
+{
+  detail::when_all_slot<T> slot;
+  std::vector<detail::when_all_child> children;
+  children.emplace_back( detail::make_when_all_child( t, slot ) );
+
+  /* the child runs inline until its first `schedule()`, the caller helps the pool until it has finished */
+  detail::when_all_latch latch( 0u );
+  latch.awaiting = std::noop_coroutine();
+  children.front().handle.promise().latch = &latch;
+  children.front().handle.resume();
+  while ( latch.count.load( std::memory_order_acquire ) != 0u )
+  {
+    if ( !tm.make_progress() )
+    {
+      std::this_thread::yield();
+    }
+  }
+  detail::destroy_children( children );
+
+  if ( slot.error )
+  {
+    std::rethrow_exception( slot.error );
+  }
+  if constexpr ( !std::is_void_v<T> )
+  {
+    return std::move( *slot.value );
+  }
+}
+
+} // sandbox
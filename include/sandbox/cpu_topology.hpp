@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace sandbox
+{
+
+/* The CPUs this process may run on, grouped by NUMA node.
+ *
+ * On Linux, nodes are read from `/sys/devices/system/node` and
+ * restricted to the affinity mask of the process; elsewhere (or if
+ * sysfs is unavailable) all hardware threads are reported on node 0.
+ */
+struct cpu_topology
+{
+public:
+  struct cpu
+  {
+    std::uint32_t id;
+    std::uint32_t node;
+  }; /* cpu */
+
+  static cpu_topology const& system()
+  {
+    static cpu_topology const t = detect();
+    return t;
+  }
+
+  std::vector<cpu> const& cpus() const
+  {
+    return cpus_;
+  }
+
+  std::uint32_t num_nodes() const
+  {
+    return num_nodes_;
+  }
+
+  /* CPUs of `node` in ascending order */
+  std::vector<std::uint32_t> cpus_of( std::uint32_t node ) const
+  {
+    std::vector<std::uint32_t> result;
+    for ( auto const& c : cpus_ )
+    {
+      if ( c.node == node )
+      {
+        result.emplace_back( c.id );
+      }
+    }
+    return result;
+  }
+
+  /* NUMA node of `cpu_id`, or 0 if unknown */
+  std::uint32_t node_of( std::uint32_t cpu_id ) const
+  {
+    for ( auto const& c : cpus_ )
+    {
+      if ( c.id == cpu_id )
+      {
+        return c.node;
+      }
+    }
+    return 0u;
+  }
+
+private:
+  static cpu_topology detect()
+  {
+    cpu_topology t;
+#if defined( __linux__ )
+    cpu_set_t allowed;
+    CPU_ZERO( &allowed );
+    bool const has_mask = sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0;
+
+    for ( std::uint32_t node = 0u;; ++node )
+    {
+      std::ifstream in( "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist" );
+      if ( !in )
+      {
+        break;
+      }
+
+      std::string list;
+      std::getline( in, list );
+      for ( auto const id : parse_cpu_list( list ) )
+      {
+        if ( !has_mask || CPU_ISSET( id, &allowed ) )
+        {
+          t.cpus_.emplace_back( cpu{id, node} );
+        }
+      }
+      t.num_nodes_ = node + 1u;
+    }
+#endif
+
+    if ( t.cpus_.empty() )
+    {
+      t.num_nodes_ = 1u;
+      for ( std::uint32_t id = 0u; id < std::max( 1u, std::thread::hardware_concurrency() ); ++id )
+      {
+        t.cpus_.emplace_back( cpu{id, 0u} );
+      }
+    }
+
+    std::sort( t.cpus_.begin(), t.cpus_.end(), []( cpu const& a, cpu const& b ){
+      return a.node != b.node ? a.node < b.node : a.id < b.id;
+    } );
+    return t;
+  }
+
+  /* parses the kernel's list format, e.g. `0-3,8-11` */
+  static std::vector<std::uint32_t> parse_cpu_list( std::string const& list )
+  {
+    std::vector<std::uint32_t> ids;
+    std::stringstream ss( list );
+    std::string item;
+    while ( std::getline( ss, item, ',' ) )
+    {
+      if ( item.empty() )
+      {
+        continue;
+      }
+
+      auto const dash = item.find( '-' );
+      std::uint32_t const first = std::stoul( item.substr( 0, dash ) );
+      std::uint32_t const last = dash == std::string::npos ? first : std::stoul( item.substr( dash + 1 ) );
+      for ( std::uint32_t id = first; id <= last; ++id )
+      {
+        ids.emplace_back( id );
+      }
+    }
+    return ids;
+  }
+
+private:
+  std::vector<cpu> cpus_;
+  std::uint32_t num_nodes_{0};
+}; /* cpu_topology */
+
+/* How the members of a `thread_group` are pinned to CPUs.
+ *
+ * `compact` fills one node before moving on to the next one,
+ * `scatter` distributes consecutive members round-robin over the
+ * nodes, and `on_cpus` uses an explicit list of CPU ids.  With more
+ * members than CPUs, the assignment wraps around.
+ */
+struct thread_placement
+{
+public:
+  enum class policy
+  {
+    none,
+    compact,
+    scatter,
+    explicit_list,
+  };
+
+  static thread_placement none()
+  {
+    return {};
+  }
+
+  static thread_placement compact()
+  {
+    thread_placement p;
+    p.kind = policy::compact;
+    return p;
+  }
+
+  static thread_placement scatter()
+  {
+    thread_placement p;
+    p.kind = policy::scatter;
+    return p;
+  }
+
+  static thread_placement on_cpus( std::vector<std::uint32_t> cpu_ids )
+  {
+    thread_placement p;
+    p.kind = policy::explicit_list;
+    p.cpu_ids = std::move( cpu_ids );
+    return p;
+  }
+
+  policy kind{policy::none};
+  std::vector<std::uint32_t> cpu_ids;
+
+  /* CPU for the member with index `index`, or nothing if the member is not pinned */
+  std::optional<std::uint32_t> cpu_for( std::uint64_t index, cpu_topology const& t = cpu_topology::system() ) const
+  {
+    switch ( kind )
+    {
+    case policy::none:
+      return std::nullopt;
+    case policy::compact:
+      return t.cpus()[index % t.cpus().size()].id;
+    case policy::scatter:
+    {
+      /* nodes without allowed CPUs are skipped */
+      std::vector<std::vector<std::uint32_t>> nodes;
+      for ( std::uint32_t n = 0u; n < t.num_nodes(); ++n )
+      {
+        if ( auto cs = t.cpus_of( n ); !cs.empty() )
+        {
+          nodes.emplace_back( std::move( cs ) );
+        }
+      }
+      auto const& cs = nodes[index % nodes.size()];
+      return cs[( index / nodes.size() ) % cs.size()];
+    }
+    case policy::explicit_list:
+      if ( cpu_ids.empty() )
+      {
+        return std::nullopt;
+      }
+      return cpu_ids[index % cpu_ids.size()];
+    }
+    return std::nullopt;
+  }
+}; /* thread_placement */
+
+namespace detail
+{
+
+/* restricts `t` to `cpu_id`; returns false if pinning is unsupported or failed */
+inline bool pin_thread( std::jthread& t, std::uint32_t cpu_id )
+{
+#if defined( __linux__ )
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu_id, &set );
+  return pthread_setaffinity_np( t.native_handle(), sizeof( set ), &set ) == 0;
+#else
+  (void)t;
+  (void)cpu_id;
+  return false;
+#endif
+}
+
+} // detail
+
+} // sandbox
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sandbox
+{
+
+/* allocation counters of the task allocator */
+struct task_allocation_statistics
+{
+  std::uint64_t fallback_allocations{0}; /* closures that did not fit into the inline storage of their task */
+  std::uint64_t slab_allocations{0};     /* slabs requested from the global heap */
+  std::uint64_t heap_allocations{0};     /* closures too large for any size class */
+  std::uint64_t remote_deallocations{0}; /* blocks released by another thread than their owner */
+}; /* task_allocation_statistics */
+
+namespace detail
+{
+
+/* Fixed-size block allocator for closures that do not fit inline.
+ *
+ * Every thread owns a heap with one free list per size class and
+ * refills it by carving a slab into blocks.  Slabs are aligned to
+ * their size and start with a header naming the owning heap, so a
+ * block released by another thread goes back to its owner: it is
+ * pushed onto a lock-free remote list of the owning heap, which the
+ * owner takes over when its local list runs empty.  Hence blocks that
+ * one thread allocates and others release (e.g., tasks submitted from
+ * outside the pool) are recycled instead of piling up on the
+ * releasing threads.  The heap of a terminated thread, with its slabs,
+ * is handed to the next new thread; heaps and slabs are never returned
+ * to the system, so a block stays valid even if its allocating thread
+ * has terminated.
+ */
+class task_slab_allocator
+{
+public:
+  static constexpr std::size_t min_block_size = 64u;
+  static constexpr std::size_t num_size_classes = 5u; /* 64, 128, 256, 512, 1024 bytes */
+  static constexpr std::size_t max_block_size = min_block_size << ( num_size_classes - 1u );
+  static constexpr std::size_t slab_size = 64u * 1024u;
+
+  static void* allocate( std::size_t size )
+  {
+    counters().fallback_allocations.fetch_add( 1u, std::memory_order_relaxed );
+    if ( size > max_block_size )
+    {
+      counters().heap_allocations.fetch_add( 1u, std::memory_order_relaxed );
+      return ::operator new( size );
+    }
+
+    auto const c = size_class( size );
+    thread_heap& h = local_heap();
+    free_block*& head = h.free_lists[c];
+    if ( head == nullptr )
+    {
+      /* take over the blocks other threads have released */
+      head = h.remote_lists[c].exchange( nullptr, std::memory_order_acquire );
+      if ( head == nullptr )
+      {
+        refill( h, c );
+      }
+    }
+
+    free_block* block = head;
+    head = block->next;
+    return block;
+  }
+
+  static void deallocate( void* p, std::size_t size ) noexcept
+  {
+    if ( size > max_block_size )
+    {
+      ::operator delete( p );
+      return;
+    }
+
+    auto const c = size_class( size );
+    thread_heap* const owner = owner_of( p );
+    if ( owner == current_heap() )
+    {
+      free_block*& head = owner->free_lists[c];
+      head = new ( p ) free_block{head};
+      return;
+    }
+
+    counters().remote_deallocations.fetch_add( 1u, std::memory_order_relaxed );
+    auto& remote = owner->remote_lists[c];
+    free_block* const block = new ( p ) free_block{remote.load( std::memory_order_relaxed )};
+    while ( !remote.compare_exchange_weak( block->next, block, std::memory_order_release, std::memory_order_relaxed ) )
+    {
+    }
+  }
+
+  static task_allocation_statistics statistics()
+  {
+    return {counters().fallback_allocations.load( std::memory_order_relaxed ),
+            counters().slab_allocations.load( std::memory_order_relaxed ),
+            counters().heap_allocations.load( std::memory_order_relaxed ),
+            counters().remote_deallocations.load( std::memory_order_relaxed )};
+  }
+
+private:
+  struct free_block
+  {
+    free_block* next;
+  }; /* free_block */
+
+  struct thread_heap
+  {
+    std::array<free_block*, num_size_classes> free_lists{}; /* owner only */
+    std::array<std::atomic<free_block*>, num_size_classes> remote_lists{};
+  }; /* thread_heap */
+
+  /* the first block of every slab */
+  struct slab_header
+  {
+    thread_heap* owner;
+  }; /* slab_header */
+
+  struct slab_registry
+  {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<thread_heap>> heaps;
+    std::vector<thread_heap*> orphaned_heaps; /* of terminated threads */
+  }; /* slab_registry */
+
+  /* hands the heap of the thread back to the registry when the thread terminates */
+  struct heap_handle
+  {
+    thread_heap* heap{nullptr};
+
+    ~heap_handle()
+    {
+      if ( heap != nullptr )
+      {
+        auto& r = registry();
+        std::scoped_lock l( r.mutex );
+        r.orphaned_heaps.emplace_back( heap );
+        heap = nullptr; /* later releases of this thread go to the remote lists */
+      }
+    }
+  }; /* heap_handle */
+
+  struct allocation_counters
+  {
+    std::atomic<std::uint64_t> fallback_allocations{0};
+    std::atomic<std::uint64_t> slab_allocations{0};
+    std::atomic<std::uint64_t> heap_allocations{0};
+    std::atomic<std::uint64_t> remote_deallocations{0};
+  }; /* allocation_counters */
+
+  static_assert( sizeof( slab_header ) <= min_block_size );
+
+  static std::size_t size_class( std::size_t size )
+  {
+    std::size_t c{0};
+    while ( ( min_block_size << c ) < size )
+    {
+      ++c;
+    }
+    return c;
+  }
+
+  static thread_heap* owner_of( void* p )
+  {
+    auto const slab = reinterpret_cast<std::uintptr_t>( p ) & ~std::uintptr_t( slab_size - 1u );
+    return reinterpret_cast<slab_header const*>( slab )->owner;
+  }
+
+  static void refill( thread_heap& h, std::size_t c )
+  {
+    std::size_t const block_size = min_block_size << c;
+    auto* const slab = static_cast<std::byte*>( ::operator new( slab_size, std::align_val_t( slab_size ) ) );
+    new ( slab ) slab_header{&h};
+    counters().slab_allocations.fetch_add( 1u, std::memory_order_relaxed );
+
+    /* the first block holds the header */
+    free_block*& head = h.free_lists[c];
+    for ( std::size_t offset = slab_size; offset >= 2u * block_size; offset -= block_size )
+    {
+      head = new ( slab + offset - block_size ) free_block{head};
+    }
+  }
+
+  static thread_heap*& current_heap()
+  {
+    thread_local heap_handle handle;
+    return handle.heap;
+  }
+
+  static thread_heap& local_heap()
+  {
+    thread_heap*& heap = current_heap();
+    if ( heap == nullptr )
+    {
+      auto& r = registry();
+      std::scoped_lock l( r.mutex );
+      if ( r.orphaned_heaps.empty() )
+      {
+        heap = r.heaps.emplace_back( std::make_unique<thread_heap>() ).get();
+      }
+      else
+      {
+        heap = r.orphaned_heaps.back();
+        r.orphaned_heaps.pop_back();
+      }
+    }
+    return *heap;
+  }
+
+  static slab_registry& registry()
+  {
+    /* never destroyed: threads may release blocks during static destruction */
+    static slab_registry* const r = new slab_registry();
+    return *r;
+  }
+
+  static allocation_counters& counters()
+  {
+    static allocation_counters c;
+    return c;
+  }
+}; /* task_slab_allocator */
+
+} // detail
+
+inline task_allocation_statistics task_allocation_stats()
+{
+  return detail::task_slab_allocator::statistics();
+}
+
+/* A move-only `void()` task with `InlineCapacity` bytes of inline storage.
+ *
+ * Closures up to `InlineCapacity` bytes are stored in place; larger
+ * ones are placed in blocks of the per-thread slab allocator, which
+ * counts these fallbacks (see `task_allocation_stats`).  The default
+ * capacity makes the task exactly one cache line.
+ */
+template<std::size_t InlineCapacity = 48u>
+class inline_task
+{
+public:
+  inline_task() = default;
+
+  template<typename F>
+  requires ( !std::same_as<std::remove_cvref_t<F>, inline_task> && std::invocable<std::decay_t<F>&> )
+  inline_task( F&& f )
+  {
+    using T = std::decay_t<F>;
+    if constexpr ( fits_inline<T> )
+    {
+      new ( buffer ) T( std::forward<F>( f ) );
+      ops = &inline_ops<T>;
+    }
+    else
+    {
+      static_assert( alignof( T ) <= alignof( std::max_align_t ), "over-aligned closures are not supported" );
+      void* p = detail::task_slab_allocator::allocate( sizeof( T ) );
+      new ( p ) T( std::forward<F>( f ) );
+      *reinterpret_cast<void**>( buffer ) = p;
+      ops = &fallback_ops<T>;
+    }
+  }
+
+  inline_task( inline_task&& other ) noexcept
+    : ops( other.ops )
+  {
+    if ( ops )
+    {
+      ops->move( buffer, other.buffer );
+      other.ops = nullptr;
+    }
+  }
+
+  inline_task& operator=( inline_task&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      reset();
+      if ( other.ops )
+      {
+        ops = other.ops;
+        ops->move( buffer, other.buffer );
+        other.ops = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  ~inline_task()
+  {
+    reset();
+  }
+
+  void operator()()
+  {
+    ops->invoke( buffer );
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ops != nullptr;
+  }
+
+private:
+  template<typename T>
+  static constexpr bool fits_inline = sizeof( T ) <= InlineCapacity &&
+                                      alignof( T ) <= alignof( std::max_align_t ) &&
+                                      std::is_nothrow_move_constructible_v<T>;
+
+  struct operations
+  {
+    void ( *invoke )( std::byte* );
+    void ( *move )( std::byte*, std::byte* ) noexcept;
+    void ( *destroy )( std::byte* ) noexcept;
+  }; /* operations */
+
+  template<typename T>
+  static constexpr operations inline_ops{
+    []( std::byte* b ){ std::invoke( *std::launder( reinterpret_cast<T*>( b ) ) ); },
+    []( std::byte* dst, std::byte* src ) noexcept {
+      T* s = std::launder( reinterpret_cast<T*>( src ) );
+      new ( dst ) T( std::move( *s ) );
+      s->~T();
+    },
+    []( std::byte* b ) noexcept { std::launder( reinterpret_cast<T*>( b ) )->~T(); }
+  };
+
+  template<typename T>
+  static constexpr operations fallback_ops{
+    []( std::byte* b ){ std::invoke( *static_cast<T*>( *reinterpret_cast<void**>( b ) ) ); },
+    []( std::byte* dst, std::byte* src ) noexcept {
+      *reinterpret_cast<void**>( dst ) = *reinterpret_cast<void**>( src );
+    },
+    []( std::byte* b ) noexcept {
+      T* p = static_cast<T*>( *reinterpret_cast<void**>( b ) );
+      p->~T();
+      detail::task_slab_allocator::deallocate( p, sizeof( T ) );
+    }
+  };
+
+  void reset() noexcept
+  {
+    if ( ops )
+    {
+      ops->destroy( buffer );
+      ops = nullptr;
+    }
+  }
+
+private:
+  operations const* ops{nullptr};
+  alignas( std::max_align_t ) std::byte buffer[InlineCapacity < sizeof( void* ) ? sizeof( void* ) : InlineCapacity];
+}; /* inline_task */
+
+} // sandbox
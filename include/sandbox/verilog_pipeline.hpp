@@ -0,0 +1,395 @@
+#pragma once
+
+#include <sandbox/concurrent_thread_manager.hpp>
+#include <lorina/verilog.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sandbox
+{
+
+namespace detail
+{
+
+/* one recorded callback of a `lorina::verilog_reader` */
+struct verilog_event
+{
+  enum class kind : std::uint8_t
+  {
+    module_header,
+    inputs,
+    outputs,
+    wires,
+    parameter,
+    assign,
+    module_instantiation,
+    and2,
+    nand2,
+    or2,
+    nor2,
+    xor2,
+    xnor2,
+    and3,
+    or3,
+    xor3,
+    maj3,
+    comment,
+    endmodule,
+    instance_output_query /* `is_instance_output`, answered through a `verilog_query` */
+  }; /* kind */
+
+  kind type;
+  std::string name;  /* lhs, module, parameter or comment */
+  std::string value; /* size modifier, parameter value or instance name */
+  std::array<std::pair<std::string, bool>, 3u> operands{};
+  std::vector<std::string> names; /* signals or module parameters */
+  std::vector<std::pair<std::string, std::string>> args;
+}; /* verilog_event */
+
+using verilog_batch = std::vector<verilog_event>;
+
+/* The answer to the pending `is_instance_output` query of a recorder */
+class verilog_query
+{
+public:
+  void reset()
+  {
+    state.store( pending, std::memory_order_relaxed );
+  }
+
+  void answer( bool value )
+  {
+    state.store( value ? yes : no, std::memory_order_release );
+    state.notify_one();
+  }
+
+  bool wait() const
+  {
+    state.wait( pending, std::memory_order_acquire );
+    return state.load( std::memory_order_acquire ) == yes;
+  }
+
+private:
+  static constexpr std::uint8_t no = 0u;
+  static constexpr std::uint8_t yes = 1u;
+  static constexpr std::uint8_t pending = 2u;
+
+  std::atomic<std::uint8_t> state = ATOMIC_VAR_INIT( pending );
+}; /* verilog_query */
+
+/* Records the callbacks of the parser into batches and hands every full batch to `Sink`.
+ *
+ * `is_instance_output` cannot be recorded, since the parser needs the
+ * answer right away: the recorder hands its batch with the query over
+ * and waits until the consumer has replayed everything before it and
+ * answered on the wrapped reader.
+ */
+template<typename Sink>
+class verilog_recorder : public lorina::verilog_reader
+{
+public:
+  using kind = verilog_event::kind;
+
+  explicit verilog_recorder( Sink& sink, verilog_query& query, std::uint32_t batch_size )
+    : sink( sink )
+    , query( query )
+    , batch_size( batch_size )
+  {
+    batch.reserve( batch_size );
+  }
+
+  void on_module_header( const std::string& module_name, const std::vector<std::string>& inouts ) const override
+  {
+    auto& e = record( kind::module_header, module_name );
+    e.names = inouts;
+  }
+
+  void on_inputs( const std::vector<std::string>& inputs, std::string const& size = "" ) const override
+  {
+    record( kind::inputs, {}, size ).names = inputs;
+  }
+
+  void on_outputs( const std::vector<std::string>& outputs, std::string const& size = "" ) const override
+  {
+    record( kind::outputs, {}, size ).names = outputs;
+  }
+
+  void on_wires( const std::vector<std::string>& wires, std::string const& size = "" ) const override
+  {
+    record( kind::wires, {}, size ).names = wires;
+  }
+
+  void on_parameter( const std::string& name, const std::string& value ) const override
+  {
+    record( kind::parameter, name, value );
+  }
+
+  void on_assign( const std::string& lhs, const std::pair<std::string, bool>& rhs ) const override
+  {
+    record( kind::assign, lhs ).operands[0] = rhs;
+  }
+
+  void on_module_instantiation( std::string const& module_name, std::vector<std::string> const& params, std::string const& inst_name,
+                                std::vector<std::pair<std::string,std::string>> const& args ) const override
+  {
+    auto& e = record( kind::module_instantiation, module_name, inst_name );
+    e.names = params;
+    e.args = args;
+  }
+
+  void on_and( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::and2, lhs, op1, op2 );
+  }
+
+  void on_nand( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::nand2, lhs, op1, op2 );
+  }
+
+  void on_or( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::or2, lhs, op1, op2 );
+  }
+
+  void on_nor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::nor2, lhs, op1, op2 );
+  }
+
+  void on_xor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::xor2, lhs, op1, op2 );
+  }
+
+  void on_xnor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+  {
+    record_gate( kind::xnor2, lhs, op1, op2 );
+  }
+
+  void on_and3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const override
+  {
+    record_gate( kind::and3, lhs, op1, op2, op3 );
+  }
+
+  void on_or3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const override
+  {
+    record_gate( kind::or3, lhs, op1, op2, op3 );
+  }
+
+  void on_xor3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const override
+  {
+    record_gate( kind::xor3, lhs, op1, op2, op3 );
+  }
+
+  void on_maj3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const override
+  {
+    record_gate( kind::maj3, lhs, op1, op2, op3 );
+  }
+
+  void on_comment( std::string const& comment ) const override
+  {
+    record( kind::comment, comment );
+  }
+
+  void on_endmodule() const override
+  {
+    record( kind::endmodule );
+  }
+
+  bool is_instance_output( std::string const& module_name, std::string const& port ) const override
+  {
+    query.reset();
+    record( kind::instance_output_query, module_name, port );
+    flush();
+    return query.wait();
+  }
+
+  /* hands the last, partially filled batch to the sink */
+  void flush() const
+  {
+    if ( !batch.empty() )
+    {
+      sink( std::move( batch ) );
+      batch = verilog_batch();
+      batch.reserve( batch_size );
+    }
+  }
+
+private:
+  verilog_event& record( kind type, std::string const& name = {}, std::string const& value = {} ) const
+  {
+    if ( batch.size() == batch_size )
+    {
+      flush();
+    }
+    auto& e = batch.emplace_back();
+    e.type = type;
+    e.name = name;
+    e.value = value;
+    return e;
+  }
+
+  template<typename... Operands>
+  void record_gate( kind type, std::string const& lhs, Operands const&... ops ) const
+  {
+    auto& e = record( type, lhs );
+    std::uint32_t i{0};
+    ( ( e.operands[i++] = ops ), ... );
+  }
+
+private:
+  Sink& sink;
+  verilog_query& query;
+  std::uint32_t const batch_size;
+  mutable verilog_batch batch;
+}; /* verilog_recorder */
+
+/* invokes the callback of `reader` recorded in `e`, or answers its `query` */
+inline void replay( verilog_event const& e, lorina::verilog_reader const& reader, verilog_query& query )
+{
+  using kind = verilog_event::kind;
+  auto const& ops = e.operands;
+  switch ( e.type )
+  {
+  case kind::module_header:        reader.on_module_header( e.name, e.names ); break;
+  case kind::inputs:               reader.on_inputs( e.names, e.value ); break;
+  case kind::outputs:              reader.on_outputs( e.names, e.value ); break;
+  case kind::wires:                reader.on_wires( e.names, e.value ); break;
+  case kind::parameter:            reader.on_parameter( e.name, e.value ); break;
+  case kind::assign:               reader.on_assign( e.name, ops[0] ); break;
+  case kind::module_instantiation: reader.on_module_instantiation( e.name, e.names, e.value, e.args ); break;
+  case kind::and2:                 reader.on_and( e.name, ops[0], ops[1] ); break;
+  case kind::nand2:                reader.on_nand( e.name, ops[0], ops[1] ); break;
+  case kind::or2:                  reader.on_or( e.name, ops[0], ops[1] ); break;
+  case kind::nor2:                 reader.on_nor( e.name, ops[0], ops[1] ); break;
+  case kind::xor2:                 reader.on_xor( e.name, ops[0], ops[1] ); break;
+  case kind::xnor2:                reader.on_xnor( e.name, ops[0], ops[1] ); break;
+  case kind::and3:                 reader.on_and3( e.name, ops[0], ops[1], ops[2] ); break;
+  case kind::or3:                  reader.on_or3( e.name, ops[0], ops[1], ops[2] ); break;
+  case kind::xor3:                 reader.on_xor3( e.name, ops[0], ops[1], ops[2] ); break;
+  case kind::maj3:                 reader.on_maj3( e.name, ops[0], ops[1], ops[2] ); break;
+  case kind::comment:              reader.on_comment( e.name ); break;
+  case kind::endmodule:            reader.on_endmodule(); break;
+  case kind::instance_output_query: query.answer( reader.is_instance_output( e.name, e.value ) ); break;
+  }
+}
+
+} /* detail */
+
+/* Reads a Verilog file in a two-stage pipeline.
+ *
+ * A producer thread memory-maps and tokenizes the file, matches the
+ * statements and resolves their dependencies exactly as
+ * `lorina::read_verilog` does, but only records the resulting
+ * callbacks into batches of `batch_size` events.  The batches travel
+ * through a `lock_free_bounded_queue` of `QueueDepth` batches to the
+ * calling thread, which replays them on `reader` in the original
+ * order; hence building the network (e.g., structural hashing in
+ * `create_and`) overlaps with I/O and lexing, and a slow consumer
+ * throttles the producer instead of growing the queue.
+ *
+ * `reader` sees the same callbacks, in the same order, as with
+ * `lorina::read_verilog`; its `is_instance_output` is queried on the
+ * calling thread once the callbacks before the query have been
+ * replayed.  Diagnostics are reported by the producer thread, so they
+ * may arrive before the callbacks of the statements preceding them
+ * have been replayed.  An exception thrown by the parser or by
+ * `reader` is rethrown on the calling thread after the producer has
+ * stopped.
+ */
+template<std::uint64_t QueueDepth = 16u>
+[[nodiscard]] inline lorina::return_code read_verilog_pipelined( std::string const& filename, lorina::verilog_reader const& reader,
+                                                                 lorina::diagnostic_engine* diag = nullptr, std::uint32_t batch_size = 4096u )
+{
+  /* thrown into the parser to stop the producer once the consumer failed */
+  struct consumer_failed
+  {
+  };
+
+  /* an empty batch marks the end of the input, `producer_error` is set before it */
+  lock_free_bounded_queue<detail::verilog_batch, QueueDepth> batches;
+  std::atomic<bool> failed{false};
+  auto sink = [&]( detail::verilog_batch&& batch ){
+    if ( failed.load( std::memory_order_relaxed ) )
+    {
+      throw consumer_failed{};
+    }
+    batches.enqueue( std::move( batch ) );
+  };
+
+  detail::verilog_query query;
+  lorina::return_code result{lorina::return_code::success};
+  std::exception_ptr producer_error;
+  std::jthread producer( [&]{
+    try
+    {
+      detail::verilog_recorder<decltype( sink )> recorder( sink, query, batch_size );
+      result = lorina::read_verilog( filename, recorder, diag );
+      recorder.flush();
+    }
+    catch ( consumer_failed const& )
+    {
+    }
+    catch ( ... )
+    {
+      producer_error = std::current_exception();
+    }
+    batches.enqueue( detail::verilog_batch() );
+  } );
+
+  std::exception_ptr consumer_error;
+  while ( true )
+  {
+    detail::verilog_batch const batch = batches.dequeue();
+    if ( batch.empty() )
+    {
+      break;
+    }
+    for ( auto const& e : batch )
+    {
+      if ( consumer_error )
+      {
+        /* drain until the producer has stopped; it must not wait for an answer */
+        if ( e.type == detail::verilog_event::kind::instance_output_query )
+        {
+          query.answer( false );
+        }
+        continue;
+      }
+      try
+      {
+        detail::replay( e, reader, query );
+      }
+      catch ( ... )
+      {
+        consumer_error = std::current_exception();
+        failed.store( true, std::memory_order_relaxed );
+        if ( e.type == detail::verilog_event::kind::instance_output_query )
+        {
+          query.answer( false );
+        }
+      }
+    }
+  }
+
+  producer.join();
+  if ( consumer_error )
+  {
+    std::rethrow_exception( consumer_error );
+  }
+  if ( producer_error )
+  {
+    std::rethrow_exception( producer_error );
+  }
+  return result;
+}
+
+} /* sandbox */
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <sandbox/concurrent_thread_manager.hpp>
+
+#include <array>
+#include <memory>
+#include <random>
+#include <utility>
+
+namespace sandbox
+{
+
+/* A bounded double-ended task queue owned by one worker.
+ *
+ * The owner pushes and pops at the back (LIFO, good locality for
+ * tasks spawning tasks), thieves take from the front (FIFO, oldest
+ * and usually largest work first).  The deque is guarded by its own
+ * lock; since each worker mostly talks to its own deque, the lock is
+ * only contended when somebody steals.
+ */
+template<typename T, std::uint64_t QueueDepth>
+struct work_stealing_deque
+{
+public:
+  work_stealing_deque()
+    : items( std::make_unique<T[]>( QueueDepth ) )
+  {}
+
+  bool try_push( std::convertible_to<T> auto&& u )
+  {
+    std::scoped_lock l( items_mutex );
+    if ( tail - head == QueueDepth )
+    {
+      return false;
+    }
+    items[tail % QueueDepth] = std::forward<decltype( u )>( u );
+    ++tail;
+    count.store( tail - head );
+    return true;
+  }
+
+  std::optional<T> try_pop()
+  {
+    if ( empty() )
+    {
+      return {};
+    }
+
+    std::scoped_lock l( items_mutex );
+    if ( tail == head )
+    {
+      return {};
+    }
+    --tail;
+    count.store( tail - head );
+    return std::move( items[tail % QueueDepth] );
+  }
+
+  std::optional<T> try_steal()
+  {
+    if ( empty() )
+    {
+      return {};
+    }
+
+    std::scoped_lock l( items_mutex );
+    if ( tail == head )
+    {
+      return {};
+    }
+    std::optional<T> tmp = std::move( items[head % QueueDepth] );
+    ++head;
+    count.store( tail - head );
+    return tmp;
+  }
+
+  /* lock-free hint, may be outdated by the time it is used */
+  bool empty() const
+  {
+    return count.load() == 0u;
+  }
+
+private:
+  std::unique_ptr<T[]> items;
+  std::uint64_t head{0};
+  std::uint64_t tail{0};
+  std::atomic<std::uint64_t> count = ATOMIC_VAR_INIT( 0 );
+  spin_mutex items_mutex;
+}; /* work_stealing_deque */
+
+/* A task manager with one deque per worker.
+ *
+ * Tasks submitted by a worker are pushed to its own deque; tasks
+ * submitted from outside are distributed round-robin.  Idle workers
+ * steal from randomly chosen victims and park when there is no work
+ * left anywhere.  The interface mirrors `bounded_depth_task_manager`,
+ * where `QueueDepth` bounds each individual deque.  Without workers,
+ * tasks go to the deque of the external threads, which run them in
+ * `make_progress`, `parallel_for`, and the destructor.
+ */
+template<std::uint64_t QueueDepth, typename Task = ofats::any_invocable<void()>, bool Telemetry = false>
+struct work_stealing_task_manager
+{
+public:
+  using task_type = Task;
+
+  work_stealing_task_manager( std::uint64_t n, thread_placement const& placement = thread_placement::none() )
+    : worker_count( n )
+    , workers( n + 1u )
+    , victims( steal_order( n, placement ) )
+    , telemetry( n )
+    , threads( n, placement, [&]( std::stop_token s, std::uint64_t index ){ process_tasks( s, index ); } )
+  {}
+
+  ~work_stealing_task_manager()
+  {
+    /* help until every submitted task (including the ones spawned by tasks) has finished */
+    while ( !quiescent() )
+    {
+      if ( !run_one( worker_index() ) )
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    threads.request_stop();
+    wake_all();
+  }
+
+  void submit( std::invocable auto&& f )
+  {
+    std::uint64_t const self = worker_index();
+    workers[self].submitted.fetch_add( 1, std::memory_order_relaxed );
+
+    /* external submissions are spread over the workers (if any), internal ones stay local */
+    std::uint64_t target = self < num_workers() || num_workers() == 0u ? self : next_victim.fetch_add( 1, std::memory_order_relaxed ) % num_workers();
+    while ( !workers[target].tasks.try_push( std::forward<decltype( f )>( f ) ) )
+    {
+      telemetry.backpressure( self );
+      make_progress();
+    }
+
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( sleepers.load( std::memory_order_relaxed ) > 0u )
+    {
+      wake_one();
+    }
+  }
+
+  /* submits `f` and returns a future for its result */
+  auto submit( use_future_t, std::invocable auto&& f )
+  {
+    return detail::submit_with_future( *this, std::forward<decltype( f )>( f ) );
+  }
+
+  /* `co_await tm.schedule()` continues the awaiting coroutine on a worker of this manager */
+  auto schedule()
+  {
+    return detail::schedule_awaiter<work_stealing_task_manager>{*this};
+  }
+
+  /* submits one task per chunk of `grain` consecutive indices of `r` (e.g., `mockturtle::detail::range`), each calling `fn( index )` */
+  void submit_bulk( auto&& r, std::uint64_t grain, auto&& fn )
+  {
+    detail::submit_chunks( *this, *r.begin(), *r.end(), grain, fn );
+  }
+
+  /* calls `fn( index )` for all indices of `r` and waits for their completion
+   *
+   * The range is split in halves on demand: a task keeps one half and
+   * pushes the other one to its own deque, where idle workers can steal
+   * it, until no more than `grain` indices (adaptive if 0) are left.
+   */
+  void parallel_for( auto&& r, std::uint64_t grain, auto&& fn )
+  {
+    auto const first = *r.begin();
+    auto const last = *r.end();
+    if ( first == last )
+    {
+      return;
+    }
+
+    std::atomic<std::uint64_t> remaining( last - first );
+    split_range( first, last, detail::chunk_size( last - first, grain, num_workers() ), fn, remaining );
+
+    /* help instead of blocking */
+    while ( remaining.load( std::memory_order_acquire ) != 0 )
+    {
+      if ( !make_progress() )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  bool make_progress()
+  {
+    return run_one( worker_index() );
+  }
+
+  std::uint64_t num_workers() const
+  {
+    return worker_count;
+  }
+
+  /* snapshot of the per-worker counters (requires `Telemetry`) */
+  scheduler_statistics statistics() const requires Telemetry
+  {
+    return telemetry.snapshot();
+  }
+
+  /* index of the calling worker thread, or `num_workers()` if the caller is not a worker of this manager */
+  std::uint64_t worker_index() const
+  {
+    return detail::current_worker.owner == this ? detail::current_worker.index : num_workers();
+  }
+
+private:
+  struct alignas( cache_line_size ) worker_state
+  {
+    work_stealing_deque<task_type, QueueDepth> tasks;
+    std::atomic<std::uint64_t> submitted = ATOMIC_VAR_INIT( 0 );
+    std::atomic<std::uint64_t> executed = ATOMIC_VAR_INIT( 0 );
+  }; /* worker_state */
+
+  struct victim_list
+  {
+    std::vector<std::uint64_t> ids;
+    std::uint64_t local{0}; /* `ids[0, local)` are on the same NUMA node */
+  }; /* victim_list */
+
+  template<typename T, typename Fn>
+  void split_range( T begin, T end, std::uint64_t grain, Fn& fn, std::atomic<std::uint64_t>& remaining )
+  {
+    while ( static_cast<std::uint64_t>( end - begin ) > grain )
+    {
+      auto const mid = static_cast<T>( begin + ( end - begin ) / 2 );
+      submit( [this, mid, end, grain, &fn, &remaining]{ split_range( mid, end, grain, fn, remaining ); } );
+      end = mid;
+    }
+
+    for ( auto i = begin; i != end; ++i )
+    {
+      fn( i );
+    }
+    remaining.fetch_sub( end - begin, std::memory_order_release );
+  }
+
+  std::optional<task_type> try_acquire( std::uint64_t self )
+  {
+    /* own deque first; external threads only have one without workers */
+    if ( self < num_workers() || num_workers() == 0u )
+    {
+      if ( auto f = workers[self].tasks.try_pop() )
+      {
+        return f;
+      }
+    }
+
+    /* then steal, visiting workers on the own NUMA node first, each group starting at a random victim */
+    thread_local std::minstd_rand rng( std::random_device{}() );
+    auto const& order = victims[self];
+    for ( auto const& [first, last] : { std::pair{0ul, order.local}, std::pair{order.local, order.ids.size()} } )
+    {
+      std::uint64_t const n = last - first;
+      if ( n == 0u )
+      {
+        continue;
+      }
+
+      std::uint64_t const start = rng() % n;
+      for ( auto i : std::views::iota( 0ul, n ) )
+      {
+        auto f = workers[order.ids[first + ( start + i ) % n]].tasks.try_steal();
+        telemetry.steal( self, f.has_value() );
+        if ( f )
+        {
+          return f;
+        }
+      }
+    }
+    return {};
+  }
+
+  /* victims of each worker (and of external threads, last), same-node workers first */
+  static std::vector<victim_list> steal_order( std::uint64_t n, thread_placement const& placement )
+  {
+    auto const& topology = cpu_topology::system();
+    std::vector<std::uint32_t> nodes;
+    for ( auto i : std::views::iota( 0ul, n ) )
+    {
+      auto const cpu = placement.cpu_for( i, topology );
+      nodes.emplace_back( cpu ? topology.node_of( *cpu ) : 0u );
+    }
+
+    std::vector<victim_list> result( n + 1u );
+    for ( auto self : std::views::iota( 0ul, n + 1u ) )
+    {
+      auto& order = result[self];
+      for ( auto pass : { true, false } )
+      {
+        for ( auto victim : std::views::iota( 0ul, n ) )
+        {
+          /* external threads have no home node, every worker is local to them */
+          bool const local = self == n || nodes[victim] == nodes[self];
+          if ( victim != self && local == pass )
+          {
+            order.ids.emplace_back( victim );
+          }
+        }
+        if ( pass )
+        {
+          order.local = order.ids.size();
+        }
+      }
+    }
+    return result;
+  }
+
+  bool run_one( std::uint64_t self )
+  {
+    if ( auto f = try_acquire( self ) )
+    {
+      std::move( *f )();
+      workers[self].executed.fetch_add( 1, std::memory_order_release );
+      telemetry.executed( self );
+      return true;
+    }
+    return false;
+  }
+
+  bool has_queued_tasks() const
+  {
+    for ( auto i : std::views::iota( 0ul, num_workers() ) )
+    {
+      if ( !workers[i].tasks.empty() )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* all submitted tasks have been executed; counters are monotonic, so reading executed before submitted is conservative */
+  bool quiescent() const
+  {
+    std::uint64_t executed{0};
+    for ( auto const& w : workers )
+    {
+      executed += w.executed.load( std::memory_order_acquire );
+    }
+    std::uint64_t submitted{0};
+    for ( auto const& w : workers )
+    {
+      submitted += w.submitted.load( std::memory_order_acquire );
+    }
+    return executed == submitted;
+  }
+
+  void park( std::stop_token const& s, std::uint64_t index )
+  {
+    auto const start = telemetry.start_blocking();
+    auto const epoch = wakeups.load();
+    sleepers.fetch_add( 1 );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( !s.stop_requested() && !has_queued_tasks() )
+    {
+      std::atomic_wait_explicit( &wakeups, epoch, std::memory_order_acquire );
+    }
+    sleepers.fetch_sub( 1 );
+    telemetry.stop_blocking( index, start );
+  }
+
+  void wake_one()
+  {
+    wakeups.fetch_add( 1, std::memory_order_release );
+    std::atomic_notify_one( &wakeups );
+  }
+
+  void wake_all()
+  {
+    wakeups.fetch_add( 1, std::memory_order_release );
+    std::atomic_notify_all( &wakeups );
+  }
+
+  void process_tasks( std::stop_token s, std::uint64_t index )
+  {
+    detail::current_worker = {this, index};
+
+    while ( !s.stop_requested() )
+    {
+      if ( !run_one( index ) )
+      {
+        park( s, index );
+      }
+    }
+
+    while ( run_one( index ) )
+      ;
+  }
+
+private:
+  std::uint64_t const worker_count;
+  std::vector<worker_state> workers; /* one per worker, plus one shared by external threads */
+  std::vector<victim_list> const victims;
+  std::atomic<std::uint64_t> next_victim = ATOMIC_VAR_INIT( 0 );
+  std::atomic<std::uint32_t> wakeups = ATOMIC_VAR_INIT( 0 );
+  std::atomic<std::uint32_t> sleepers = ATOMIC_VAR_INIT( 0 );
+  [[no_unique_address]] detail::scheduler_telemetry<Telemetry> telemetry;
+  thread_group threads;
+}; /* work_stealing_task_manager */
+
+} // sandbox
@@ -54,6 +54,20 @@ The strategy is chosen this way, by platform:
 //#define __NO_SPIN
 //#define __NO_WAIT
 
+#if __has_include(<version>)
+    #include <version>
+#endif
+
+// Use the standard library when it already ships the C++20 synchronization library
+#if defined(__cpp_lib_atomic_wait) && defined(__cpp_lib_semaphore) && defined(__cpp_lib_latch)
+
+#include <atomic>
+#include <latch>
+#include <semaphore>
+#include <thread>
+
+#else
+
 #ifndef __ATOMIC_WAIT_INCLUDED
 #define __ATOMIC_WAIT_INCLUDED
 
@@ -948,3 +962,5 @@ contended_t * __contention(volatile void const * p) {
 
 thread_local size_t __barrier_favorite_hash =
     std::hash<std::thread::id>()(std::this_thread::get_id());
+
+#endif // __cpp_lib_atomic_wait && __cpp_lib_semaphore && __cpp_lib_latch
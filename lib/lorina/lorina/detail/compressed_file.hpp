@@ -0,0 +1,337 @@
+/* lorina: C++ parsing library
+ * Copyright (C) 2018-2021  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*! \cond PRIVATE */
+
+#pragma once
+
+#include <lorina/detail/tokenizer.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef LORINA_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace lorina
+{
+
+namespace detail
+{
+
+/* Decompresses an input on a thread of its own.
+ *
+ * The thread fills `Depth` buffers of `chunk_size` bytes in turn with
+ * `read( data, capacity )`, which returns the number of bytes read (0
+ * at the end) or a negative number on an error, and hands them to the
+ * consumer in order.  It waits while all buffers are in use, so
+ * decompression runs at most `Depth` chunks ahead of the tokenizer.
+ */
+template<uint32_t Depth = 4u>
+class chunk_pipe : public chunk_source
+{
+public:
+  static constexpr std::size_t chunk_size = 1u << 20u;
+
+  using read_function = std::function<int64_t( char*, std::size_t )>;
+
+  explicit chunk_pipe( read_function read )
+    : _read( std::move( read ) )
+  {
+    for ( auto& b : _buffers )
+    {
+      b.resize( chunk_size );
+    }
+    _thread = std::thread( [this]{ produce(); } );
+  }
+
+  chunk_pipe( const chunk_pipe& ) = delete;
+  chunk_pipe& operator=( const chunk_pipe& ) = delete;
+
+  ~chunk_pipe() override
+  {
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+  }
+
+  std::string_view next() override
+  {
+    std::unique_lock<std::mutex> lock( _mutex );
+    if ( _holding )
+    {
+      /* the previous chunk is no longer referenced */
+      ++_released;
+      _holding = false;
+      _cv.notify_all();
+    }
+    _cv.wait( lock, [this]{ return _produced > _released || _finished; } );
+    if ( _produced == _released )
+    {
+      return {};
+    }
+    _holding = true;
+    uint64_t const slot = _released % Depth;
+    return std::string_view( _buffers[slot].data(), _sizes[slot] );
+  }
+
+  bool good() const override
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    return !_failed;
+  }
+
+private:
+  void produce()
+  {
+    while ( true )
+    {
+      uint64_t slot;
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        _cv.wait( lock, [this]{ return _produced - _released < Depth || _stop; } );
+        if ( _stop )
+        {
+          break;
+        }
+        slot = _produced % Depth;
+      }
+
+      /* fill the free buffer without holding the lock */
+      std::size_t size{0};
+      int64_t n{0};
+      while ( size < chunk_size && ( n = _read( _buffers[slot].data() + size, chunk_size - size ) ) > 0 )
+      {
+        size += static_cast<std::size_t>( n );
+      }
+
+      std::lock_guard<std::mutex> lock( _mutex );
+      if ( size > 0u )
+      {
+        _sizes[slot] = size;
+        ++_produced;
+      }
+      if ( n <= 0 )
+      {
+        _failed = n < 0;
+        break;
+      }
+      _cv.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock( _mutex );
+    _finished = true;
+    _cv.notify_all();
+  }
+
+private:
+  read_function _read;
+  std::array<std::vector<char>, Depth> _buffers;
+  std::array<std::size_t, Depth> _sizes{};
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  uint64_t _produced = 0u; /* chunks filled */
+  uint64_t _released = 0u; /* chunks handed out and given back */
+  bool _holding = false;   /* the consumer references chunk `_released` */
+  bool _finished = false;
+  bool _failed = false;
+  bool _stop = false;
+  std::thread _thread;
+}; /* chunk_pipe */
+
+#ifdef LORINA_HAS_ZLIB
+/* gzip file, inflated with zlib */
+class gzip_chunk_source : public chunk_source
+{
+public:
+  explicit gzip_chunk_source( const std::string& filename )
+    : _file( gzopen( filename.c_str(), "rb" ) )
+  {
+    if ( _file != nullptr )
+    {
+      gzbuffer( _file, 1u << 17u );
+      _pipe = std::make_unique<chunk_pipe<>>( [this]( char* data, std::size_t capacity ) -> int64_t {
+        return gzread( _file, data, static_cast<unsigned>( capacity ) );
+      } );
+    }
+  }
+
+  ~gzip_chunk_source() override
+  {
+    _pipe.reset();
+    if ( _file != nullptr )
+    {
+      gzclose( _file );
+    }
+  }
+
+  bool is_open() const
+  {
+    return _file != nullptr;
+  }
+
+  std::string_view next() override
+  {
+    return _pipe->next();
+  }
+
+  bool good() const override
+  {
+    return _pipe->good();
+  }
+
+private:
+  gzFile _file;
+  std::unique_ptr<chunk_pipe<>> _pipe;
+}; /* gzip_chunk_source */
+#endif
+
+#ifndef _WIN32
+/* standard output of a decompressor process, e.g., `zstd -dc` */
+class command_chunk_source : public chunk_source
+{
+public:
+  explicit command_chunk_source( const std::string& command )
+    : _file( ::popen( command.c_str(), "r" ) )
+  {
+    if ( _file != nullptr )
+    {
+      _pipe = std::make_unique<chunk_pipe<>>( [this]( char* data, std::size_t capacity ) -> int64_t {
+        std::size_t const n = std::fread( data, 1u, capacity, _file );
+        return ( n == 0u && std::ferror( _file ) ) ? -1 : static_cast<int64_t>( n );
+      } );
+    }
+  }
+
+  ~command_chunk_source() override
+  {
+    _pipe.reset();
+    if ( _file != nullptr )
+    {
+      ::pclose( _file );
+    }
+  }
+
+  bool is_open() const
+  {
+    return _file != nullptr;
+  }
+
+  std::string_view next() override
+  {
+    std::string_view const chunk = _pipe->next();
+    if ( chunk.empty() && _file != nullptr )
+    {
+      /* the exit status tells whether the decompressor failed */
+      _status = ::pclose( _file );
+      _file = nullptr;
+    }
+    return chunk;
+  }
+
+  bool good() const override
+  {
+    return _pipe->good() && _status == 0;
+  }
+
+private:
+  FILE* _file;
+  int _status = 0; /* exit status once the output is exhausted */
+  std::unique_ptr<chunk_pipe<>> _pipe;
+}; /* command_chunk_source */
+#endif
+
+inline bool ends_with( std::string_view s, std::string_view suffix )
+{
+  return s.size() >= suffix.size() && s.substr( s.size() - suffix.size() ) == suffix;
+}
+
+/* single-quoted for `/bin/sh` */
+inline std::string shell_quote( std::string_view s )
+{
+  std::string quoted( "'" );
+  for ( char c : s )
+  {
+    quoted += c == '\'' ? std::string( "'\\''" ) : std::string( 1u, c );
+  }
+  return quoted + "'";
+}
+
+/*! \brief Whether `filename` names a compressed file (`.gz`, `.zst`). */
+inline bool is_compressed_filename( std::string_view filename )
+{
+  return ends_with( filename, ".gz" ) || ends_with( filename, ".zst" );
+}
+
+/* Opens the compressed file `filename`: gzip with zlib (if lorina is
+ * built with `LORINA_HAS_ZLIB`, otherwise with `gzip -dc`), zstd with
+ * `zstd -dc`.  Returns nullptr if the file cannot be opened.
+ */
+inline std::unique_ptr<chunk_source> open_compressed( const std::string& filename )
+{
+  std::FILE* const probe = std::fopen( filename.c_str(), "rb" );
+  if ( probe == nullptr )
+  {
+    return nullptr;
+  }
+  std::fclose( probe );
+
+#ifdef LORINA_HAS_ZLIB
+  if ( ends_with( filename, ".gz" ) )
+  {
+    auto source = std::make_unique<gzip_chunk_source>( filename );
+    return source->is_open() ? std::move( source ) : nullptr;
+  }
+#endif
+#ifndef _WIN32
+  std::string const tool = ends_with( filename, ".zst" ) ? "zstd" : "gzip";
+  auto source = std::make_unique<command_chunk_source>( tool + " -dc -- " + shell_quote( filename ) );
+  return source->is_open() ? std::move( source ) : nullptr;
+#else
+  (void)filename;
+  return nullptr;
+#endif
+}
+
+} // namespace detail
+
+} // namespace lorina
+
+/*! \endcond */
@@ -0,0 +1,134 @@
+/* lorina: C++ parsing library
+ * Copyright (C) 2018-2021  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*! \cond PRIVATE */
+
+#pragma once
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lorina
+{
+
+namespace detail
+{
+
+/* Read-only view of the contents of a file.
+ *
+ * The file is memory-mapped where POSIX `mmap` is available and read
+ * into memory otherwise.  `is_open` is false if the file could not be
+ * opened.
+ */
+class mapped_file
+{
+public:
+  explicit mapped_file( const std::string& filename )
+  {
+#ifndef _WIN32
+    int const fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      return;
+    }
+
+    struct stat st;
+    if ( ::fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) )
+    {
+      _size = static_cast<std::size_t>( st.st_size );
+      _open = true;
+      if ( _size > 0u )
+      {
+        void* const p = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( p != MAP_FAILED )
+        {
+          ::madvise( p, _size, MADV_SEQUENTIAL );
+          _data = static_cast<char const*>( p );
+        }
+        else
+        {
+          _open = false;
+        }
+      }
+    }
+    ::close( fd );
+#else
+    std::ifstream in( filename, std::ifstream::in | std::ifstream::binary );
+    if ( in.is_open() )
+    {
+      _buffer.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+      _data = _buffer.data();
+      _size = _buffer.size();
+      _open = true;
+    }
+#endif
+  }
+
+  mapped_file( const mapped_file& ) = delete;
+  mapped_file& operator=( const mapped_file& ) = delete;
+
+  ~mapped_file()
+  {
+#ifndef _WIN32
+    if ( _data != nullptr )
+    {
+      ::munmap( const_cast<char*>( _data ), _size );
+    }
+#endif
+  }
+
+  bool is_open() const
+  {
+    return _open;
+  }
+
+  std::string_view view() const
+  {
+    return std::string_view( _data, _data ? _size : 0u );
+  }
+
+private:
+  char const* _data = nullptr;
+  std::size_t _size = 0u;
+  bool _open = false;
+#ifdef _WIN32
+  std::string _buffer;
+#endif
+}; /* mapped_file */
+
+} // namespace detail
+
+} // namespace lorina
+
+/*! \endcond */
@@ -0,0 +1,122 @@
+/* lorina: C++ parsing library
+ * Copyright (C) 2018-2021  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*! \cond PRIVATE */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lorina
+{
+
+namespace detail
+{
+
+/* Interns names as dense ids `0, 1, 2, ...`.
+ *
+ * The characters of all names are copied once into large arena chunks
+ * that never move, so the table can key its hash map `Map` with
+ * `std::string_view`s into the arena; looking up a name neither
+ * allocates nor copies it.  Use the ids to index flat vectors of
+ * per-name data.
+ */
+template<typename Map = std::unordered_map<std::string_view, uint32_t>>
+class basic_symbol_table
+{
+public:
+  static constexpr uint32_t npos = ~uint32_t( 0 );
+  static constexpr std::size_t chunk_size = 1u << 16u;
+
+  /* id of `name`, which is added if it is new */
+  uint32_t intern( std::string_view name )
+  {
+    auto const it = ids.find( name );
+    if ( it != ids.end() )
+    {
+      return it->second;
+    }
+
+    uint32_t const id = static_cast<uint32_t>( names.size() );
+    auto const stored = store( name );
+    names.emplace_back( stored );
+    ids.emplace( stored, id );
+    return id;
+  }
+
+  /* id of `name`, or `npos` if it has not been interned */
+  uint32_t find( std::string_view name ) const
+  {
+    auto const it = ids.find( name );
+    return it == ids.end() ? npos : it->second;
+  }
+
+  std::string_view name( uint32_t id ) const
+  {
+    return names[id];
+  }
+
+  uint32_t size() const
+  {
+    return static_cast<uint32_t>( names.size() );
+  }
+
+  void reserve( uint32_t n )
+  {
+    names.reserve( n );
+    ids.reserve( n );
+  }
+
+private:
+  std::string_view store( std::string_view name )
+  {
+    if ( chunks.empty() || used + name.size() > chunk_size )
+    {
+      chunks.emplace_back( new char[std::max( chunk_size, name.size() )] );
+      used = 0u;
+    }
+    char* const dst = chunks.back().get() + used;
+    std::memcpy( dst, name.data(), name.size() );
+    used += name.size();
+    return std::string_view( dst, name.size() );
+  }
+
+private:
+  std::vector<std::unique_ptr<char[]>> chunks;
+  std::size_t used{0}; /* bytes used in the last chunk */
+  std::vector<std::string_view> names;
+  Map ids;
+}; /* basic_symbol_table */
+
+} // namespace detail
+} // namespace lorina
+
+/*! \endcond */
@@ -26,8 +26,13 @@
 #pragma once
 
 #include <lorina/detail/utils.hpp>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 namespace lorina
 {
@@ -45,6 +50,8 @@ enum class tokenizer_return_code
 class tokenizer
 {
 public:
+  using input_type = std::istream&;
+
   explicit tokenizer( std::istream& is )
     : _is( is )
   {}
@@ -143,6 +150,317 @@ protected:
   std::string lookahead;
 }; /* tokenizer */
 
+/*! \brief Character classes of the tokenizers. */
+enum class char_class : uint8_t
+{
+  regular   = 0
+, separator = 1 /* ' ', '\\', '\n': ends a token */
+, delimiter = 2 /* single-character token */
+, quote     = 3
+};
+
+inline constexpr std::array<char_class, 256u> make_char_classes()
+{
+  std::array<char_class, 256u> table{};
+  for ( unsigned char c : std::string_view( " \\\n" ) )
+  {
+    table[c] = char_class::separator;
+  }
+  for ( unsigned char c : std::string_view( "(){};:,~&|^#[]" ) )
+  {
+    table[c] = char_class::delimiter;
+  }
+  table[static_cast<unsigned char>( '"' )] = char_class::quote;
+  return table;
+}
+
+inline constexpr std::array<char_class, 256u> char_classes = make_char_classes();
+
+/*! \brief Tokenizer over an in-memory buffer.
+ *
+ * Produces the same tokens as `tokenizer`, but returns them as views
+ * into the buffer (e.g., a memory-mapped file), classifies characters
+ * through a lookup table, and does not allocate.  The buffer must
+ * outlive the tokens.
+ */
+class buffer_tokenizer
+{
+public:
+  using input_type = std::string_view;
+
+  explicit buffer_tokenizer( std::string_view buffer )
+    : _pos( buffer.data() )
+    , _end( buffer.data() + buffer.size() )
+  {}
+
+  tokenizer_return_code get_token_internal( std::string_view& token )
+  {
+    if ( _done )
+    {
+      return tokenizer_return_code::invalid;
+    }
+
+    char const* const begin = _pos;
+    if ( _comment_mode )
+    {
+      /* the rest of the line */
+      char const* const newline = static_cast<char const*>( std::memchr( _pos, '\n', _end - _pos ) );
+      if ( newline == nullptr )
+      {
+        _pos = _end;
+        _done = true;
+        token = trimmed( begin, _end );
+        return tokenizer_return_code::valid;
+      }
+      _pos = newline + 1;
+      _comment_mode = false;
+      token = trimmed( begin, newline );
+      return tokenizer_return_code::comment;
+    }
+
+    while ( _pos != _end )
+    {
+      char_class const cls = _quote_mode && *_pos != '"' ? char_class::regular : char_classes[static_cast<unsigned char>( *_pos )];
+      switch ( cls )
+      {
+      case char_class::regular:
+        ++_pos;
+        break;
+
+      case char_class::quote:
+        _quote_mode = !_quote_mode;
+        ++_pos;
+        break;
+
+      case char_class::separator:
+        token = trimmed( begin, _pos++ );
+        return tokenizer_return_code::valid;
+
+      case char_class::delimiter:
+        /* a delimiter is a token of its own */
+        if ( _pos == begin )
+        {
+          ++_pos;
+        }
+        token = trimmed( begin, _pos );
+        return tokenizer_return_code::valid;
+      }
+    }
+
+    _done = true;
+    token = trimmed( begin, _end );
+    return tokenizer_return_code::valid;
+  }
+
+  tokenizer_return_code get_token_internal( std::string& token )
+  {
+    std::string_view view;
+    auto const result = get_token_internal( view );
+    token.assign( view.data(), view.size() );
+    return result;
+  }
+
+  bool get_token( std::string_view& token )
+  {
+    tokenizer_return_code result;
+    do
+    {
+      result = get_token_internal( token );
+
+      /* keep parsing if token is empty */
+    } while ( token.empty() && result == tokenizer_return_code::valid );
+
+    return ( result == tokenizer_return_code::valid );
+  }
+
+  void set_comment_mode( bool value = true )
+  {
+    _comment_mode = value;
+  }
+
+  bool get_comment_mode() const
+  {
+    return _comment_mode;
+  }
+
+protected:
+  /* same as `detail::trim` */
+  static std::string_view trimmed( char const* begin, char const* end )
+  {
+    while ( begin != end && std::isspace( static_cast<unsigned char>( *begin ) ) )
+    {
+      ++begin;
+    }
+    while ( end != begin && std::isspace( static_cast<unsigned char>( *( end - 1 ) ) ) )
+    {
+      --end;
+    }
+    return std::string_view( begin, end - begin );
+  }
+
+protected:
+  bool _done = false;
+  bool _quote_mode = false;
+  bool _comment_mode = false;
+  char const* _pos;
+  char const* _end;
+}; /* buffer_tokenizer */
+
+/*! \brief Source of consecutive chunks of an input.
+ *
+ * `next` returns the next chunk, or an empty view at the end of the
+ * input (or on an error, see `good`).  A chunk stays valid until the
+ * following call of `next`.
+ */
+class chunk_source
+{
+public:
+  virtual ~chunk_source() = default;
+
+  virtual std::string_view next() = 0;
+
+  /*! \brief False if reading the input failed. */
+  virtual bool good() const
+  {
+    return true;
+  }
+}; /* chunk_source */
+
+/*! \brief Tokenizer over the chunks of a `chunk_source`.
+ *
+ * Produces the same tokens as `buffer_tokenizer`, scanning each chunk
+ * in place; only tokens that straddle two chunks are assembled from
+ * both, so the input is never materialized as a whole.
+ */
+class chunked_tokenizer
+{
+public:
+  using input_type = chunk_source&;
+
+  explicit chunked_tokenizer( chunk_source& source )
+    : _source( source )
+  {}
+
+  tokenizer_return_code get_token_internal( std::string& token )
+  {
+    token.clear();
+    if ( _done )
+    {
+      return tokenizer_return_code::invalid;
+    }
+
+    if ( _comment_mode )
+    {
+      /* the rest of the line */
+      while ( fill() )
+      {
+        char const* const newline = static_cast<char const*>( std::memchr( _pos, '\n', _end - _pos ) );
+        if ( newline != nullptr )
+        {
+          token.append( _pos, newline );
+          _pos = newline + 1;
+          _comment_mode = false;
+          detail::trim( token );
+          return tokenizer_return_code::comment;
+        }
+        token.append( _pos, _end );
+        _pos = _end;
+      }
+      _done = true;
+      detail::trim( token );
+      return tokenizer_return_code::valid;
+    }
+
+    while ( fill() )
+    {
+      char const* const begin = _pos;
+      while ( _pos != _end )
+      {
+        char_class const cls = _quote_mode && *_pos != '"' ? char_class::regular : char_classes[static_cast<unsigned char>( *_pos )];
+        switch ( cls )
+        {
+        case char_class::regular:
+          ++_pos;
+          break;
+
+        case char_class::quote:
+          _quote_mode = !_quote_mode;
+          ++_pos;
+          break;
+
+        case char_class::separator:
+          token.append( begin, _pos++ );
+          detail::trim( token );
+          return tokenizer_return_code::valid;
+
+        case char_class::delimiter:
+          /* a delimiter is a token of its own */
+          if ( _pos == begin && token.empty() )
+          {
+            ++_pos;
+          }
+          token.append( begin, _pos );
+          detail::trim( token );
+          return tokenizer_return_code::valid;
+        }
+      }
+      token.append( begin, _end );
+    }
+
+    _done = true;
+    detail::trim( token );
+    return tokenizer_return_code::valid;
+  }
+
+  bool get_token( std::string& token )
+  {
+    tokenizer_return_code result;
+    do
+    {
+      result = get_token_internal( token );
+
+      /* keep parsing if token is empty */
+    } while ( token.empty() && result == tokenizer_return_code::valid );
+
+    return ( result == tokenizer_return_code::valid );
+  }
+
+  void set_comment_mode( bool value = true )
+  {
+    _comment_mode = value;
+  }
+
+  bool get_comment_mode() const
+  {
+    return _comment_mode;
+  }
+
+protected:
+  /* makes `[_pos, _end)` non-empty unless the input is exhausted */
+  bool fill()
+  {
+    while ( _pos == _end )
+    {
+      std::string_view const chunk = _source.next();
+      if ( chunk.empty() )
+      {
+        return false;
+      }
+      _pos = chunk.data();
+      _end = chunk.data() + chunk.size();
+    }
+    return true;
+  }
+
+protected:
+  bool _done = false;
+  bool _quote_mode = false;
+  bool _comment_mode = false;
+  chunk_source& _source;
+  char const* _pos = nullptr;
+  char const* _end = nullptr;
+}; /* chunked_tokenizer */
+
 } // namespace detail
 
 } // namespace lorina
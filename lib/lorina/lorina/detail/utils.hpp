@@ -27,12 +27,16 @@
 
 #pragma once
 
+#include <lorina/detail/symbol_table.hpp>
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <cassert>
 #include <cctype>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <locale>
@@ -40,6 +44,8 @@
 #include <numeric>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -211,6 +217,170 @@ private:
   std::unordered_map<std::string, std::tuple<Args...>> _stored_params;
 }; /* call_in_topological_order */
 
+/* Invokes `f` for every gate once all of its inputs are known, like
+ * `call_in_topological_order`, but on interned integer ids.
+ *
+ * Names are interned once in a `basic_symbol_table`, the same arena
+ * table the readers intern their signals in; the state of a name is a byte, the number
+ * of unknown inputs of a waiting gate a counter, and the gates waiting
+ * for a name are kept as a linked list in one flat edge vector.  A
+ * gate whose inputs are all known is invoked directly without storing
+ * anything; the parameters of a deferred gate are moved into a slot
+ * and moved out again when it is invoked.  Gates released by the same
+ * name are invoked in the order in which they were deferred, depth
+ * first.
+ */
+template<typename... Args>
+class topological_resolver
+{
+public:
+  static constexpr uint32_t npos = ~uint32_t( 0 );
+
+  explicit topological_resolver( std::function<void(Args...)> f )
+    : f( std::move( f ) )
+  {
+  }
+
+  void declare_known( std::string_view known )
+  {
+    _state[id( known )] = known_state;
+  }
+
+  /* marks `name` as known and invokes the gates that were waiting for it */
+  void define( std::string_view name )
+  {
+    release( id( name ) );
+  }
+
+  void call_deferred( std::initializer_list<std::string_view> inputs, std::string_view output, Args... params )
+  {
+    uint32_t const out = id( output );
+
+    /* collect the distinct unknown inputs */
+    _unknown.clear();
+    for ( auto const& input : inputs )
+    {
+      uint32_t const in = id( input );
+      if ( _state[in] == known_state || std::find( _unknown.begin(), _unknown.end(), in ) != _unknown.end() )
+        continue;
+      _unknown.push_back( in );
+    }
+    uint32_t const num_unknown = static_cast<uint32_t>( _unknown.size() );
+
+    if ( num_unknown == 0u && _state[out] != waiting_state )
+    {
+      /* fast path: all inputs are known */
+      f( std::move( params )... );
+      release( out );
+      return;
+    }
+
+    /* defer computation */
+    if ( _slot[out] == npos )
+    {
+      _slot[out] = static_cast<uint32_t>( _stored_params.size() );
+      _stored_params.emplace_back( std::move( params )... );
+    }
+    else
+    {
+      _stored_params[_slot[out]] = std::tuple<Args...>( std::move( params )... );
+    }
+    _state[out] = waiting_state;
+    _pending[out] += num_unknown;
+    for ( uint32_t const in : _unknown )
+    {
+      _edges.emplace_back( out, _first_trigger[in] );
+      _first_trigger[in] = static_cast<uint32_t>( _edges.size() - 1u );
+    }
+  }
+
+  std::vector<std::pair<std::string,std::string>> unresolved_dependencies()
+  {
+    std::vector<std::pair<std::string,std::string>> deps;
+    for ( uint32_t in = 0u; in < _symbols.size(); ++in )
+    {
+      if ( _state[in] == known_state )
+        continue;
+
+      for ( uint32_t e = _first_trigger[in]; e != npos; e = _edges[e].second )
+      {
+        if ( _state[_edges[e].first] == waiting_state )
+        {
+          deps.emplace_back( _symbols.name( _edges[e].first ), _symbols.name( in ) );
+        }
+      }
+    }
+    return deps;
+  }
+
+private:
+  static constexpr uint8_t unseen_state = 0u;
+  static constexpr uint8_t known_state = 1u;
+  static constexpr uint8_t waiting_state = 2u;
+
+  uint32_t id( std::string_view name )
+  {
+    uint32_t const i = _symbols.intern( name );
+    if ( i < _state.size() )
+    {
+      return i;
+    }
+
+    _state.emplace_back( unseen_state );
+    _pending.emplace_back( 0u );
+    _first_trigger.emplace_back( npos );
+    _slot.emplace_back( npos );
+    return i;
+  }
+
+  void invoke( uint32_t out )
+  {
+    std::apply( f, std::move( _stored_params[_slot[out]] ) );
+    _stored_params[_slot[out]] = std::tuple<Args...>();
+  }
+
+  /* marks `known` as known and invokes every gate that only waited for it (transitively) */
+  void release( uint32_t known )
+  {
+    _state[known] = known_state;
+    _stack.push_back( known );
+    while ( !_stack.empty() )
+    {
+      uint32_t const next = _stack.back();
+      _stack.pop_back();
+      if ( _state[next] == waiting_state )
+      {
+        invoke( next );
+        _state[next] = known_state;
+      }
+
+      /* the list is newest first, so the oldest waiting gate ends up on top of the stack */
+      for ( uint32_t e = _first_trigger[next]; e != npos; e = _edges[e].second )
+      {
+        uint32_t const other = _edges[e].first;
+        if ( _state[other] == waiting_state && --_pending[other] == 0u )
+        {
+          _stack.push_back( other );
+        }
+      }
+      _first_trigger[next] = npos;
+    }
+  }
+
+private:
+  std::function<void(Args...)> f;
+
+  basic_symbol_table<> _symbols;
+  std::vector<uint8_t> _state;
+  std::vector<uint32_t> _pending;                       /* unknown inputs of a waiting gate */
+  std::vector<uint32_t> _first_trigger;                 /* head of the list of gates waiting for a name */
+  std::vector<std::pair<uint32_t, uint32_t>> _edges;    /* (waiting gate, next edge) */
+  std::vector<uint32_t> _slot;                          /* index into `_stored_params` */
+  std::vector<std::tuple<Args...>> _stored_params;
+  std::vector<uint32_t> _unknown;                       /* scratch of `call_deferred` */
+  std::vector<uint32_t> _stack;
+}; /* topological_resolver */
+
 template<typename T>
 inline std::string join( const T& t, const std::string& sep )
 {
@@ -0,0 +1,321 @@
+/* lorina: C++ parsing library
+ * Copyright (C) 2018-2021  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*! \cond PRIVATE */
+
+#pragma once
+
+#include "../verilog_regex.hpp"
+
+#include <array>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace lorina
+{
+
+namespace detail
+{
+
+/* Shape and operands of the right-hand side of an assign */
+struct verilog_expression
+{
+  enum class shape : uint8_t
+  {
+    none
+  , immediate      /* a */
+  , binary         /* a op b */
+  , negated_binary /* ~(a op b) */
+  , ternary        /* a op b op2 c */
+  , maj3           /* (a&b)|(a&c)|(b&c), 6 operands */
+  };
+
+  shape kind = shape::none;
+  char op = 0;
+  char op2 = 0;
+  uint32_t num_operands = 0u;
+  std::array<std::pair<std::string_view, bool>, 6u> operands; /* name, complemented */
+}; /* verilog_expression */
+
+/* Hand-written matcher for the right-hand sides accepted by `verilog_regex`.
+ *
+ * The expression (tokens concatenated without spaces) is split into at
+ * most `max_lexemes` lexemes in one pass; the lexeme sequence is then
+ * compared against the fixed gate shapes.  No backtracking, no
+ * allocation; operand names are views into the expression.
+ */
+class verilog_expression_matcher
+{
+public:
+  static constexpr uint32_t max_lexemes = 32u;
+
+  /* returns false if `s` has none of the shapes (or is too long to be one) */
+  bool match( std::string_view s, verilog_expression& e )
+  {
+    e = verilog_expression{};
+    return lex( s ) && ( match_immediate( e ) || match_binary( e ) || match_negated_binary( e ) ||
+                         match_ternary( e ) || match_maj3( e ) );
+  }
+
+private:
+  /* [[:alnum:]\[\]_'] */
+  static bool is_identifier_char( char c )
+  {
+    return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) ||
+           c == '[' || c == ']' || c == '_' || c == '\'';
+  }
+
+  bool lex( std::string_view s )
+  {
+    num_lexemes = 0u;
+    std::size_t i = 0u;
+    while ( i < s.size() )
+    {
+      if ( num_lexemes == max_lexemes )
+      {
+        return false;
+      }
+
+      char const c = s[i];
+      if ( is_identifier_char( c ) )
+      {
+        std::size_t j = i + 1u;
+        while ( j < s.size() && is_identifier_char( s[j] ) )
+        {
+          ++j;
+        }
+        lexemes[num_lexemes++] = {'a', s.substr( i, j - i )};
+        i = j;
+      }
+      else if ( c == '~' || c == '(' || c == ')' || c == '&' || c == '|' || c == '^' )
+      {
+        lexemes[num_lexemes++] = {c, {}};
+        ++i;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  char kind( uint32_t i ) const
+  {
+    return i < num_lexemes ? lexemes[i].first : 0;
+  }
+
+  static bool is_operator( char c )
+  {
+    return c == '&' || c == '|' || c == '^';
+  }
+
+  /* matches `(~)?name` at lexeme `i` and appends it to the operands */
+  bool operand( uint32_t& i, verilog_expression& e ) const
+  {
+    bool const complemented = kind( i ) == '~';
+    uint32_t const j = complemented ? i + 1u : i;
+    if ( kind( j ) != 'a' )
+    {
+      return false;
+    }
+    e.operands[e.num_operands++] = {lexemes[j].second, complemented};
+    i = j + 1u;
+    return true;
+  }
+
+  /* (~)?\(?name\)? */
+  bool match_immediate( verilog_expression& e ) const
+  {
+    uint32_t i = 0u;
+    bool const complemented = kind( i ) == '~';
+    i += complemented ? 1u : 0u;
+    i += kind( i ) == '(' ? 1u : 0u;
+    if ( kind( i ) != 'a' )
+    {
+      return false;
+    }
+    auto const name = lexemes[i++].second;
+    i += kind( i ) == ')' ? 1u : 0u;
+    if ( i != num_lexemes )
+    {
+      return false;
+    }
+
+    e.kind = verilog_expression::shape::immediate;
+    e.num_operands = 1u;
+    e.operands[0] = {name, complemented};
+    return true;
+  }
+
+  /* (~)?a op (~)?b */
+  bool match_binary( verilog_expression& e ) const
+  {
+    uint32_t i = 0u;
+    verilog_expression r;
+    if ( !operand( i, r ) || !is_operator( kind( i ) ) )
+    {
+      return false;
+    }
+    r.op = kind( i++ );
+    if ( !operand( i, r ) || i != num_lexemes )
+    {
+      return false;
+    }
+
+    r.kind = verilog_expression::shape::binary;
+    e = r;
+    return true;
+  }
+
+  /* ~\((~)?a op (~)?b\) */
+  bool match_negated_binary( verilog_expression& e ) const
+  {
+    uint32_t i = 0u;
+    verilog_expression r;
+    if ( kind( i++ ) != '~' || kind( i++ ) != '(' || !operand( i, r ) || !is_operator( kind( i ) ) )
+    {
+      return false;
+    }
+    r.op = kind( i++ );
+    if ( !operand( i, r ) || kind( i++ ) != ')' || i != num_lexemes )
+    {
+      return false;
+    }
+
+    r.kind = verilog_expression::shape::negated_binary;
+    e = r;
+    return true;
+  }
+
+  /* (~)?a op (~)?b op2 (~)?c */
+  bool match_ternary( verilog_expression& e ) const
+  {
+    uint32_t i = 0u;
+    verilog_expression r;
+    if ( !operand( i, r ) || !is_operator( kind( i ) ) )
+    {
+      return false;
+    }
+    r.op = kind( i++ );
+    if ( !operand( i, r ) || !is_operator( kind( i ) ) )
+    {
+      return false;
+    }
+    r.op2 = kind( i++ );
+    if ( !operand( i, r ) || i != num_lexemes )
+    {
+      return false;
+    }
+
+    r.kind = verilog_expression::shape::ternary;
+    e = r;
+    return true;
+  }
+
+  /* \((~)?a&(~)?b\)\|\((~)?a&(~)?c\)\|\((~)?b&(~)?c\) */
+  bool match_maj3( verilog_expression& e ) const
+  {
+    uint32_t i = 0u;
+    verilog_expression r;
+    for ( uint32_t k = 0u; k < 3u; ++k )
+    {
+      if ( ( k > 0u && kind( i++ ) != '|' ) || kind( i++ ) != '(' ||
+           !operand( i, r ) || kind( i++ ) != '&' || !operand( i, r ) || kind( i++ ) != ')' )
+      {
+        return false;
+      }
+    }
+    if ( i != num_lexemes )
+    {
+      return false;
+    }
+
+    r.kind = verilog_expression::shape::maj3;
+    e = r;
+    return true;
+  }
+
+private:
+  std::array<std::pair<char, std::string_view>, max_lexemes> lexemes; /* kind ('a' for names), name */
+  uint32_t num_lexemes = 0u;
+}; /* verilog_expression_matcher */
+
+/* the same shapes matched through `verilog_regex` (fallback); the operand names are views into `s` */
+inline bool match_verilog_expression_regex( std::string const& s, verilog_expression& e )
+{
+  auto const view = [&]( std::ssub_match const& m ){
+    return std::string_view( s.data() + ( m.first - s.begin() ), m.length() );
+  };
+  auto const set_operands = [&]( std::smatch const& sm, std::initializer_list<std::pair<int, int>> groups ){
+    e.num_operands = 0u;
+    for ( auto const& [neg, name] : groups )
+    {
+      e.operands[e.num_operands++] = {view( sm[name] ), sm[neg] == "~"};
+    }
+  };
+
+  e = verilog_expression{};
+  std::smatch sm;
+  if ( std::regex_match( s, sm, verilog_regex::immediate_assign ) )
+  {
+    e.kind = verilog_expression::shape::immediate;
+    set_operands( sm, {{1, 2}} );
+  }
+  else if ( std::regex_match( s, sm, verilog_regex::binary_expression ) )
+  {
+    e.kind = verilog_expression::shape::binary;
+    e.op = sm[3].str()[0];
+    set_operands( sm, {{1, 2}, {4, 5}} );
+  }
+  else if ( std::regex_match( s, sm, verilog_regex::negated_binary_expression ) )
+  {
+    e.kind = verilog_expression::shape::negated_binary;
+    e.op = sm[3].str()[0];
+    set_operands( sm, {{1, 2}, {4, 5}} );
+  }
+  else if ( std::regex_match( s, sm, verilog_regex::ternary_expression ) )
+  {
+    e.kind = verilog_expression::shape::ternary;
+    e.op = sm[3].str()[0];
+    e.op2 = sm[6].str()[0];
+    set_operands( sm, {{1, 2}, {4, 5}, {7, 8}} );
+  }
+  else if ( std::regex_match( s, sm, verilog_regex::maj3_expression ) )
+  {
+    e.kind = verilog_expression::shape::maj3;
+    set_operands( sm, {{1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}} );
+  }
+  return e.kind != verilog_expression::shape::none;
+}
+
+} // namespace detail
+
+} // namespace lorina
+
+/*! \endcond */
@@ -37,10 +37,14 @@
 #include "common.hpp"
 #include "diagnostics.hpp"
 #include "detail/utils.hpp"
+#include "detail/compressed_file.hpp"
+#include "detail/mapped_file.hpp"
 #include "detail/tokenizer.hpp"
+#include "detail/verilog_expression.hpp"
 #include "verilog_regex.hpp"
 #include <iostream>
 #include <queue>
+#include <string_view>
 
 namespace lorina
 {
@@ -113,6 +117,19 @@ public:
    * \param rhs Right-hand side of assignment
    */
   virtual void on_assign( const std::string& lhs, const std::pair<std::string, bool>& rhs ) const
+  {
+    on_assign( std::string_view( lhs ), std::pair<std::string_view, bool>( rhs.first, rhs.second ) );
+  }
+
+  /*! \brief Callback method for parsed immediate assignment of form `LHS = RHS ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param rhs Right-hand side of assignment
+   */
+  virtual void on_assign( std::string_view lhs, std::pair<std::string_view, bool> const& rhs ) const
   {
     (void)lhs;
     (void)rhs;
@@ -143,6 +160,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_and( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_and( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed AND-gate with 2 operands `LHS = OP1 & OP2 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_and( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -156,6 +187,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_nand( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_nand( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed NAND-gate with 2 operands `LHS = ~(OP1 & OP2) ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_nand( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -169,6 +214,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_or( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_or( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed OR-gate with 2 operands `LHS = OP1 | OP2 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_or( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -182,6 +241,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_nor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_nor( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed NOR-gate with 2 operands `LHS = ~(OP1 | OP2) ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_nor( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -195,6 +268,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_xor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_xor( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed XOR-gate with 2 operands `LHS = OP1 ^ OP2 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_xor( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -208,6 +295,20 @@ public:
    * \param op2 operand2 of assignment
    */
   virtual void on_xnor( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const
+  {
+    on_xnor( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ) );
+  }
+
+  /*! \brief Callback method for parsed XOR-gate with 2 operands `LHS = ~(OP1 ^ OP2) ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   */
+  virtual void on_xnor( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const
   {
     (void)lhs;
     (void)op1;
@@ -222,6 +323,21 @@ public:
    * \param op3 operand3 of assignment
    */
   virtual void on_and3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const
+  {
+    on_and3( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ), std::pair<std::string_view, bool>( op3.first, op3.second ) );
+  }
+
+  /*! \brief Callback method for parsed AND-gate with 3 operands `LHS = OP1 & OP2 & OP3 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   * \param op3 operand3 of assignment
+   */
+  virtual void on_and3( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2, std::pair<std::string_view, bool> const& op3 ) const
   {
     (void)lhs;
     (void)op1;
@@ -237,6 +353,21 @@ public:
    * \param op3 operand3 of assignment
    */
   virtual void on_or3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const
+  {
+    on_or3( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ), std::pair<std::string_view, bool>( op3.first, op3.second ) );
+  }
+
+  /*! \brief Callback method for parsed OR-gate with 3 operands `LHS = OP1 | OP2 | OP3 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   * \param op3 operand3 of assignment
+   */
+  virtual void on_or3( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2, std::pair<std::string_view, bool> const& op3 ) const
   {
     (void)lhs;
     (void)op1;
@@ -252,6 +383,21 @@ public:
    * \param op3 operand3 of assignment
    */
   virtual void on_xor3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const
+  {
+    on_xor3( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ), std::pair<std::string_view, bool>( op3.first, op3.second ) );
+  }
+
+  /*! \brief Callback method for parsed XOR-gate with 3 operands `LHS = OP1 ^ OP2 ^ OP3 ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   * \param op3 operand3 of assignment
+   */
+  virtual void on_xor3( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2, std::pair<std::string_view, bool> const& op3 ) const
   {
     (void)lhs;
     (void)op1;
@@ -267,6 +413,21 @@ public:
    * \param op3 operand3 of assignment
    */
   virtual void on_maj3( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2, const std::pair<std::string, bool>& op3 ) const
+  {
+    on_maj3( std::string_view( lhs ), std::pair<std::string_view, bool>( op1.first, op1.second ), std::pair<std::string_view, bool>( op2.first, op2.second ), std::pair<std::string_view, bool>( op3.first, op3.second ) );
+  }
+
+  /*! \brief Callback method for parsed majority-of-3 gate `LHS = ( OP1 & OP2 ) | ( OP1 & OP3 ) | ( OP2 & OP3 ) ;`.
+   *
+   * `std::string_view` overload, invoked by the default implementation
+   * of the `std::string` overload; override either one.
+   *
+   * \param lhs Left-hand side of assignment
+   * \param op1 operand1 of assignment
+   * \param op2 operand2 of assignment
+   * \param op3 operand3 of assignment
+   */
+  virtual void on_maj3( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2, std::pair<std::string_view, bool> const& op3 ) const
   {
     (void)lhs;
     (void)op1;
@@ -287,6 +448,24 @@ public:
    *
    */
   virtual void on_endmodule() const {}
+
+  /*! \brief Query for the ports of instantiated modules.
+   *
+   * Invoked for every port of a parsed module instantiation, after
+   * `on_module_instantiation`.  A signal connected to an output port is
+   * defined by the instantiation, so the statements that depend on it
+   * are no longer deferred.
+   *
+   * \param module_name Name of the instantiated module
+   * \param port Name of the port in `module_name`
+   * \return True if `port` is an output of `module_name`
+   */
+  virtual bool is_instance_output( std::string const& module_name, std::string const& port ) const
+  {
+    (void)module_name;
+    (void)port;
+    return false;
+  }
 }; /* verilog_reader */
 
 /*! \brief A VERILOG reader for prettyprinting a simplistic VERILOG format.
@@ -711,17 +890,21 @@ protected:
  *
  * Simplistic grammar-oriented parser for a structural VERILOG format.
  *
+ * The tokenizer reads from a stream (`detail::tokenizer`) or from an
+ * in-memory buffer such as a memory-mapped file (`detail::buffer_tokenizer`).
+ *
  */
+template<typename Tokenizer = detail::tokenizer>
 class verilog_parser
 {
 public:
   /*! \brief Construct a VERILOG parser
    *
-   * \param in Input stream
+   * \param in Input stream (or buffer for `detail::buffer_tokenizer`)
    * \param reader A verilog reader
    * \param diag A diagnostic engine
    */
-  verilog_parser( std::istream& in, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
+  verilog_parser( typename Tokenizer::input_type in, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
     : tok( in )
     , reader( reader )
     , diag( diag )
@@ -1246,10 +1429,10 @@ public:
       } while ( valid && token == "," );
 
       if ( !valid || token != ")" ) return false;
-    }
 
-    valid = get_token( token );
-    if ( !valid ) return false;
+      valid = get_token( token );
+      if ( !valid ) return false;
+    }
 
     std::string const inst_name = token; // name of instantiation
 
@@ -1287,6 +1470,14 @@ public:
     /* callback */
     reader.on_module_instantiation( module_name, params, inst_name, args );
 
+    for ( auto const& arg : args )
+    {
+      if ( reader.is_instance_output( module_name, arg.first ) )
+      {
+        on_action.define( arg.second );
+      }
+    }
+
     return true;
   }
 
@@ -1302,109 +1493,122 @@ public:
       s.append( token );
     } while ( token != ";" && token != "assign" && token != "endmodule" );
 
-    std::smatch sm;
-    if ( std::regex_match( s, sm, verilog_regex::immediate_assign ) )
+    /* hand-written matcher first, the regular expressions for anything it does not recognize */
+    detail::verilog_expression e;
+    if ( !matcher.match( s, e ) && !detail::match_verilog_expression_regex( s, e ) )
     {
-      assert( sm.size() == 3u );
-      on_action.call_deferred( { sm[2] }, lhs, {{sm[2], sm[1] == "~"}}, lhs, "assign" );
+      return false;
     }
-    else if ( std::regex_match( s, sm, verilog_regex::binary_expression ) )
-    {
-      assert( sm.size() == 6u );
-      std::pair<std::string,bool> arg0 = {sm[2], sm[1] == "~"};
-      std::pair<std::string,bool> arg1 = {sm[5], sm[4] == "~"};
-      auto op = sm[3];
 
-      if ( op == "&" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "and2" );
-      }
-      else if ( op == "|" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "or2" );
-      }
-      else if ( op == "^" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "xor2" );
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else if ( std::regex_match( s, sm, verilog_regex::negated_binary_expression ) )
-    {
-      assert( sm.size() == 6u );
-      std::pair<std::string,bool> arg0 = {sm[2], sm[1] == "~"};
-      std::pair<std::string,bool> arg1 = {sm[5], sm[4] == "~"};
-      auto op = sm[3];
-      if ( op == "&" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "nand2" );
-      }
-      else if ( op == "|" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "nor2" );
-      }
-      else if ( op == "^" )
-      {
-        on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "xnor2" );
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else if ( std::regex_match( s, sm, verilog_regex::ternary_expression ) )
+    auto const arg = [&]( uint32_t i ){
+      return std::pair<std::string,bool>( std::string( e.operands[i].first ), e.operands[i].second );
+    };
+
+    switch ( e.kind )
     {
-      assert( sm.size() == 9u );
-      std::pair<std::string,bool> arg0 = {sm[2], sm[1] == "~"};
-      std::pair<std::string,bool> arg1 = {sm[5], sm[4] == "~"};
-      std::pair<std::string,bool> arg2 = {sm[8], sm[7] == "~"};
-      auto op = sm[3];
-      if ( sm[6] != op )
+    case detail::verilog_expression::shape::immediate:
       {
-        return false;
+        auto const arg0 = arg( 0u );
+        on_action.call_deferred( { arg0.first }, lhs, {arg0}, lhs, "assign" );
       }
+      break;
 
-      if ( op == "&" )
+    case detail::verilog_expression::shape::binary:
       {
-        on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "and3" );
+        std::pair<std::string,bool> arg0 = arg( 0u );
+        std::pair<std::string,bool> arg1 = arg( 1u );
+        if ( e.op == '&' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "and2" );
+        }
+        else if ( e.op == '|' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "or2" );
+        }
+        else if ( e.op == '^' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "xor2" );
+        }
+        else
+        {
+          return false;
+        }
       }
-      else if ( op == "|" )
+      break;
+
+    case detail::verilog_expression::shape::negated_binary:
       {
-        on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "or3" );
+        std::pair<std::string,bool> arg0 = arg( 0u );
+        std::pair<std::string,bool> arg1 = arg( 1u );
+        if ( e.op == '&' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "nand2" );
+        }
+        else if ( e.op == '|' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "nor2" );
+        }
+        else if ( e.op == '^' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first }, lhs, {arg0, arg1}, lhs, "xnor2" );
+        }
+        else
+        {
+          return false;
+        }
       }
-      else if ( op == "^" )
+      break;
+
+    case detail::verilog_expression::shape::ternary:
       {
-        on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "xor3" );
+        std::pair<std::string,bool> arg0 = arg( 0u );
+        std::pair<std::string,bool> arg1 = arg( 1u );
+        std::pair<std::string,bool> arg2 = arg( 2u );
+        if ( e.op2 != e.op )
+        {
+          return false;
+        }
+
+        if ( e.op == '&' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "and3" );
+        }
+        else if ( e.op == '|' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "or3" );
+        }
+        else if ( e.op == '^' )
+        {
+          on_action.call_deferred( { arg0.first, arg1.first, arg2.first }, lhs, {arg0, arg1, arg2}, lhs, "xor3" );
+        }
+        else
+        {
+          return false;
+        }
       }
-      else
+      break;
+
+    case detail::verilog_expression::shape::maj3:
       {
-        return false;
+        std::pair<std::string,bool> a0 = arg( 0u );
+        std::pair<std::string,bool> b0 = arg( 1u );
+        std::pair<std::string,bool> a1 = arg( 2u );
+        std::pair<std::string,bool> c0 = arg( 3u );
+        std::pair<std::string,bool> b1 = arg( 4u );
+        std::pair<std::string,bool> c1 = arg( 5u );
+
+        if ( a0 != a1 || b0 != b1 || c0 != c1 ) return false;
+
+        std::vector<std::pair<std::string,bool>> args;
+        args.push_back( a0 );
+        args.push_back( b0 );
+        args.push_back( c0 );
+
+        on_action.call_deferred( { a0.first, b0.first, c0.first }, lhs, args, lhs, "maj3" );
       }
-    }
-    else if ( std::regex_match( s, sm, verilog_regex::maj3_expression ) )
-    {
-      assert( sm.size() == 13u );
-      std::pair<std::string,bool> a0 = {sm[2],  sm[1]  == "~"};
-      std::pair<std::string,bool> b0 = {sm[4],  sm[3]  == "~"};
-      std::pair<std::string,bool> a1 = {sm[6],  sm[5]  == "~"};
-      std::pair<std::string,bool> c0 = {sm[8],  sm[7]  == "~"};
-      std::pair<std::string,bool> b1 = {sm[10], sm[9]  == "~"};
-      std::pair<std::string,bool> c1 = {sm[12], sm[11] == "~"};
-
-      if ( a0 != a1 || b0 != b1 || c0 != c1 ) return false;
-
-      std::vector<std::pair<std::string,bool>> args;
-      args.push_back( a0 );
-      args.push_back( b0 );
-      args.push_back( c0 );
-
-      on_action.call_deferred( { a0.first, b0.first, c0.first }, lhs, args, lhs, "maj3" );
-    }
-    else
-    {
+      break;
+
+    default:
       return false;
     }
 
@@ -1412,7 +1616,8 @@ public:
   }
 
 private:
-  detail::tokenizer tok;
+  Tokenizer tok;
+  detail::verilog_expression_matcher matcher;
   const verilog_reader& reader;
   diagnostic_engine* diag;
 
@@ -1421,9 +1626,95 @@ private:
 
   bool valid = false;
 
-  detail::call_in_topological_order<std::vector<std::pair<std::string,bool>>, std::string, std::string> on_action;
+  detail::topological_resolver<std::vector<std::pair<std::string,bool>>, std::string, std::string> on_action;
 }; /* verilog_parser */
 
+/*! \brief Location and outputs of a module in a VERILOG buffer. */
+struct verilog_module_info
+{
+  std::string_view name;                 /*!< Name of the module */
+  std::string_view text;                 /*!< From `module` up to and including `endmodule` */
+  std::vector<std::string_view> outputs; /*!< Names of the output ports */
+}; /* verilog_module_info */
+
+/*! \brief Finds the modules of a VERILOG buffer.
+ *
+ * A single pass over the tokens of `buffer` that skips comments and
+ * only looks at `module`, `output`, and `endmodule`; statements are not
+ * parsed.  Each `text` can be passed to `read_verilog_buffer` on its
+ * own.  All views point into `buffer`.
+ *
+ * \param buffer Contents of a VERILOG file
+ * \return The complete modules in the order of the buffer
+ */
+inline std::vector<verilog_module_info> scan_verilog_modules( std::string_view buffer )
+{
+  detail::buffer_tokenizer tok( buffer );
+  std::string_view token;
+
+  /* next non-empty token outside of comments */
+  auto const next = [&](){
+    while ( true )
+    {
+      auto const result = tok.get_token_internal( token );
+      if ( result == detail::tokenizer_return_code::invalid )
+      {
+        return false;
+      }
+      if ( token == "//" && result == detail::tokenizer_return_code::valid )
+      {
+        tok.set_comment_mode();
+        tok.get_token_internal( token ); /* the comment */
+        continue;
+      }
+      if ( !token.empty() )
+      {
+        return true;
+      }
+    }
+  };
+
+  std::vector<verilog_module_info> modules;
+  verilog_module_info current;
+  char const* begin = nullptr;
+  while ( next() )
+  {
+    if ( token == "module" )
+    {
+      begin = token.data();
+      current = verilog_module_info();
+      if ( !next() )
+      {
+        break;
+      }
+      current.name = token;
+    }
+    else if ( token == "output" && begin != nullptr )
+    {
+      /* output [msb:lsb] a, b, c; */
+      bool in_range = false;
+      while ( next() && token != ";" )
+      {
+        if ( token == "[" || token == "]" )
+        {
+          in_range = ( token == "[" );
+        }
+        else if ( !in_range && token != "," )
+        {
+          current.outputs.emplace_back( token );
+        }
+      }
+    }
+    else if ( token == "endmodule" && begin != nullptr )
+    {
+      current.text = std::string_view( begin, token.data() + token.size() - begin );
+      modules.emplace_back( std::move( current ) );
+      begin = nullptr;
+    }
+  }
+  return modules;
+}
+
 /*! \brief Reader function for VERILOG format.
  *
  * Reads a simplistic VERILOG format from a stream and invokes a callback
@@ -1436,7 +1727,32 @@ private:
  */
 [[nodiscard]] inline return_code read_verilog( std::istream& in, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
 {
-  verilog_parser parser( in, reader, diag );
+  verilog_parser<> parser( in, reader, diag );
+  auto result = parser.parse_module();
+  if ( !result )
+  {
+    return return_code::parse_error;
+  }
+  else
+  {
+    return return_code::success;
+  }
+}
+
+/*! \brief Reader function for VERILOG format.
+ *
+ * Reads a simplistic VERILOG format from a buffer in memory and invokes
+ * a callback method for each parsed primitive and each detected parse
+ * error.  Tokens are views into `buffer`.
+ *
+ * \param buffer Contents of a VERILOG file
+ * \param reader A VERILOG reader with callback methods invoked for parsed primitives
+ * \param diag An optional diagnostic engine with callback methods for parse errors
+ * \return Success if parsing has been successful, or parse error if parsing has failed
+ */
+[[nodiscard]] inline return_code read_verilog_buffer( std::string_view buffer, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
+{
+  verilog_parser<detail::buffer_tokenizer> parser( buffer, reader, diag );
   auto result = parser.parse_module();
   if ( !result )
   {
@@ -1448,11 +1764,42 @@ private:
   }
 }
 
+/*! \brief Reader function for VERILOG format.
+ *
+ * Reads a simplistic VERILOG format chunk by chunk from `source` (e.g.,
+ * a decompressor) and invokes a callback method for each parsed
+ * primitive and each detected parse error.
+ *
+ * \param source Source of the consecutive chunks of a VERILOG file
+ * \param reader A VERILOG reader with callback methods invoked for parsed primitives
+ * \param diag An optional diagnostic engine with callback methods for parse errors
+ * \return Success if parsing has been successful, or parse error if parsing has failed
+ */
+[[nodiscard]] inline return_code read_verilog_chunks( detail::chunk_source& source, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
+{
+  verilog_parser<detail::chunked_tokenizer> parser( source, reader, diag );
+  auto result = parser.parse_module();
+  if ( !result || !source.good() )
+  {
+    return return_code::parse_error;
+  }
+  else
+  {
+    return return_code::success;
+  }
+}
+
 /*! \brief Reader function for VERILOG format.
  *
  * Reads a simplistic VERILOG format from a file and invokes a callback
  * method for each parsed primitive and each detected parse error.
  *
+ * Regular files are memory-mapped and tokenized in place; other files
+ * (e.g., pipes) are read as a stream.  Files ending in `.gz` or `.zst`
+ * are decompressed on a separate thread in chunks of 1 MB, which are
+ * tokenized as they arrive (see `read_verilog_chunks`), so the
+ * decompressed netlist is never stored as a whole.
+ *
  * \param filename Name of the file
  * \param reader A VERILOG reader with callback methods invoked for parsed primitives
  * \param diag An optional diagnostic engine with callback methods for parse errors
@@ -1460,7 +1807,37 @@ private:
  */
 [[nodiscard]] inline return_code read_verilog( const std::string& filename, const verilog_reader& reader, diagnostic_engine* diag = nullptr )
 {
-  std::ifstream in( detail::word_exp_filename( filename ), std::ifstream::in );
+  auto const path = detail::word_exp_filename( filename );
+  if ( detail::is_compressed_filename( path ) )
+  {
+    auto source = detail::open_compressed( path );
+    if ( !source )
+    {
+      if ( diag )
+      {
+        diag->report( diagnostic_level::fatal,
+                      fmt::format( "could not open file `{0}`", filename ) );
+      }
+      return return_code::parse_error;
+    }
+    auto const ret = read_verilog_chunks( *source, reader, diag );
+    if ( !source->good() && diag )
+    {
+      diag->report( diagnostic_level::fatal,
+                    fmt::format( "could not decompress file `{0}`", filename ) );
+    }
+    return ret;
+  }
+
+  {
+    detail::mapped_file file( path );
+    if ( file.is_open() )
+    {
+      return read_verilog_buffer( file.view(), reader, diag );
+    }
+  }
+
+  std::ifstream in( path, std::ifstream::in );
   if ( !in.is_open() )
   {
     if ( diag )
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "foreach.hpp"
+#include "hot_path_counters.hpp"
+#include "segmented_vector.hpp"
 #include <parallel_hashmap/phmap.h>
 
 #include <array>
 #include <atomic>
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace aig
@@ -102,62 +109,524 @@ struct signal
   };
 }; /* signal */
 
-class storage
+using fanin_array = std::array<signal, 2u>;
+
+/* packed fanins of an AND gate, used to look up a node before it exists */
+struct fanin_key
+{
+  fanin_key( signal a, signal b )
+    : value( ( static_cast<uint64_t>( a.data ) << 32u ) | b.data )
+  {}
+
+  explicit fanin_key( fanin_array const& fanins )
+    : fanin_key( fanins[0], fanins[1] )
+  {}
+
+  bool operator==( fanin_key const& other ) const
+  {
+    return value == other.value;
+  }
+
+  uint64_t value;
+}; /* fanin_key */
+
+/* Hashes node indices through their fanins.
+ *
+ * Both functors resolve an index via `Storage::node_fanins` and accept
+ * a `fanin_key` directly (heterogeneous lookup), so the table only has
+ * to store 4-byte indices.
+ */
+template<typename Storage>
+struct strash_hash
+{
+  using is_transparent = void;
+
+  /* finalizer of MurmurHash3: every input bit affects every output bit */
+  static uint64_t mix( uint64_t k )
+  {
+    k ^= k >> 33u;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33u;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33u;
+    return k;
+  }
+
+  uint64_t operator()( fanin_key const& k ) const
+  {
+    return mix( k.value );
+  }
+
+  uint64_t operator()( uint32_t index ) const
+  {
+    return mix( fanin_key( s->node_fanins( index ) ).value );
+  }
+
+  Storage const* s;
+}; /* strash_hash */
+
+template<typename Storage>
+struct strash_eq
+{
+  using is_transparent = void;
+
+  bool operator()( uint32_t a, uint32_t b ) const
+  {
+    return a == b;
+  }
+
+  bool operator()( uint32_t index, fanin_key const& k ) const
+  {
+    return fanin_key( s->node_fanins( index ) ) == k;
+  }
+
+  bool operator()( fanin_key const& k, uint32_t index ) const
+  {
+    return fanin_key( s->node_fanins( index ) ) == k;
+  }
+
+  Storage const* s;
+}; /* strash_eq */
+
+/* The functors of a strash table are bound to the storage owning the
+ * table, so swapping two tables (which phmap also does internally,
+ * e.g., when loading a dumped table) must not exchange them.
+ */
+template<typename Storage>
+inline void swap( strash_hash<Storage>&, strash_hash<Storage>& ) noexcept
+{
+}
+
+template<typename Storage>
+inline void swap( strash_eq<Storage>&, strash_eq<Storage>& ) noexcept
+{
+}
+
+/* Current traversal epoch of every thread id.
+ *
+ * A mark is the token `( epoch << 8 ) | thread_id` of its owner; it is
+ * only valid while the owner is still in that epoch.  Incrementing an
+ * epoch therefore releases all marks of a thread at once.  Thread ids
+ * are 1..255 (0 is the unmarked value), and raw thread ids are the
+ * tokens of epoch 0.  Epochs wrap around after 2^24 increments, at
+ * which point very old marks of the same thread would become valid
+ * again; `advance` therefore clears the marks of the thread before it
+ * wraps around.  Thread ids out of range are rejected with
+ * `std::out_of_range`, since they would alias the marks of another
+ * thread.
+ */
+class epoch_table
+{
+public:
+  static constexpr uint32_t thread_id_bits = 8u;
+  static constexpr uint32_t max_threads = 1u << thread_id_bits;
+  static constexpr uint32_t thread_id_mask = max_threads - 1u;
+  static constexpr uint32_t epoch_mask = ~uint32_t( 0 ) >> thread_id_bits;
+
+  epoch_table() = default;
+
+  epoch_table( epoch_table const& other )
+  {
+    *this = other;
+  }
+
+  epoch_table& operator=( epoch_table const& other )
+  {
+    for ( uint32_t i = 0; i < max_threads; ++i )
+    {
+      epochs[i].store( other.epochs[i].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    }
+    return *this;
+  }
+
+  uint32_t token( uint32_t thread_id ) const
+  {
+    check_thread_id( thread_id );
+    return current_token( thread_id );
+  }
+
+  /* Starts a new epoch for `thread_id` and returns its token.  Before
+   * the epochs of the thread wrap around, `clear_marks( thread_id )`
+   * must reset every mark of the thread to 0 (see `clear_thread_marks`).
+   */
+  template<typename ClearMarks>
+  uint32_t advance( uint32_t thread_id, ClearMarks&& clear_marks )
+  {
+    check_thread_id( thread_id );
+    if ( ( ( epochs[thread_id].load( std::memory_order_relaxed ) + 1u ) & epoch_mask ) == 0u )
+    {
+      clear_marks( thread_id );
+    }
+    uint32_t const epoch = epochs[thread_id].fetch_add( 1u, std::memory_order_acq_rel ) + 1u;
+    return ( epoch << thread_id_bits ) | thread_id;
+  }
+
+  /* true if no thread holds the mark `value` */
+  bool is_stale( uint32_t value ) const
+  {
+    return value == 0u || value != current_token( value & thread_id_mask );
+  }
+
+  static void check_thread_id( uint32_t thread_id )
+  {
+    if ( thread_id == 0u || thread_id >= max_threads )
+    {
+      throw std::out_of_range( "traversal thread ids are 1..255" );
+    }
+  }
+
+private:
+  uint32_t current_token( uint32_t thread_id ) const
+  {
+    return ( epochs[thread_id].load( std::memory_order_acquire ) << thread_id_bits ) | thread_id;
+  }
+
+private:
+  std::array<std::atomic<uint32_t>, max_threads> epochs{};
+}; /* epoch_table */
+
+/* Resets the marks `mark( n )` of `thread_id` among the first `num_nodes` nodes to 0, leaving those of other threads */
+template<typename Mark>
+void clear_thread_marks( uint64_t num_nodes, uint32_t thread_id, Mark&& mark )
+{
+  for ( uint64_t n = 0; n < num_nodes; ++n )
+  {
+    auto&& m = mark( n );
+    uint32_t current = m.load( std::memory_order_relaxed );
+    while ( ( current & epoch_table::thread_id_mask ) == thread_id && !m.compare_exchange_weak( current, 0u, std::memory_order_relaxed ) )
+    {
+    }
+  }
+}
+
+/* Node storage with one 16-byte record per node (array of structs).
+ *
+ * Every storage layout provides the same accessors (`num_nodes`,
+ * `node_fanins`, `set_node_fanins`, `node_mark`, `node_ref_count`,
+ * `add_node`, and the slot functions used by `concurrent_network`) and
+ * the list of free slots (`free_nodes`), which is all `basic_network`
+ * relies on.
+ *
+ * The node pages and the strash table are allocated by (a rebound)
+ * `Allocator`, which has to be stateless, e.g., a `huge_page_allocator`
+ * for large networks; `storage` uses `std::allocator`.
+ */
+template<typename Allocator = std::allocator<uint32_t>>
+class basic_storage
 {
 public:
   struct node_type
   {
-    std::array<signal, 2u> fanins;    // 8 bytes
+    fanin_array fanins;               // 8 bytes
     atomic_wrapper<uint32_t> value{}; // 4 bytes
     uint32_t ref_count{};             // 4 bytes
   }; /* node_type (16 bytes) */
 
-  storage()
+  using allocator_type = Allocator;
+  using strash_table = phmap::flat_hash_set<uint32_t, strash_hash<basic_storage>, strash_eq<basic_storage>, typename std::allocator_traits<Allocator>::template rebind_alloc<uint32_t>>;
+
+  basic_storage()
+    : hash( 0u, strash_hash<basic_storage>{this}, strash_eq<basic_storage>{this} )
   {
     /* constant 0 node */
     nodes.emplace_back();
   }
 
-  struct aig_node_eq
+  /* the functors of `hash` point to their storage, so copies rebuild the table */
+  basic_storage( basic_storage const& other )
+    : nodes( other.nodes )
+    , inputs( other.inputs )
+    , outputs( other.outputs )
+    , hash( other.hash.begin(), other.hash.end(), other.hash.size(), strash_hash<basic_storage>{this}, strash_eq<basic_storage>{this} )
+    , free_nodes( other.free_nodes )
+    , epochs( other.epochs )
+    , memory_budget( other.memory_budget )
+  {}
+
+  basic_storage& operator=( basic_storage const& other )
   {
-    bool operator()( node_type const& a, node_type const& b ) const
+    if ( this != &other )
     {
-      return a.fanins == b.fanins;
+      nodes = other.nodes;
+      inputs = other.inputs;
+      outputs = other.outputs;
+      hash = strash_table( other.hash.begin(), other.hash.end(), other.hash.size(), strash_hash<basic_storage>{this}, strash_eq<basic_storage>{this} );
+      free_nodes = other.free_nodes;
+      epochs = other.epochs;
+      memory_budget = other.memory_budget;
     }
-  };
+    return *this;
+  }
 
-  struct aig_node_hash
+  /* moving `hash` keeps its functors bound to `this` (see `swap` of `strash_hash`) */
+  basic_storage& operator=( basic_storage&& other ) noexcept
   {
-    uint64_t operator()( node_type const& n ) const
+    if ( this != &other )
     {
-      uint64_t seed = -2011;
-      seed += n.fanins[0].index * 7939;
-      seed += n.fanins[1].index * 2971;
-      seed += n.fanins[0].complement * 911;
-      seed += n.fanins[1].complement * 353;
-      return seed;
+      nodes = std::move( other.nodes );
+      inputs = std::move( other.inputs );
+      outputs = std::move( other.outputs );
+      hash = std::move( other.hash );
+      free_nodes = std::move( other.free_nodes );
+      epochs = other.epochs;
+      memory_budget = other.memory_budget;
     }
-  };
+    return *this;
+  }
+
+  uint64_t num_nodes() const
+  {
+    return nodes.size();
+  }
+
+  /* allocated bytes of a strash table with `capacity` slots (plus the control bytes of phmap) */
+  static uint64_t strash_table_bytes( uint64_t capacity )
+  {
+    return capacity == 0u ? 0u : capacity * ( sizeof( uint32_t ) + 1u ) + 17u;
+  }
+
+  /* allocated bytes of the node pages, their directories, and the strash table */
+  uint64_t reserved_bytes() const
+  {
+    return nodes.capacity() * sizeof( node_type ) + nodes.directory_bytes() + strash_table_bytes( hash.capacity() );
+  }
+
+  /* Bytes that one more gate may allocate: a node page if no slot is
+   * left (with a larger page directory if the page does not fit, since
+   * the old directory is kept), and the grown strash table, which
+   * coexists with the old one while it is rehashed (deleted slots,
+   * which may defer growing, are ignored).
+   */
+  uint64_t growth_bytes() const
+  {
+    uint64_t bytes{0};
+    if ( free_nodes.empty() && nodes.size() == nodes.capacity() )
+    {
+      bytes += decltype( nodes )::page_size * sizeof( node_type ) + nodes.directory_growth_bytes();
+    }
+    if ( hash.capacity() == 0u || hash.size() + 1u > phmap::priv::CapacityToGrowth( hash.capacity() ) )
+    {
+      bytes += strash_table_bytes( 2u * hash.capacity() + 1u );
+    }
+    return bytes;
+  }
+
+  fanin_array const& node_fanins( uint32_t n ) const
+  {
+    return nodes[n].fanins;
+  }
+
+  void set_node_fanins( uint32_t n, fanin_array const& fanins )
+  {
+    nodes[n].fanins = fanins;
+  }
+
+  std::atomic<uint32_t>& node_mark( uint32_t n )
+  {
+    return nodes[n].value.data;
+  }
+
+  uint32_t& node_ref_count( uint32_t n )
+  {
+    return nodes[n].ref_count;
+  }
+
+  uint32_t add_node( fanin_array const& fanins = {} )
+  {
+    uint32_t const index = static_cast<uint32_t>( nodes.size() );
+    node_type node;
+    node.fanins = fanins;
+    nodes.push_back( node );
+    return index;
+  }
+
+  void reserve( uint64_t n )
+  {
+    nodes.reserve( n );
+  }
+
+  /* thread-safe: (re)initializes slot `index` beyond `num_nodes()` */
+  void init_slot( uint32_t index, fanin_array const& fanins = {} )
+  {
+    auto& node = nodes.slot( index );
+    node = node_type();
+    node.fanins = fanins;
+  }
+
+  /* turns the slots below `n` into nodes; not thread-safe */
+  void adopt_slots( uint64_t n )
+  {
+    nodes.adopt( n );
+  }
+
+  segmented_vector<node_type, 10u, ( 1ull << 31u ), typename std::allocator_traits<Allocator>::template rebind_alloc<node_type>> nodes; /* address-stable, see `segmented_vector` */
+  std::vector<uint32_t> inputs;
+  std::vector<signal> outputs;
+  strash_table hash; /* indices of all AND gates */
+  std::vector<uint32_t> free_nodes; /* slots of dead nodes, reused last in first out */
+  epoch_table epochs;
+  uint64_t memory_budget{0}; /* limit of `reserved_bytes` for `try_create_and`, 0 for none */
+}; /* basic_storage */
+
+using storage = basic_storage<>;
+
+/* Node storage with one contiguous array per field (struct of arrays).
+ *
+ * Scans over fanins or marks only touch the array they need, and all
+ * arrays hold trivially copyable elements; marks are updated through
+ * `std::atomic_ref`.
+ */
+class soa_storage
+{
+public:
+  using strash_table = phmap::flat_hash_set<uint32_t, strash_hash<soa_storage>, strash_eq<soa_storage>>;
+
+  soa_storage()
+    : hash( 0u, strash_hash<soa_storage>{this}, strash_eq<soa_storage>{this} )
+  {
+    /* constant 0 node */
+    add_node();
+  }
+
+  soa_storage( soa_storage const& other )
+    : fanins( other.fanins )
+    , marks( other.marks )
+    , ref_counts( other.ref_counts )
+    , inputs( other.inputs )
+    , outputs( other.outputs )
+    , hash( other.hash.begin(), other.hash.end(), other.hash.size(), strash_hash<soa_storage>{this}, strash_eq<soa_storage>{this} )
+    , free_nodes( other.free_nodes )
+    , epochs( other.epochs )
+  {}
+
+  soa_storage& operator=( soa_storage const& other )
+  {
+    if ( this != &other )
+    {
+      fanins = other.fanins;
+      marks = other.marks;
+      ref_counts = other.ref_counts;
+      inputs = other.inputs;
+      outputs = other.outputs;
+      hash = strash_table( other.hash.begin(), other.hash.end(), other.hash.size(), strash_hash<soa_storage>{this}, strash_eq<soa_storage>{this} );
+      free_nodes = other.free_nodes;
+      epochs = other.epochs;
+    }
+    return *this;
+  }
+
+  soa_storage& operator=( soa_storage&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      fanins = std::move( other.fanins );
+      marks = std::move( other.marks );
+      ref_counts = std::move( other.ref_counts );
+      inputs = std::move( other.inputs );
+      outputs = std::move( other.outputs );
+      hash = std::move( other.hash );
+      free_nodes = std::move( other.free_nodes );
+      epochs = other.epochs;
+    }
+    return *this;
+  }
+
+  uint64_t num_nodes() const
+  {
+    return fanins.size();
+  }
+
+  fanin_array const& node_fanins( uint32_t n ) const
+  {
+    return fanins[n];
+  }
+
+  void set_node_fanins( uint32_t n, fanin_array const& node_fanins )
+  {
+    fanins[n] = node_fanins;
+  }
+
+  std::atomic_ref<uint32_t> node_mark( uint32_t n )
+  {
+    return std::atomic_ref<uint32_t>( marks[n] );
+  }
+
+  uint32_t& node_ref_count( uint32_t n )
+  {
+    return ref_counts[n];
+  }
+
+  uint32_t add_node( fanin_array const& node_fanins = {} )
+  {
+    uint32_t const index = static_cast<uint32_t>( fanins.size() );
+    marks.emplace_back( 0u );
+    ref_counts.emplace_back( 0u );
+    /* fanins last: their size is the number of nodes seen by concurrent readers */
+    fanins.emplace_back( node_fanins );
+    return index;
+  }
 
-  std::vector<node_type> nodes;
+  void reserve( uint64_t n )
+  {
+    fanins.reserve( n );
+    marks.reserve( n );
+    ref_counts.reserve( n );
+  }
+
+  void init_slot( uint32_t index, fanin_array const& node_fanins = {} )
+  {
+    marks.slot( index ) = 0u;
+    ref_counts.slot( index ) = 0u;
+    fanins.slot( index ) = node_fanins;
+  }
+
+  void adopt_slots( uint64_t n )
+  {
+    marks.adopt( n );
+    ref_counts.adopt( n );
+    fanins.adopt( n );
+  }
+
+  segmented_vector<fanin_array> fanins;
+  segmented_vector<uint32_t> marks;
+  segmented_vector<uint32_t> ref_counts;
   std::vector<uint32_t> inputs;
   std::vector<signal> outputs;
-  phmap::flat_hash_map<node_type, uint32_t, aig_node_hash, aig_node_eq> hash;
-}; /* storage */
+  strash_table hash; /* indices of all AND gates */
+  std::vector<uint32_t> free_nodes; /* slots of dead nodes, reused last in first out */
+  epoch_table epochs;
+}; /* soa_storage */
 
-class network
+/* An AIG over any node storage layout (`storage` or `soa_storage`)
+ *
+ * Nodes are created in topological order, i.e., every gate has a
+ * larger index than its fanins, until `substitute_node` of
+ * `fanout_level_view` frees some: a dead node keeps its slot, has no
+ * fanins, and is not in the strash table, and `create_and` reuses the
+ * slot for the next new gate.  Reused slots and substitutions break
+ * the index order, so after rewriting, algorithms that scan the nodes
+ * in index order (e.g., `priority_cuts`) need a `compact`ed network;
+ * the writers and `simd_simulator` follow `topological_gate_order`.
+ */
+template<typename Storage>
+class basic_network
 {
 public:
-  explicit network( storage& storage_ )
+  using storage_type = Storage;
+
+  /* `data` of both fanins of a dead node */
+  static constexpr uint32_t dead_fanin = ~uint32_t( 0 );
+
+  explicit basic_network( Storage& storage_ )
     : storage_( storage_ )
   {
   }
 
-  network( network const& other )
+  basic_network( basic_network const& other )
     : storage_( other.storage_ )
   {}
 
-  network& operator=( network const& other )
+  basic_network& operator=( basic_network const& other )
   {
     storage_ = other.storage_;
     return *this;
@@ -185,8 +654,9 @@ public:
 
   bool is_pi( node n ) const
   {
-    return storage_.nodes[n].fanins[0].data == storage_.nodes[n].fanins[1].data &&
-      storage_.nodes[n].fanins[0].data < static_cast<uint32_t>( storage_.inputs.size() );
+    auto const& fanins = storage_.node_fanins( n );
+    return fanins[0].data == fanins[1].data &&
+      fanins[0].data < static_cast<uint32_t>( storage_.inputs.size() );
   }
 
   signal get_constant( bool value ) const
@@ -196,8 +666,7 @@ public:
 
   signal create_pi()
   {
-    uint32_t const index = static_cast<uint32_t>( storage_.nodes.size() );
-    storage_.nodes.emplace_back();
+    uint32_t const index = storage_.add_node();
     storage_.inputs.emplace_back( index );
     return {index, 0};
   }
@@ -218,62 +687,115 @@ public:
     /* trivial cases */
     if ( a.index == b.index )
     {
+      AIG_COUNT( trivial_ands );
       return ( a.complement == b.complement ) ? a : get_constant( false );
     }
     else if ( a.index == 0 )
     {
+      AIG_COUNT( trivial_ands );
       return a.complement ? b : get_constant( false );
     }
 
-    storage::node_type node;
-    node.fanins[0] = a;
-    node.fanins[1] = b;
-
     /* structural hashing */
-    auto const it = storage_.hash.find( node );
+    auto const it = storage_.hash.find( fanin_key( a, b ) );
     if ( it != storage_.hash.end() )
     {
-      return {it->second, 0};
+      AIG_COUNT( strash_hits );
+      return {*it, 0};
     }
+    AIG_COUNT( strash_misses );
 
-    uint32_t const index = storage_.nodes.size();
-    if ( index >= .9 * storage_.nodes.capacity() )
+    /* reuse the slot freed last, if any; the node store grows one
+     * page at a time, nothing is relocated */
+    uint32_t index;
+    if ( !storage_.free_nodes.empty() )
     {
-      storage_.nodes.reserve( static_cast<uint64_t>( 3.1415f * index ) );
-      storage_.hash.reserve( static_cast<uint64_t>( 3.1415f * index ) );
+      index = storage_.free_nodes.back();
+      storage_.free_nodes.pop_back();
+      storage_.set_node_fanins( index, {a, b} );
+      storage_.node_ref_count( index ) = 0u;
+      storage_.node_mark( index ).store( 0u );
+      AIG_COUNT( reused_slots );
     }
-
-    storage_.nodes.push_back( node );
-    storage_.hash[node] = index;
+    else
+    {
+      index = storage_.add_node( {a, b} );
+    }
+#ifdef AIG_HOT_PATH_COUNTERS
+    auto const capacity = storage_.hash.capacity();
+    storage_.hash.insert( index );
+    AIG_COUNT_ADD( strash_rehashes, storage_.hash.capacity() != capacity ? 1u : 0u );
+#else
+    storage_.hash.insert( index );
+#endif
 
     /* increase ref-count to children */
-    storage_.nodes[a.index].ref_count++;
-    storage_.nodes[b.index].ref_count++;
+    storage_.node_ref_count( a.index )++;
+    storage_.node_ref_count( b.index )++;
 
     return {index, 0};
   }
 
+  /* Like `create_and`, but returns nullopt instead of allocating beyond
+   * the `memory_budget` of the storage: a new gate fails if the worst
+   * case of its `growth_bytes` does not fit, trivial and existing gates
+   * always succeed.  Without a budget, this is `create_and`.
+   */
+  std::optional<signal> try_create_and( signal a, signal b )
+  {
+    if ( storage_.memory_budget != 0u )
+    {
+      if ( uint64_t const growth = storage_.growth_bytes(); growth != 0u && storage_.reserved_bytes() + growth > storage_.memory_budget )
+      {
+        if ( a.index > b.index )
+        {
+          std::swap( a, b );
+        }
+        if ( a.index != b.index && a.index != 0 && storage_.hash.find( fanin_key( a, b ) ) == storage_.hash.end() )
+        {
+          return std::nullopt;
+        }
+      }
+    }
+    return create_and( a, b );
+  }
+
   void create_po( signal const& f )
   {
     /* increase ref-count to fanins */
-    storage_.nodes[f.index].ref_count++;
+    storage_.node_ref_count( f.index )++;
     storage_.outputs.emplace_back( f.index, f.complement );
   }
 
   template<typename Fn>
   void foreach_node( Fn&& fn ) const
   {
-    auto r = mockturtle::detail::range<uint32_t>( storage_.nodes.size() );
+    auto r = mockturtle::detail::range<uint32_t>( storage_.num_nodes() );
     for ( auto it = r.begin(); it != r.end(); ++it )
     {
       fn( aig::node( *it ) );
     }
   }
 
+  template<typename Fn>
+  void foreach_pi( Fn&& fn ) const
+  {
+    auto r = mockturtle::detail::range<uint32_t>( static_cast<uint32_t>( storage_.inputs.size() ) );
+    mockturtle::detail::foreach_element_transform<decltype( r.begin() ), node>(
+        r.begin(), r.end(), [this]( auto i ) { return node( storage_.inputs[i] ); }, fn );
+  }
+
+  template<typename Fn>
+  void foreach_po( Fn&& fn ) const
+  {
+    mockturtle::detail::foreach_element( storage_.outputs.begin(), storage_.outputs.end(), fn );
+  }
+
   template<typename Fn>
   void foreach_fanin( node const& n, Fn&& fn ) const
   {
-    if ( n == 0 || is_pi( n ) )
+    /* the constant, the PIs, and dead nodes have two equal fanins */
+    if ( storage_.node_fanins( n )[0].data == storage_.node_fanins( n )[1].data )
       return;
 
     static_assert( mockturtle::detail::is_callable_without_index_v<Fn, signal, bool> ||
@@ -284,59 +806,220 @@ public:
     /* we don't use foreach_element here to have better performance */
     if constexpr ( mockturtle::detail::is_callable_without_index_v<Fn, signal, bool> )
     {
-      if ( !fn( signal{storage_.nodes[n].fanins[0]} ) )
+      if ( !fn( signal{storage_.node_fanins( n )[0]} ) )
         return;
-      fn( signal{storage_.nodes[n].fanins[1]} );
+      fn( signal{storage_.node_fanins( n )[1]} );
     }
     else if constexpr ( mockturtle::detail::is_callable_with_index_v<Fn, signal, bool> )
     {
-      if ( !fn( signal{storage_.nodes[n].fanins[0]}, 0 ) )
+      if ( !fn( signal{storage_.node_fanins( n )[0]}, 0 ) )
         return;
-      fn( signal{storage_.nodes[n].fanins[1]}, 1 );
+      fn( signal{storage_.node_fanins( n )[1]}, 1 );
     }
     else if constexpr ( mockturtle::detail::is_callable_without_index_v<Fn, signal, void> )
     {
-      fn( signal{storage_.nodes[n].fanins[0]} );
-      fn( signal{storage_.nodes[n].fanins[1]} );
+      fn( signal{storage_.node_fanins( n )[0]} );
+      fn( signal{storage_.node_fanins( n )[1]} );
     }
     else if constexpr ( mockturtle::detail::is_callable_with_index_v<Fn, signal, void> )
     {
-      fn( signal{storage_.nodes[n].fanins[0]}, 0 );
-      fn( signal{storage_.nodes[n].fanins[1]}, 1 );
+      fn( signal{storage_.node_fanins( n )[0]}, 0 );
+      fn( signal{storage_.node_fanins( n )[1]}, 1 );
     }
   }
 
-  bool check_and_mark( node n, uint32_t new_value ) const
+  /* Claims `n` for `token` (see `epoch_table`): succeeds if `n` is
+   * already marked with `token` or if its mark is stale, i.e., 0 or
+   * left over from an earlier epoch of its owner.
+   */
+  bool check_and_mark( node n, uint32_t token ) const
   {
-    uint32_t current{storage_.nodes[n].value.data.load()};
-    return ( current == new_value ) ||
-      ( current == 0u && storage_.nodes[n].value.data.compare_exchange_weak( current, new_value ) );
-    // uint32_t current{0};
-    // return storage_.nodes[n].value.data.compare_exchange_weak( current, new_value );    
+    auto&& m = storage_.node_mark( n );
+    uint32_t current{m.load()};
+    while ( current != token )
+    {
+      if ( !storage_.epochs.is_stale( current ) )
+      {
+        AIG_COUNT( mark_conflicts );
+        return false;
+      }
+      if ( m.compare_exchange_strong( current, token ) )
+      {
+        return true;
+      }
+      AIG_COUNT( mark_cas_failures );
+    }
+    return true;
   }
 
   void reset_mark( node n ) const
   {
-    storage_.nodes[n].value.data.store( 0u );
+    storage_.node_mark( n ).store( 0u );
   }
 
   uint32_t mark( node n ) const
   {
-    return storage_.nodes[n].value.data.load();
+    return storage_.node_mark( n ).load();
+  }
+
+  /* token of `thread_id` (1..255) in its current epoch */
+  uint32_t traversal_token( uint32_t thread_id ) const
+  {
+    return storage_.epochs.token( thread_id );
+  }
+
+  /* releases all marks of `thread_id` in O(1) (amortized, see `epoch_table`) and returns its new token */
+  uint32_t release_marks( uint32_t thread_id ) const
+  {
+    return storage_.epochs.advance( thread_id, [this]( uint32_t id ){
+      clear_thread_marks( storage_.num_nodes(), id, [this]( uint64_t n ) -> decltype( auto ) { return storage_.node_mark( n ); } );
+    } );
+  }
+
+  /* clears all marks; must not run concurrently with any traversal */
+  void reset_marks() const
+  {
+    for ( uint64_t n = 0; n < storage_.num_nodes(); ++n )
+    {
+      storage_.node_mark( n ).store( 0u, std::memory_order_relaxed );
+    }
+  }
+
+  /* number of nodes, including the constant and the PIs */
+  uint32_t size() const
+  {
+    return static_cast<uint32_t>( storage_.num_nodes() );
+  }
+
+  uint32_t num_pis() const
+  {
+    return static_cast<uint32_t>( storage_.inputs.size() );
+  }
+
+  uint32_t num_pos() const
+  {
+    return static_cast<uint32_t>( storage_.outputs.size() );
+  }
+
+  /* number of AND gates, without the dead nodes */
+  uint32_t num_gates() const
+  {
+    return size() - num_pis() - 1u - static_cast<uint32_t>( storage_.free_nodes.size() );
   }
 
   uint32_t fanin_size( node n ) const
   {
-    return ( is_constant( n ) || is_pi( n ) ) ? 0u : 2u;
+    auto const& fanins = storage_.node_fanins( n );
+    return fanins[0].data == fanins[1].data ? 0u : 2u;
   }
 
   uint32_t fanout_size( node n ) const
   {
-    return storage_.nodes[n].ref_count;
+    return storage_.node_ref_count( n );
+  }
+
+  /* increments the reference count of `n` and returns the old value */
+  uint32_t incr_fanout_size( node n ) const
+  {
+    return storage_.node_ref_count( n )++;
+  }
+
+  /* decrements the reference count of `n` and returns the new value */
+  uint32_t decr_fanout_size( node n ) const
+  {
+    return --storage_.node_ref_count( n );
+  }
+
+  bool is_dead( node n ) const
+  {
+    return storage_.node_fanins( n )[0].data == dead_fanin;
+  }
+
+  /* Replaces the fanin `old` of the gate `n` by `s`, keeping the strash
+   * table and the reference counts up to date.  If the new fanins are
+   * trivial or those of another gate, `n` is left unchanged and the
+   * signal that `n` has to be substituted by is returned instead.
+   */
+  std::optional<signal> replace_in_node( node n, node old, signal s )
+  {
+    auto const& fanins = storage_.node_fanins( n );
+    uint32_t const i = fanins[0].index == old ? 0u : 1u;
+    assert( fanins[i].index == old );
+    signal a = s ^ static_cast<bool>( fanins[i].complement );
+    signal b = fanins[i ^ 1u];
+    if ( a.index > b.index )
+    {
+      std::swap( a, b );
+    }
+
+    if ( a.index == b.index )
+    {
+      return ( a.complement == b.complement ) ? a : get_constant( false );
+    }
+    else if ( a.index == 0 )
+    {
+      return a.complement ? b : get_constant( false );
+    }
+    if ( auto const it = storage_.hash.find( fanin_key( a, b ) ); it != storage_.hash.end() )
+    {
+      return signal( *it, 0 );
+    }
+
+    /* the table hashes `n` by its fanins: erase it before they change */
+    storage_.hash.erase( static_cast<uint32_t>( n ) );
+    storage_.set_node_fanins( n, {a, b} );
+    storage_.hash.insert( static_cast<uint32_t>( n ) );
+    storage_.node_ref_count( s.index )++;
+    storage_.node_ref_count( old )--;
+    return std::nullopt;
+  }
+
+  /* redirects the POs driven by `old` to `s` */
+  void replace_in_outputs( node old, signal s )
+  {
+    for ( auto& f : storage_.outputs )
+    {
+      if ( f.index == old )
+      {
+        f = s ^ static_cast<bool>( f.complement );
+        storage_.node_ref_count( s.index )++;
+        storage_.node_ref_count( old )--;
+      }
+    }
+  }
+
+  /* Frees the unreferenced gate `n` and the fanin cones that become
+   * unreferenced with it, and puts their slots on the free list.
+   * `fn( g )` is called for every freed gate `g` before its fanins are
+   * cleared.
+   */
+  template<typename Fn>
+  void take_out_node( node n, Fn&& fn )
+  {
+    assert( fanin_size( n ) != 0u && storage_.node_ref_count( n ) == 0u );
+    std::vector<uint32_t> stack{static_cast<uint32_t>( n )};
+    while ( !stack.empty() )
+    {
+      node const g( stack.back() );
+      stack.pop_back();
+      fn( g );
+      foreach_fanin( g, [&]( signal const& f ){
+        if ( --storage_.node_ref_count( f.index ) == 0u && fanin_size( node( f.index ) ) != 0u )
+        {
+          stack.push_back( f.index );
+        }
+      } );
+      storage_.hash.erase( static_cast<uint32_t>( g ) );
+      storage_.set_node_fanins( g, {signal( dead_fanin >> 1u, true ), signal( dead_fanin >> 1u, true )} );
+      storage_.free_nodes.push_back( g );
+    }
   }
 
 protected:
-  storage& storage_;
-}; /* network */
+  Storage& storage_;
+}; /* basic_network */
+
+using network = basic_network<storage>;
+using soa_network = basic_network<soa_storage>;
 
 } /* aig */
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "aig.hpp"
+#include "chunked_writer.hpp"
+#include "topological_order.hpp"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+namespace detail
+{
+
+/* 7-bit groups, least significant first, with the MSB as continuation flag */
+inline void append_aiger_delta( fmt::memory_buffer& buf, uint32_t delta )
+{
+  while ( delta & ~0x7fu )
+  {
+    buf.push_back( static_cast<char>( ( delta & 0x7fu ) | 0x80u ) );
+    delta >>= 7u;
+  }
+  buf.push_back( static_cast<char>( delta ) );
+}
+
+template<typename Ntk, typename WriteChunks>
+void write_aiger( Ntk const& ntk, std::ostream& os, WriteChunks&& write_chunks )
+{
+  /* AIGER variables: the PIs in order, then the live gates in topological order */
+  std::vector<uint32_t> const gates = topological_gate_order( ntk );
+  std::vector<uint32_t> vars( ntk.size(), 0u );
+  uint32_t num_vars{0};
+  ntk.foreach_pi( [&]( node n ){ vars[n] = ++num_vars; } );
+  for ( uint32_t const n : gates )
+  {
+    vars[n] = ++num_vars;
+  }
+  auto const literal = [&]( signal f ){
+    return 2u * vars[f.index] + ( f.complement ? 1u : 0u );
+  };
+
+  fmt::memory_buffer buf;
+  append( buf, "aig " );
+  append_uint( buf, num_vars );
+  buf.push_back( ' ' );
+  append_uint( buf, ntk.num_pis() );
+  append( buf, " 0 " );
+  append_uint( buf, ntk.num_pos() );
+  buf.push_back( ' ' );
+  append_uint( buf, num_vars - ntk.num_pis() );
+  buf.push_back( '\n' );
+  ntk.foreach_po( [&]( signal f ){
+    append_uint( buf, literal( f ) );
+    buf.push_back( '\n' );
+  } );
+
+  write_chunks( buf, static_cast<uint32_t>( gates.size() ), [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    for ( uint32_t g = begin; g < end; ++g )
+    {
+      uint32_t const n = gates[g];
+      std::array<uint32_t, 2u> rhs{};
+      ntk.foreach_fanin( node( n ), [&]( signal f, uint32_t i ){
+        rhs[i] = literal( f );
+      } );
+      if ( rhs[0] < rhs[1] )
+      {
+        std::swap( rhs[0], rhs[1] );
+      }
+      append_aiger_delta( b, 2u * vars[n] - rhs[0] );
+      append_aiger_delta( b, rhs[0] - rhs[1] );
+    }
+  } );
+  append( buf, "c\nwritten by aig::write_aiger\n" );
+  flush( os, buf );
+}
+
+} /* detail */
+
+/* Writes `ntk` in the binary AIGER format (`aig M I 0 O A`).
+ *
+ * The PIs become the variables `1..I` and the live gates the following
+ * ones in `topological_gate_order` (the node order unless slots were
+ * reused), so every gate is defined after its fanins and its two
+ * inputs are stored as delta-encoded literals; dead nodes are left
+ * out.  The gates are encoded chunk by chunk into large
+ * `fmt::memory_buffer`s; only the gate order and the variable map (4
+ * bytes per node each) are allocated besides them.
+ */
+template<typename Ntk>
+void write_aiger( Ntk const& ntk, std::ostream& os )
+{
+  detail::write_aiger( ntk, os, [&]( fmt::memory_buffer& buf, uint32_t num_items, auto&& fn ){
+    detail::write_chunks( os, buf, num_items, fn );
+  } );
+}
+
+/* Same as `write_aiger`, but encodes the chunks in parallel on `tm`;
+ * the output is identical.
+ */
+template<typename Ntk, typename TaskManager>
+void write_aiger( Ntk const& ntk, std::ostream& os, TaskManager& tm )
+{
+  detail::write_aiger( ntk, os, [&]( fmt::memory_buffer& buf, uint32_t num_items, auto&& fn ){
+    detail::write_chunks( os, buf, num_items, fn, tm );
+  } );
+}
+
+template<typename Ntk>
+[[nodiscard]] bool write_aiger( Ntk const& ntk, std::string const& filename )
+{
+  std::ofstream os( filename, std::ofstream::out | std::ofstream::binary );
+  if ( !os.is_open() )
+  {
+    return false;
+  }
+  write_aiger( ntk, os );
+  return os.good();
+}
+
+} /* aig */
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "foreach.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace aig
+{
+
+namespace detail
+{
+
+/* items (e.g., nodes) formatted into one buffer at a time */
+constexpr uint32_t write_chunk_items = 1u << 16u;
+
+/* a buffer is handed to the stream once it holds that many bytes */
+constexpr std::size_t write_flush_bytes = 1u << 20u;
+
+inline void append( fmt::memory_buffer& buf, std::string_view s )
+{
+  buf.append( s.data(), s.data() + s.size() );
+}
+
+inline void append_uint( fmt::memory_buffer& buf, uint64_t value )
+{
+  fmt::format_int const digits( value );
+  buf.append( digits.data(), digits.data() + digits.size() );
+}
+
+/* `prefix` followed by the decimal digits of `id`, e.g., `n42` */
+inline void append_name( fmt::memory_buffer& buf, char prefix, uint64_t id )
+{
+  buf.push_back( prefix );
+  append_uint( buf, id );
+}
+
+inline void flush( std::ostream& os, fmt::memory_buffer& buf )
+{
+  os.write( buf.data(), static_cast<std::streamsize>( buf.size() ) );
+  buf.resize( 0 );
+}
+
+/* Formats the items `[0, num_items)` with `fn( buf, begin, end )`, one
+ * chunk of `write_chunk_items` items after the other, flushing `buf`
+ * to `os` whenever it is large.
+ */
+template<typename Fn>
+void write_chunks( std::ostream& os, fmt::memory_buffer& buf, uint32_t num_items, Fn&& fn )
+{
+  for ( uint32_t begin = 0; begin < num_items; begin += std::min( write_chunk_items, num_items - begin ) )
+  {
+    fn( buf, begin, begin + std::min( write_chunk_items, num_items - begin ) );
+    if ( buf.size() >= write_flush_bytes )
+    {
+      flush( os, buf );
+    }
+  }
+}
+
+/* Same as the sequential `write_chunks`, but the chunks are formatted
+ * in parallel on `tm`, each into a buffer of its own, which are then
+ * written in order.  `fn` must only depend on the items of its chunk.
+ * At most `4 * ( num_workers() + 1 )` chunks are in flight, which
+ * bounds the memory to a few MB per worker.
+ */
+template<typename Fn, typename TaskManager>
+void write_chunks( std::ostream& os, fmt::memory_buffer& buf, uint32_t num_items, Fn&& fn, TaskManager& tm )
+{
+  flush( os, buf );
+
+  uint64_t const num_chunks = ( uint64_t( num_items ) + write_chunk_items - 1u ) / write_chunk_items;
+  uint64_t const round = std::min<uint64_t>( num_chunks, 4u * ( tm.num_workers() + 1u ) );
+  std::vector<fmt::memory_buffer> buffers( round );
+  for ( uint64_t first = 0; first < num_chunks; first += round )
+  {
+    uint64_t const count = std::min( round, num_chunks - first );
+    tm.parallel_for( mockturtle::detail::range<uint64_t>( count ), 1u, [&]( uint64_t i ){
+      uint64_t const begin = ( first + i ) * write_chunk_items;
+      uint64_t const end = std::min<uint64_t>( begin + write_chunk_items, num_items );
+      buffers[i].resize( 0 );
+      fn( buffers[i], static_cast<uint32_t>( begin ), static_cast<uint32_t>( end ) );
+    } );
+    for ( uint64_t i = 0; i < count; ++i )
+    {
+      flush( os, buffers[i] );
+    }
+  }
+}
+
+} /* detail */
+
+} /* aig */
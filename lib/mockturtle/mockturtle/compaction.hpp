@@ -0,0 +1,174 @@
+#pragma once
+
+#include "aig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+enum class compaction_order
+{
+  dfs,  /* depth-first post-order from the POs: a cone is stored contiguously */
+  level /* by level, ties in the old order: a level is stored contiguously */
+}; /* compaction_order */
+
+struct compaction_params
+{
+  compaction_order order{compaction_order::dfs};
+}; /* compaction_params */
+
+/* index of a removed node in the map returned by `compact` */
+inline constexpr uint32_t compaction_removed = ~uint32_t( 0 );
+
+namespace detail
+{
+
+/* gates of `ntk` in depth-first post-order from the POs; unreachable gates are left out */
+template<typename Ntk>
+std::vector<uint32_t> dfs_gate_order( Ntk const& ntk )
+{
+  std::vector<uint32_t> order;
+  std::vector<bool> visited( ntk.size(), false );
+  std::vector<std::pair<uint32_t, bool>> stack; /* node, fanins pushed */
+  ntk.foreach_po( [&]( signal const& f ){
+    stack.emplace_back( f.index, false );
+    while ( !stack.empty() )
+    {
+      auto [n, expanded] = stack.back();
+      if ( visited[n] || ntk.fanin_size( node( n ) ) == 0u )
+      {
+        stack.pop_back();
+        continue;
+      }
+      if ( expanded )
+      {
+        visited[n] = true;
+        order.emplace_back( n );
+        stack.pop_back();
+        continue;
+      }
+      stack.back().second = true;
+
+      /* the first fanin is visited first */
+      std::array<uint32_t, 2u> fanins{};
+      ntk.foreach_fanin( node( n ), [&]( signal const& fi, uint32_t i ){
+        fanins[i] = fi.index;
+      } );
+      stack.emplace_back( fanins[1], false );
+      stack.emplace_back( fanins[0], false );
+    }
+  } );
+  return order;
+}
+
+/* gates of `ntk` reachable from the POs, sorted by level (counting sort, stable) */
+template<typename Ntk>
+std::vector<uint32_t> level_gate_order( Ntk const& ntk )
+{
+  /* the DFS order is topological even if substitutions broke the index order */
+  uint32_t const size = ntk.size();
+  std::vector<uint32_t> const dfs = dfs_gate_order( ntk );
+  std::vector<uint32_t> levels( size, 0u );
+  uint32_t depth{0};
+  for ( uint32_t const n : dfs )
+  {
+    ntk.foreach_fanin( node( n ), [&]( signal const& fi ){
+      levels[n] = std::max( levels[n], levels[fi.index] + 1u );
+    } );
+    depth = std::max( depth, levels[n] );
+  }
+
+  std::vector<uint32_t> offsets( depth + 2u, 0u );
+  for ( uint32_t const n : dfs )
+  {
+    ++offsets[levels[n] + 1u];
+  }
+  for ( uint32_t l = 1u; l < offsets.size(); ++l )
+  {
+    offsets[l] += offsets[l - 1u];
+  }
+  std::vector<bool> alive( size, false );
+  for ( uint32_t const n : dfs )
+  {
+    alive[n] = true;
+  }
+  std::vector<uint32_t> order( dfs.size() );
+  for ( uint32_t n = 1u; n < size; ++n )
+  {
+    if ( alive[n] )
+    {
+      order[offsets[levels[n]]++] = n;
+    }
+  }
+  return order;
+}
+
+} /* detail */
+
+/* Removes the dead nodes of `storage` and renumbers the others.
+ *
+ * A gate is dead if no PO depends on it; this covers the gates with a
+ * zero reference count, the cones that only feed them, and the nodes
+ * freed by `substitute_node`.  The PIs are
+ * kept, in their order, as nodes `1..num_pis`, followed by the live
+ * gates in `ps.order`.  The network is rebuilt into a fresh storage of
+ * the same layout (with a new strash table, reference counts and
+ * outputs, and no marks), which then replaces the contents of
+ * `storage`; networks on `storage` stay valid.  The traversal epochs
+ * are kept, so tokens handed out before remain usable, and so is the
+ * `memory_budget` of `storage`.
+ *
+ * Returns the new index of every old node, or `compaction_removed`.
+ * Works with `storage` and `soa_storage`.
+ */
+template<typename Storage>
+std::vector<uint32_t> compact( Storage& storage, compaction_params const& ps = {} )
+{
+  basic_network<Storage> const old_ntk( storage );
+  std::vector<uint32_t> const order = ps.order == compaction_order::dfs ? detail::dfs_gate_order( old_ntk ) : detail::level_gate_order( old_ntk );
+
+  Storage fresh;
+  basic_network<Storage> ntk( fresh );
+  fresh.reserve( 1u + old_ntk.num_pis() + order.size() );
+  fresh.hash.reserve( order.size() );
+
+  std::vector<uint32_t> map( old_ntk.size(), compaction_removed );
+  map[0] = 0u;
+  old_ntk.foreach_pi( [&]( node n ){
+    map[n] = ntk.create_pi().index;
+  } );
+
+  auto const translate = [&]( signal const& f ){
+    assert( map[f.index] != compaction_removed );
+    return signal( map[f.index], f.complement );
+  };
+  for ( uint32_t const n : order )
+  {
+    std::array<signal, 2u> fanins{};
+    old_ntk.foreach_fanin( node( n ), [&]( signal const& fi, uint32_t i ){
+      fanins[i] = translate( fi );
+    } );
+    signal const s = ntk.create_and( fanins[0], fanins[1] );
+    assert( !s.complement );
+    map[n] = s.index;
+  }
+  old_ntk.foreach_po( [&]( signal const& f ){
+    ntk.create_po( translate( f ) );
+  } );
+
+  fresh.epochs = storage.epochs;
+  if constexpr ( requires { storage.memory_budget; } )
+  {
+    fresh.memory_budget = storage.memory_budget;
+  }
+  storage = std::move( fresh );
+  return map;
+}
+
+} /* aig */
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "aig.hpp"
+#include <parallel_hashmap/phmap.h>
+
+#include <atomic>
+#include <cassert>
+#include <mutex>
+
+namespace aig
+{
+
+/* A construction session that lets many threads build into one `storage` at the same time.
+ *
+ * Node indices are allocated with an atomic counter; the slot of a new
+ * node is taken from the address-stable node arrays of the storage,
+ * whose pages are installed on demand (`capacity` only pre-allocates).  Structural
+ * hashing goes through a sharded `phmap::parallel_flat_hash_map` whose
+ * submaps are guarded by their own mutex; a node is allocated and
+ * initialized under the lock of its submap, so two threads creating
+ * the same AND gate obtain the same index.  Fanout counters are
+ * updated through `std::atomic_ref`.
+ *
+ * Nodes created before the session are found through the (read-only)
+ * `storage::hash`.  Until `commit` (or the destructor) has run, the
+ * storage must only be accessed through the session: `commit` makes
+ * the new nodes part of the storage and folds the new strash entries
+ * into `storage::hash`.  Works with every storage layout.
+ */
+template<typename Storage>
+class basic_concurrent_network
+{
+public:
+  explicit basic_concurrent_network( Storage& storage_, uint64_t capacity = 0u )
+    : storage_( storage_ )
+    , next_index( storage_.num_nodes() )
+  {
+    storage_.reserve( capacity );
+  }
+
+  basic_concurrent_network( basic_concurrent_network const& ) = delete;
+  basic_concurrent_network& operator=( basic_concurrent_network const& ) = delete;
+
+  ~basic_concurrent_network()
+  {
+    commit();
+  }
+
+  signal get_constant( bool value ) const
+  {
+    return {0, value};
+  }
+
+  signal create_not( signal a ) const
+  {
+    return !a;
+  }
+
+  /* thread-safe */
+  signal create_pi()
+  {
+    std::scoped_lock l( io_mutex );
+    uint32_t const index = allocate_index();
+    storage_.inputs.emplace_back( index );
+    return {index, 0};
+  }
+
+  /* thread-safe */
+  void create_po( signal const& f )
+  {
+    std::atomic_ref<uint32_t>( storage_.node_ref_count( f.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+    std::scoped_lock l( io_mutex );
+    storage_.outputs.emplace_back( f.index, f.complement );
+  }
+
+  /* thread-safe */
+  signal create_and( signal a, signal b )
+  {
+    /* order inputs */
+    if ( a.index > b.index )
+    {
+      std::swap( a, b );
+    }
+
+    /* trivial cases */
+    if ( a.index == b.index )
+    {
+      return ( a.complement == b.complement ) ? a : get_constant( false );
+    }
+    else if ( a.index == 0 )
+    {
+      return a.complement ? b : get_constant( false );
+    }
+
+    /* nodes that existed before the session */
+    if ( auto const it = storage_.hash.find( fanin_key( a, b ) ); it != storage_.hash.end() )
+    {
+      return {*it, 0};
+    }
+
+    /* structural hashing; the node is created under the lock of its submap */
+    uint32_t index;
+    bool const created = hash.lazy_emplace_l(
+        key( a, b ),
+        [&]( uint32_t existing ){ index = existing; },
+        [&]( auto const& ctor ){
+          index = allocate_index( {a, b} );
+          ctor( key( a, b ), index );
+        } );
+
+    if ( created )
+    {
+      /* increase ref-count to children */
+      std::atomic_ref<uint32_t>( storage_.node_ref_count( a.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+      std::atomic_ref<uint32_t>( storage_.node_ref_count( b.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+    }
+
+    return {index, 0};
+  }
+
+  /* number of nodes created so far (including the ones that existed before the session) */
+  uint64_t size() const
+  {
+    return next_index.load( std::memory_order_acquire );
+  }
+
+  /* hands the nodes over to `storage`; must not be called concurrently with the `create_*` functions */
+  void commit()
+  {
+    if ( committed )
+    {
+      return;
+    }
+    committed = true;
+
+    storage_.adopt_slots( size() );
+    storage_.hash.reserve( storage_.hash.size() + hash.size() );
+    for ( auto const& [k, index] : hash )
+    {
+      storage_.hash.insert( index );
+    }
+    hash.clear();
+  }
+
+private:
+  static uint64_t key( signal a, signal b )
+  {
+    return fanin_key( a, b ).value;
+  }
+
+  uint32_t allocate_index( fanin_array const& fanins = {} )
+  {
+    uint64_t const index = next_index.fetch_add( 1u, std::memory_order_relaxed );
+    storage_.init_slot( static_cast<uint32_t>( index ), fanins );
+    return static_cast<uint32_t>( index );
+  }
+
+private:
+  Storage& storage_;
+  std::atomic<uint64_t> next_index;
+  std::mutex io_mutex;
+  bool committed{false};
+  phmap::parallel_flat_hash_map<uint64_t, uint32_t,
+                                phmap::priv::hash_default_hash<uint64_t>,
+                                phmap::priv::hash_default_eq<uint64_t>,
+                                phmap::priv::Allocator<phmap::priv::Pair<const uint64_t, uint32_t>>,
+                                6u, std::mutex> hash;
+}; /* basic_concurrent_network */
+
+using concurrent_network = basic_concurrent_network<storage>;
+
+} /* aig */
@@ -1,12 +1,32 @@
 #pragma once
 
 #include "aig.hpp"
+#include "hot_path_counters.hpp"
+#include "static_vector.hpp"
 #include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace aig
 {
 
-bool trivial( aig::network const& aig, std::vector<node> const& cut )
+/* Cut enumeration.
+ *
+ * Cuts live in a `static_vector` sized for the largest cut the
+ * expansion can reach: `SizeLimit` leaves, plus one additional leaf in
+ * each of the `MaxIterations` expansions beyond the limit, plus one.
+ * Leaves are removed by swap-remove, so the leaf order is unspecified.
+ * Enumeration does not allocate.
+ */
+template<uint32_t SizeLimit, uint32_t MaxIterations>
+inline constexpr uint32_t cut_capacity_v = SizeLimit + MaxIterations + 2u;
+
+template<uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u>
+using static_cut = static_vector<node, cut_capacity_v<SizeLimit, MaxIterations>>;
+
+template<typename Ntk, typename Cut>
+bool trivial( Ntk const& aig, Cut const& cut )
 {
   for( node const& n : cut )
   {
@@ -18,7 +38,8 @@ bool trivial( aig::network const& aig, std::vector<node> const& cut )
   return true;
 }
 
-void print_cut( std::vector<node> const& cut, std::ostream& os = std::cout )
+template<typename Cut>
+void print_cut( Cut const& cut, std::ostream& os = std::cout )
 {
   os << "{ ";
   for ( aig::node const& n : cut )
@@ -28,31 +49,30 @@ void print_cut( std::vector<node> const& cut, std::ostream& os = std::cout )
   os << "}" << std::endl;
 }
 
-bool expand0( network const& aig, std::vector<node>& cut, uint32_t thread_id )
+template<typename Ntk, typename Cut>
+bool expand0( Ntk const& aig, Cut& cut, uint32_t thread_id )
 {
   /* presume the current cut is trivial (= consists of PIs only) */
   bool is_trivial{true};
   bool cut_has_changed{true};
 
-  /* temporary container to store newly derived leaves */
-  std::vector<node> new_cut_nodes;
-  new_cut_nodes.reserve( 16 );
-
   /* repeat expansion towards TFI until a fix-point is reached */
   while ( cut_has_changed )
   {
+    AIG_COUNT( expand0_rounds );
     is_trivial = true;
     cut_has_changed = false;
 
-    for ( auto it = std::begin( cut ); it != std::end( cut ); )
+    for ( uint32_t i = 0; i < cut.size(); )
     {
-      assert( !aig.is_constant( *it ) );
-      assert( aig.mark( *it ) == thread_id );
+      node const leaf = cut[i];
+      assert( !aig.is_constant( leaf ) );
+      assert( aig.mark( leaf ) == thread_id );
 
       /* skip the PIs */
-      if ( aig.is_pi( *it ) )
+      if ( aig.is_pi( leaf ) )
       {
-        ++it;
+        ++i;
         continue;
       }
 
@@ -62,7 +82,7 @@ bool expand0( network const& aig, std::vector<node>& cut, uint32_t thread_id )
       /* count how many fanins of this node are already in the cut */
       std::optional<node> expansion_point;
       uint32_t count_fanin_inside{0};
-      aig.foreach_fanin( *it, [&]( signal const& fi ){
+      aig.foreach_fanin( leaf, [&]( signal const& fi ){
         node const n = aig.get_node( fi );
         if ( aig.mark( n ) == thread_id )
         {
@@ -75,59 +95,49 @@ bool expand0( network const& aig, std::vector<node>& cut, uint32_t thread_id )
       });
 
       /* if the expansion is not cost-free, then proceeded with the next leaf */
-      if ( count_fanin_inside + 1 < aig.fanin_size( *it ) )
+      if ( count_fanin_inside + 1 < aig.fanin_size( leaf ) )
       {
-        ++it;
+        ++i;
         continue;
       }
 
-      if ( expansion_point )
+      /* replace the leaf by its fanin; the swapped-in leaf is visited next */
+      cut.swap_remove( i );
+      if ( expansion_point && aig.check_and_mark( *expansion_point, thread_id ) )
       {
-        if ( aig.check_and_mark( *expansion_point, thread_id ) )
-        {
-          new_cut_nodes.emplace_back( *expansion_point );
-        }
+        cut.push_back( *expansion_point );
       }
-
-      it = cut.erase( it );
       cut_has_changed = true;
     }
-
-    for ( node const& n : new_cut_nodes )
-    {
-      cut.push_back( n );
-    }
-
-    new_cut_nodes.clear();
   }
   return is_trivial;
 }
 
-void evaluate_fanin( node const& n, std::vector<std::pair<node, uint32_t>>& candidates )
+template<typename Candidates>
+void evaluate_fanin( node const& n, Candidates& candidates )
 {
-  auto it = std::find_if( std::begin( candidates ), std::end( candidates ),
-                          [&n]( auto const& p ){
-                            return p.first == n;
-                          } );
-  if ( it == std::end( candidates ) )
-  {
-    /* new fanin: referenced for the 1st time */
-    candidates.push_back( std::make_pair( n, 1u ) );
-  }
-  else
+  for ( auto& c : candidates )
   {
-    /* otherwise, if not new, then just increase the reference counter */
-    ++it->second;
+    if ( c.first == n )
+    {
+      /* otherwise, if not new, then just increase the reference counter */
+      ++c.second;
+      return;
+    }
   }
+
+  /* new fanin: referenced for the 1st time */
+  candidates.push_back( std::make_pair( n, 1u ) );
 }
 
-node select_next_fanin( aig::network const& aig, std::vector<node> const& cut )
+template<typename Ntk, typename Cut>
+node select_next_fanin( Ntk const& aig, Cut const& cut )
 {
   assert( cut.size() > 0u && "cut must not be empty" );
   assert( !trivial( aig, cut ) );
 
   /* evaluate the fanins with respect to their costs (how often are they referenced) */
-  std::vector<std::pair<node, uint32_t>> candidates;
+  static_vector<std::pair<node, uint32_t>, 2u * Cut::capacity()> candidates;
   for ( node const& n : cut )
   {
     if ( aig.is_constant( n ) || aig.is_pi( n ) )
@@ -161,81 +171,122 @@ node select_next_fanin( aig::network const& aig, std::vector<node> const& cut )
   return best_fanin.first;
 }
 
-void expand( aig::network const& aig, std::vector<node>& cut, uint32_t size_limit, uint32_t thread_id )
+template<uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u, typename Ntk, typename Cut>
+void expand( Ntk const& aig, Cut& cut, uint32_t thread_id )
 {
-  static constexpr uint32_t const MAX_ITERATIONS{5u};
+  static_assert( Cut::capacity() >= cut_capacity_v<SizeLimit, MaxIterations> );
   if ( expand0( aig, cut, thread_id ) )
   {
+    AIG_COUNT( cuts );
+    AIG_COUNT_ADD( cut_leaves, cut.size() );
     return;
   }
 
-  std::optional<std::vector<node>> best_cut;
-  if ( cut.size() <= size_limit )
+  /* the last cut within the size limit */
+  Cut best_cut;
+  bool has_best{false};
+  if ( cut.size() <= SizeLimit )
   {
-    *best_cut = cut;
+    best_cut = cut;
+    has_best = true;
   }
 
   bool trivial_cut{false};
   uint32_t iterations{0};
-  while ( !trivial_cut && ( cut.size() <= size_limit || iterations < MAX_ITERATIONS ) )
+  while ( !trivial_cut && ( cut.size() <= SizeLimit || iterations < MaxIterations ) )
   {
     node const n = select_next_fanin( aig, cut );
-    if ( aig.check_and_mark( n, thread_id ) )
+    if ( !aig.check_and_mark( n, thread_id ) )
     {
-      cut.push_back( n );
+      /* the fanin is owned by another thread: this cut cannot grow any further */
+      AIG_COUNT( expand_conflicts );
+      break;
     }
+    cut.push_back( n );
+    AIG_COUNT( expand_iterations );
 
     trivial_cut = expand0( aig, cut, thread_id );
     assert( trivial_cut == trivial( aig, cut ) );
 
-    iterations = cut.size() > size_limit ? iterations + 1 : 0;
-    if ( cut.size() <= size_limit &&
-         ( !best_cut || best_cut->size() <= size_limit ) )
+    iterations = cut.size() > SizeLimit ? iterations + 1 : 0;
+    if ( cut.size() <= SizeLimit )
     {
       best_cut = cut;
+      has_best = true;
     }
   }
 
-  if ( best_cut )
+  AIG_COUNT_ADD( max_iterations_bailouts, !trivial_cut && cut.size() > SizeLimit && iterations >= MaxIterations ? 1u : 0u );
+
+  if ( has_best )
   {
-    cut = *best_cut;
+    cut = best_cut;
   }
   else
   {
-    assert( cut.size() > size_limit );
+    assert( cut.size() > SizeLimit );
   }
+  AIG_COUNT( cuts );
+  AIG_COUNT_ADD( cut_leaves, cut.size() );
 }
 
-std::vector<node> create_cut( network const& aig, node n, uint32_t thread_id )
+/* computes a cut of `n` without allocating; the cut is empty if `n` is owned by another thread */
+template<uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u, typename Ntk>
+static_cut<SizeLimit, MaxIterations> create_static_cut( Ntk const& aig, node n, uint32_t thread_id )
 {
+  static_cut<SizeLimit, MaxIterations> cut;
+
   /* check if the node is not owned by another thread and mark it */
   if ( !aig.check_and_mark( n, thread_id ) )
   {
-    return {};
+    return cut;
   }
 
-  std::vector<node> cut{n};
-  expand( aig, cut, 6u, thread_id );
-
+  cut.push_back( n );
+  expand<SizeLimit, MaxIterations>( aig, cut, thread_id );
   return cut;
 }
 
-std::vector<node> create_cut( network const& aig, signal s, uint32_t thread_id )
+template<typename Ntk>
+std::vector<node> create_cut( Ntk const& aig, node n, uint32_t thread_id )
+{
+  auto const cut = create_static_cut( aig, n, thread_id );
+  return std::vector<node>( cut.begin(), cut.end() );
+}
+
+template<typename Ntk>
+std::vector<node> create_cut( Ntk const& aig, signal s, uint32_t thread_id )
 {
   return create_cut( aig, aig.get_node( s ), thread_id );
 }
 
-void release_cut( network const& aig, node n, std::vector<node> const& cut, uint32_t thread_id )
+/* unmarks the cone of `n` that is marked with `thread_id` (iteratively, safe on long chains) */
+template<typename Ntk, typename Cut>
+void release_cut( Ntk const& aig, node n, Cut const& cut, uint32_t thread_id )
 {
-  if ( aig.mark ( n ) != thread_id )
+  (void)cut;
+  std::vector<node> stack{n};
+  while ( !stack.empty() )
   {
-    return;
+    node const m = stack.back();
+    stack.pop_back();
+    if ( aig.mark( m ) != thread_id )
+    {
+      continue;
+    }
+
+    aig.reset_mark( m );
+    aig.foreach_fanin( m, [&]( signal const& s ){
+      stack.push_back( aig.get_node( s ) );
+    });
   }
+}
 
-  aig.reset_mark( n );
-  aig.foreach_fanin( n, [&]( signal const& s ){
-    release_cut( aig, aig.get_node( s ), cut, thread_id );
-  });
+/* releases every cut of `thread_id` at once by advancing its epoch; returns the token for the next cuts */
+template<typename Ntk>
+uint32_t release_cuts( Ntk const& aig, uint32_t thread_id )
+{
+  return aig.release_marks( thread_id );
 }
 
 } /* namespace aig */
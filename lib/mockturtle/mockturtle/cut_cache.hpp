@@ -0,0 +1,129 @@
+#pragma once
+
+#include "aig.hpp"
+#include "cut.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace aig
+{
+
+/* Cuts of `create_static_cut` that survive network edits.
+ *
+ * Every node has a structural stamp, the value of a version counter at
+ * the last edit of its cone; every cached cut records the stamp of its
+ * root when it was computed.  `touch( n )` bumps the counter and
+ * writes it to `n` and its transitive fanout (through the fanouts of
+ * `Ntk`, e.g., a `fanout_level_view`), so a lookup only recomputes
+ * the cuts of nodes whose TFI changed; pass `touch` as the callback of
+ * `substitute_node`.  Nodes added to the network start out uncached.
+ *
+ * A cached cut is a cut of the unchanged cone of its root, but not
+ * necessarily the one a fresh `create_static_cut` would return: the
+ * expansion breaks ties by reference counts, which also change
+ * outside of the cone.  Not thread-safe.
+ */
+template<typename Ntk, uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u>
+class cut_cache
+{
+public:
+  using cut_type = static_cut<SizeLimit, MaxIterations>;
+
+  explicit cut_cache( Ntk const& ntk )
+    : ntk( ntk )
+  {}
+
+  /* The cut of `n`, from the cache if the cone of `n` is unchanged.
+   *
+   * Otherwise, the cut is computed with `create_static_cut( ntk, n,
+   * token )`, which claims the cone for `token` like `create_cut`; a
+   * cached cut claims nothing.  An empty cut (the root is claimed by
+   * another owner) is not cached.
+   */
+  cut_type cut( node n, uint32_t token )
+  {
+    grow();
+    if ( cut_stamps[n] == stamps[n] )
+    {
+      ++hits;
+      return cuts[n];
+    }
+    ++misses;
+    cut_type const c = create_static_cut<SizeLimit, MaxIterations>( ntk, n, token );
+    if ( !c.empty() )
+    {
+      cuts[n] = c;
+      cut_stamps[n] = stamps[n];
+    }
+    return c;
+  }
+
+  /* invalidates the cuts of `n` and its transitive fanout, e.g., after the fanins of `n` changed */
+  void touch( node n )
+  {
+    grow();
+    ++version;
+    stack.assign( 1u, n );
+    while ( !stack.empty() )
+    {
+      node const g = stack.back();
+      stack.pop_back();
+      if ( stamps[g] == version )
+      {
+        continue;
+      }
+      stamps[g] = version;
+
+      /* nodes that are being freed have no fanouts */
+      if ( ntk.fanout_size( g ) != 0u )
+      {
+        ntk.foreach_fanout( g, [&]( node f ){
+          stack.push_back( f );
+        } );
+      }
+    }
+  }
+
+  /* drops all cached cuts */
+  void clear()
+  {
+    cut_stamps.assign( cut_stamps.size(), invalid );
+  }
+
+  uint64_t num_hits() const
+  {
+    return hits;
+  }
+
+  uint64_t num_misses() const
+  {
+    return misses;
+  }
+
+private:
+  static constexpr uint64_t invalid = ~uint64_t( 0 );
+
+  /* covers the nodes added since the last call */
+  void grow()
+  {
+    if ( stamps.size() < ntk.size() )
+    {
+      stamps.resize( ntk.size(), 0u );
+      cut_stamps.resize( ntk.size(), invalid );
+      cuts.resize( ntk.size() );
+    }
+  }
+
+private:
+  Ntk const& ntk;
+  std::vector<uint64_t> stamps;     /* structural stamp of every node */
+  std::vector<uint64_t> cut_stamps; /* stamp of the root when its cut was cached */
+  std::vector<cut_type> cuts;
+  std::vector<node> stack;
+  uint64_t version{0};
+  uint64_t hits{0};
+  uint64_t misses{0};
+}; /* cut_cache */
+
+} /* aig */
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "aig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace aig
+{
+
+namespace detail
+{
+
+/* truth tables of the first six variables */
+inline constexpr std::array<uint64_t, 6u> projections{
+  0xaaaaaaaaaaaaaaaaull,
+  0xccccccccccccccccull,
+  0xf0f0f0f0f0f0f0f0ull,
+  0xff00ff00ff00ff00ull,
+  0xffff0000ffff0000ull,
+  0xffffffff00000000ull };
+
+} /* detail */
+
+/* Computes the Boolean function of a cone in terms of the leaves of a cut.
+ *
+ * The cone between the root and the leaves is simulated bottom-up,
+ * one 64-bit word per node for cuts with at most six leaves and
+ * 2^(k-6) words per node for cuts with k > 6 leaves; leaf `i` is
+ * variable `i`.  Every node of the cone is evaluated once per call:
+ * the results are memoized per node and tagged with the number of the
+ * call, so shared logic is not simulated twice and the memo never has
+ * to be cleared.  The memo grows with the network and is reused from
+ * call to call.
+ *
+ * The leaves have to form a cut of the root, i.e., every path from the
+ * root to a PI has to pass through a leaf.  Not thread-safe: use one
+ * object per thread.
+ */
+template<typename Ntk>
+class cut_function
+{
+public:
+  static constexpr uint32_t max_small_leaves = 6u;
+
+  explicit cut_function( Ntk const& ntk )
+    : ntk( ntk )
+  {}
+
+  /* truth table (lower 2^k bits) of `root` over the k <= 6 `leaves` */
+  template<typename Leaves>
+  uint64_t compute( node root, Leaves const& leaves )
+  {
+    uint32_t const num_vars = static_cast<uint32_t>( std::size( leaves ) );
+    assert( num_vars <= max_small_leaves );
+    begin_call( 1u );
+
+    uint32_t i{0};
+    for ( node const& l : leaves )
+    {
+      *assign( l ) = detail::projections[i++];
+    }
+
+    uint64_t const mask = num_vars == max_small_leaves ? ~uint64_t( 0 ) : ( ( uint64_t( 1 ) << ( 1u << num_vars ) ) - 1u );
+    return *simulate( root ) & mask;
+  }
+
+  /* truth table of `root` over any number of `leaves`, as 2^(k-6) words (at least one) */
+  template<typename Leaves>
+  std::vector<uint64_t> compute_dynamic( node root, Leaves const& leaves )
+  {
+    uint32_t const num_vars = static_cast<uint32_t>( std::size( leaves ) );
+    uint32_t const num_words = num_vars <= max_small_leaves ? 1u : ( 1u << ( num_vars - max_small_leaves ) );
+    begin_call( num_words );
+
+    uint32_t i{0};
+    for ( node const& l : leaves )
+    {
+      uint64_t* const tt = assign( l );
+      for ( uint32_t w = 0; w < num_words; ++w )
+      {
+        if ( i < max_small_leaves )
+        {
+          tt[w] = detail::projections[i];
+        }
+        else
+        {
+          tt[w] = ( ( w >> ( i - max_small_leaves ) ) & 1u ) ? ~uint64_t( 0 ) : uint64_t( 0 );
+        }
+      }
+      ++i;
+    }
+
+    uint64_t const* const tt = simulate( root );
+    std::vector<uint64_t> result( tt, tt + num_words );
+    if ( num_vars < max_small_leaves )
+    {
+      result[0] &= ( uint64_t( 1 ) << ( 1u << num_vars ) ) - 1u;
+    }
+    return result;
+  }
+
+private:
+  void begin_call( uint32_t words )
+  {
+    num_words = words;
+    pool.clear();
+    if ( ++call == 0u )
+    {
+      /* the call counter wrapped around: forget all memoized results */
+      std::fill( stamps.begin(), stamps.end(), 0u );
+      call = 1u;
+    }
+    if ( stamps.size() < ntk.size() )
+    {
+      stamps.resize( ntk.size(), 0u );
+      offsets.resize( ntk.size(), 0u );
+    }
+  }
+
+  uint64_t* value( node n )
+  {
+    return pool.data() + offsets[n];
+  }
+
+  bool evaluated( node n ) const
+  {
+    return stamps[n] == call;
+  }
+
+  /* reserves the words of `n` for this call */
+  uint64_t* assign( node n )
+  {
+    stamps[n] = call;
+    offsets[n] = static_cast<uint32_t>( pool.size() );
+    pool.resize( pool.size() + num_words, 0u );
+    return value( n );
+  }
+
+  uint64_t const* simulate( node root )
+  {
+    if ( !evaluated( node( 0u ) ) )
+    {
+      assign( node( 0u ) ); /* constant 0 */
+    }
+
+    /* iterative post-order traversal from the root down to the leaves */
+    stack.clear();
+    stack.push_back( root );
+    while ( !stack.empty() )
+    {
+      node const n = stack.back();
+      if ( evaluated( n ) )
+      {
+        stack.pop_back();
+        continue;
+      }
+      assert( !ntk.is_pi( n ) && "the leaves do not form a cut of the root" );
+
+      std::array<signal, 2u> fanins{};
+      ntk.foreach_fanin( n, [&]( signal const& fi, uint32_t i ){
+        fanins[i] = fi;
+      });
+
+      bool ready{true};
+      for ( auto const& fi : fanins )
+      {
+        if ( !evaluated( ntk.get_node( fi ) ) )
+        {
+          stack.push_back( ntk.get_node( fi ) );
+          ready = false;
+        }
+      }
+      if ( !ready )
+      {
+        continue;
+      }
+
+      stack.pop_back();
+      uint64_t* const tt = assign( n );
+      uint64_t const* const a = value( ntk.get_node( fanins[0] ) );
+      uint64_t const* const b = value( ntk.get_node( fanins[1] ) );
+      uint64_t const ca = fanins[0].complement ? ~uint64_t( 0 ) : uint64_t( 0 );
+      uint64_t const cb = fanins[1].complement ? ~uint64_t( 0 ) : uint64_t( 0 );
+      for ( uint32_t w = 0; w < num_words; ++w )
+      {
+        tt[w] = ( a[w] ^ ca ) & ( b[w] ^ cb );
+      }
+    }
+    return value( root );
+  }
+
+private:
+  Ntk const& ntk;
+
+  uint32_t call{0};
+  uint32_t num_words{1};
+  std::vector<uint32_t> stamps;  /* number of the call that evaluated a node */
+  std::vector<uint32_t> offsets; /* position of the words of a node in `pool` */
+  std::vector<uint64_t> pool;
+  std::vector<node> stack;
+}; /* cut_function */
+
+} /* aig */
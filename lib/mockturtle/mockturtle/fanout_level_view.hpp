@@ -0,0 +1,471 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+/* Fanout lists and logic levels of a network.
+ *
+ * Both are built lazily, on the first query.  The fanouts (the AND
+ * gates that read a node; POs are not listed) are kept in CSR layout:
+ * `fanouts[offsets[n]..offsets[n + 1])` lists the fanouts of `n` in
+ * ascending order.  The level of a node is 0 for the constant and the
+ * PIs and one more than the highest fanin level for an AND gate.
+ *
+ * Nodes appended to the network after the build (through the view or
+ * directly) are taken into account incrementally before the next
+ * query: they get their level, and their edges are kept in a side
+ * table next to the CSR arrays.  `substitute_node` edits the index in
+ * place: removed edges leave a hole in the CSR arrays, moved ones go
+ * to the side table, and the levels of the affected fanouts are
+ * updated.  Gates that reuse a free slot must be created through the
+ * view.  Once the side table and the holes amount to more than one
+ * eighth of the edges, the index is stale and is rebuilt from scratch,
+ * in parallel by `update( tm )`.  Fanout lists are ascending as long
+ * as no fanout was moved.
+ *
+ * Queries bring the index up to date and are therefore not thread-safe
+ * while nodes are being added; after `update`, concurrent queries only
+ * read.
+ */
+template<typename Ntk>
+class fanout_level_view : public Ntk
+{
+public:
+  explicit fanout_level_view( Ntk const& ntk )
+    : Ntk( ntk )
+  {}
+
+  /* calls `fn( fanout )` for each AND gate that reads `n`; stops if `fn` returns false */
+  template<typename Fn>
+  void foreach_fanout( node n, Fn&& fn ) const
+  {
+    update_fanouts();
+    auto const visit = [&]( node f ){
+      if constexpr ( mockturtle::detail::is_callable_without_index_v<Fn, node, bool> )
+      {
+        return fn( f );
+      }
+      else
+      {
+        fn( f );
+        return true;
+      }
+    };
+    for ( uint32_t i = offsets_[n]; i < offsets_[n + 1u]; ++i )
+    {
+      if ( fanouts_[i] != 0u && !visit( fanouts_[i] ) )
+      {
+        return;
+      }
+    }
+    if ( auto const it = appended_.find( n ); it != appended_.end() )
+    {
+      for ( node const f : it->second )
+      {
+        if ( !visit( f ) )
+        {
+          return;
+        }
+      }
+    }
+  }
+
+  /* number of AND gates that read `n` */
+  uint32_t fanout_count( node n ) const
+  {
+    update_fanouts();
+    uint32_t count = offsets_[n + 1u] - offsets_[n];
+    if ( auto const it = appended_.find( n ); it != appended_.end() )
+    {
+      count += static_cast<uint32_t>( it->second.size() );
+    }
+    if ( auto const it = holes_.find( n ); it != holes_.end() )
+    {
+      count -= it->second;
+    }
+    return count;
+  }
+
+  /* same as `Ntk::create_and`, but also indexes a gate that reuses a free slot */
+  signal create_and( signal a, signal b )
+  {
+    uint32_t const size = Ntk::size();
+    uint32_t const num_gates = Ntk::num_gates();
+    signal const s = Ntk::create_and( a, b );
+    if ( Ntk::size() == size && Ntk::num_gates() != num_gates )
+    {
+      if ( fanouts_built_ && s.index < fanout_nodes_ )
+      {
+        add_fanout( a.index, node( s.index ) );
+        add_fanout( b.index, node( s.index ) );
+      }
+      if ( s.index < levels_.size() )
+      {
+        update_levels();
+        levels_[s.index] = std::max( levels_[a.index], levels_[b.index] ) + 1u;
+      }
+    }
+    return s;
+  }
+
+  /* Replaces every use of the node `old` (in gates and POs) by `s`.
+   *
+   * Fanouts that become trivial or structurally equal to another gate
+   * are substituted in turn.  Afterwards, `old` and every cone that is
+   * no longer referenced are freed (see `take_out_node`), which
+   * includes `s` if nothing ends up using it; the slots are reused by
+   * `create_and`.  `s` must not depend on `old`.
+   */
+  void substitute_node( node old, signal s )
+  {
+    substitute_node( old, s, []( node ){} );
+  }
+
+  /* same as above, and calls `on_change( n )` for every gate `n` whose fanins are replaced and every node that is freed */
+  template<typename Fn>
+  void substitute_node( node old, signal s, Fn&& on_change )
+  {
+    update();
+
+    /* The targets of pending substitutions and of done ones are pinned
+     * (referenced once more) so that they are not freed while a
+     * fanout may still be redirected to them. */
+    phmap::flat_hash_map<uint32_t, signal> replaced;
+    auto const resolve = [&]( signal f ){
+      for ( auto it = replaced.find( f.index ); it != replaced.end(); it = replaced.find( f.index ) )
+      {
+        f = it->second ^ static_cast<bool>( f.complement );
+      }
+      return f;
+    };
+    Ntk::incr_fanout_size( Ntk::get_node( s ) );
+    std::vector<std::pair<node, signal>> stack{{old, s}};
+    std::vector<node> fanouts;
+    while ( !stack.empty() )
+    {
+      auto const [o, target] = stack.back();
+      stack.pop_back();
+      signal const t = resolve( target );
+      if ( Ntk::is_dead( o ) || o == t.index || replaced.contains( o ) )
+      {
+        release( Ntk::get_node( target ), on_change );
+        continue;
+      }
+
+      fanouts.clear();
+      foreach_fanout( o, [&]( node f ){ fanouts.push_back( f ); } );
+      for ( node const f : fanouts )
+      {
+        if ( auto const r = Ntk::replace_in_node( f, o, t ) )
+        {
+          Ntk::incr_fanout_size( Ntk::get_node( *r ) );
+          stack.emplace_back( f, *r );
+          continue;
+        }
+        remove_fanout( o, f );
+        add_fanout( t.index, f );
+        update_level( f );
+        on_change( f );
+      }
+      Ntk::replace_in_outputs( o, t );
+
+      /* move the pin from `target` to `t` */
+      Ntk::incr_fanout_size( Ntk::get_node( t ) );
+      release( Ntk::get_node( target ), on_change );
+      replaced.emplace( o, t );
+      free_if_unused( o, on_change );
+    }
+    for ( auto const& [o, t] : replaced )
+    {
+      release( Ntk::get_node( t ), on_change );
+    }
+  }
+
+  uint32_t level( node n ) const
+  {
+    update_levels();
+    return levels_[n];
+  }
+
+  /* highest level of a PO */
+  uint32_t depth() const
+  {
+    update_levels();
+    uint32_t d{0};
+    Ntk::foreach_po( [&]( signal const& f ){
+      d = std::max( d, levels_[f.index] );
+    } );
+    return d;
+  }
+
+  /* brings the index up to date with the network */
+  void update() const
+  {
+    update_fanouts();
+    update_levels();
+  }
+
+  /* same as `update`, but rebuilds a stale fanout index on the workers of `tm` */
+  template<typename TaskManager>
+  void update( TaskManager& tm ) const
+  {
+    if ( !fanouts_built_ || stale( Ntk::size() - fanout_nodes_ ) )
+    {
+      build_fanouts( tm );
+    }
+    update();
+  }
+
+  /* drops the index; it is rebuilt on the next query */
+  void reset() const
+  {
+    fanouts_built_ = false;
+    offsets_ = {};
+    fanouts_ = {};
+    appended_ = {};
+    num_appended_ = 0u;
+    holes_ = {};
+    num_holes_ = 0u;
+    levels_ = {};
+  }
+
+private:
+  /* true if the side table would exceed 1/8 of the edges after adding the gates of `num_new` nodes */
+  bool stale( uint64_t num_new ) const
+  {
+    return 8u * ( num_appended_ + num_holes_ + 2u * num_new ) > fanouts_.size() + 2u * num_new + 1024u;
+  }
+
+  void add_fanout( uint32_t n, node f )
+  {
+    appended_[n].emplace_back( f );
+    ++num_appended_;
+  }
+
+  void remove_fanout( uint32_t n, node f )
+  {
+    if ( auto const it = appended_.find( n ); it != appended_.end() )
+    {
+      if ( auto const pos = std::find( it->second.begin(), it->second.end(), f ); pos != it->second.end() )
+      {
+        *pos = it->second.back();
+        it->second.pop_back();
+        --num_appended_;
+        return;
+      }
+    }
+    auto const begin = fanouts_.begin() + offsets_[n], end = fanouts_.begin() + offsets_[n + 1u];
+    auto const pos = std::find( begin, end, f );
+    assert( pos != end );
+    *pos = node( 0u ); /* the constant is never a fanout */
+    ++holes_[n];
+    ++num_holes_;
+  }
+
+  /* drops a pin of `n` */
+  template<typename Fn>
+  void release( node n, Fn&& on_change )
+  {
+    Ntk::decr_fanout_size( n );
+    free_if_unused( n, on_change );
+  }
+
+  /* frees the gate `n` if nothing references it */
+  template<typename Fn>
+  void free_if_unused( node n, Fn&& on_change )
+  {
+    if ( Ntk::fanout_size( n ) != 0u || Ntk::fanin_size( n ) == 0u )
+    {
+      return;
+    }
+    Ntk::take_out_node( n, [&]( node g ){
+      Ntk::foreach_fanin( g, [&]( signal const& f ){
+        remove_fanout( f.index, g );
+      } );
+      on_change( g );
+    } );
+  }
+
+  /* recomputes the level of `n` and of the fanouts it changes */
+  void update_level( node n )
+  {
+    std::vector<node> changed{n};
+    while ( !changed.empty() )
+    {
+      node const g = changed.back();
+      changed.pop_back();
+      uint32_t l{0};
+      Ntk::foreach_fanin( g, [&]( signal const& f ){
+        l = std::max( l, levels_[f.index] + 1u );
+      } );
+      if ( l != levels_[g] )
+      {
+        levels_[g] = l;
+        foreach_fanout( g, [&]( node f ){ changed.push_back( f ); } );
+      }
+    }
+  }
+
+  void update_fanouts() const
+  {
+    uint32_t const size = Ntk::size();
+    if ( fanouts_built_ && fanout_nodes_ == size && !stale( 0u ) )
+    {
+      return;
+    }
+    if ( !fanouts_built_ || stale( size - fanout_nodes_ ) )
+    {
+      build_fanouts();
+      return;
+    }
+
+    offsets_.resize( size + 1u, offsets_.back() );
+    for ( uint32_t n = fanout_nodes_; n < size; ++n )
+    {
+      Ntk::foreach_fanin( node( n ), [&]( signal const& f ){
+        appended_[f.index].emplace_back( n );
+        ++num_appended_;
+      } );
+    }
+    fanout_nodes_ = size;
+  }
+
+  void build_fanouts() const
+  {
+    uint32_t const size = Ntk::size();
+    offsets_.assign( size + 1u, 0u );
+    for ( uint32_t n = 1u; n < size; ++n )
+    {
+      Ntk::foreach_fanin( node( n ), [&]( signal const& f ){
+        ++offsets_[f.index + 1u];
+      } );
+    }
+    for ( uint32_t n = 0u; n < size; ++n )
+    {
+      offsets_[n + 1u] += offsets_[n];
+    }
+
+    /* visiting the gates in order keeps every list sorted */
+    fanouts_.resize( offsets_[size] );
+    std::vector<uint32_t> fill( offsets_.begin(), offsets_.end() - 1 );
+    for ( uint32_t n = 1u; n < size; ++n )
+    {
+      Ntk::foreach_fanin( node( n ), [&]( signal const& f ){
+        fanouts_[fill[f.index]++] = node( n );
+      } );
+    }
+    finish_build( size );
+  }
+
+  template<typename TaskManager>
+  void build_fanouts( TaskManager& tm ) const
+  {
+    constexpr uint64_t grain = 1u << 12u;
+    uint32_t const size = Ntk::size();
+    offsets_.assign( size + 1u, 0u );
+    tm.parallel_for( mockturtle::detail::range<uint32_t>( 1u, size ), grain, [&]( uint32_t n ){
+      Ntk::foreach_fanin( node( n ), [&]( signal const& f ){
+        std::atomic_ref<uint32_t>( offsets_[f.index + 1u] ).fetch_add( 1u, std::memory_order_relaxed );
+      } );
+    } );
+    for ( uint32_t n = 0u; n < size; ++n )
+    {
+      offsets_[n + 1u] += offsets_[n];
+    }
+
+    fanouts_.resize( offsets_[size] );
+    std::vector<uint32_t> fill( offsets_.begin(), offsets_.end() - 1 );
+    tm.parallel_for( mockturtle::detail::range<uint32_t>( 1u, size ), grain, [&]( uint32_t n ){
+      Ntk::foreach_fanin( node( n ), [&]( signal const& f ){
+        fanouts_[std::atomic_ref<uint32_t>( fill[f.index] ).fetch_add( 1u, std::memory_order_relaxed )] = node( n );
+      } );
+    } );
+
+    /* the slots were claimed in any order */
+    tm.parallel_for( mockturtle::detail::range<uint32_t>( size ), grain, [&]( uint32_t n ){
+      std::sort( fanouts_.begin() + offsets_[n], fanouts_.begin() + offsets_[n + 1u] );
+    } );
+    finish_build( size );
+  }
+
+  void finish_build( uint32_t size ) const
+  {
+    appended_.clear();
+    num_appended_ = 0u;
+    holes_.clear();
+    num_holes_ = 0u;
+    fanout_nodes_ = size;
+    fanouts_built_ = true;
+  }
+
+  void update_levels() const
+  {
+    uint32_t const size = Ntk::size();
+    uint32_t const first = static_cast<uint32_t>( levels_.size() );
+    if ( first == size )
+    {
+      return;
+    }
+    levels_.resize( size, unknown_level );
+
+    /* fanins precede their fanouts unless nodes were substituted, in
+     * which case a node waits on the stack for its later fanins */
+    std::vector<uint32_t> stack;
+    for ( uint32_t n = first; n < size; ++n )
+    {
+      stack.push_back( n );
+      while ( !stack.empty() )
+      {
+        uint32_t const g = stack.back();
+        if ( levels_[g] != unknown_level )
+        {
+          stack.pop_back();
+          continue;
+        }
+        uint32_t l{0};
+        bool ready{true};
+        Ntk::foreach_fanin( node( g ), [&]( signal const& f ){
+          if ( levels_[f.index] == unknown_level )
+          {
+            stack.push_back( f.index );
+            ready = false;
+          }
+          l = std::max( l, levels_[f.index] + 1u );
+        } );
+        if ( ready )
+        {
+          levels_[g] = l;
+          stack.pop_back();
+        }
+      }
+    }
+  }
+
+private:
+  mutable bool fanouts_built_{false};
+  mutable uint32_t fanout_nodes_{0}; /* nodes covered by the fanout index */
+  mutable std::vector<uint32_t> offsets_;
+  mutable std::vector<node> fanouts_;
+  mutable phmap::flat_hash_map<uint32_t, std::vector<node>> appended_; /* edges added after the build */
+  mutable uint64_t num_appended_{0};
+  mutable phmap::flat_hash_map<uint32_t, uint32_t> holes_; /* removed CSR edges per node */
+  mutable uint64_t num_holes_{0};
+
+  static constexpr uint32_t unknown_level = ~uint32_t( 0 );
+  mutable std::vector<uint32_t> levels_; /* of the first `levels_.size()` nodes */
+}; /* fanout_level_view */
+
+} /* aig */
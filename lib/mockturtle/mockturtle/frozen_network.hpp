@@ -0,0 +1,525 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+/* A read-only, compressed copy of a network (see `frozen_network`).
+ *
+ * Every node is a record of three variable-length integers (LEB128,
+ * seven bits per byte): for a gate `n` with fanin literals `l0` and
+ * `l1` (`signal::data`), the zigzag-encoded deltas `2n - l1` and
+ * `l1 - l0` and the reference count; the first value of a record is 0
+ * for the constant and the PIs and 1 for a dead node, which no gate
+ * delta can be.  In a topological network most deltas are small, so a
+ * node takes a few bytes instead of the 16 of a `storage` record and
+ * the strash table, which is left out.  The deltas are signed, so a
+ * gate in a reused slot (with fanins after it) only takes more bytes.
+ *
+ * Random access goes through a two-level index: the byte offset of
+ * every 1024th node, and relative to it (in 16 bits) the offset of
+ * every 8th node; the records in between are skipped eight bytes at a
+ * time by counting the final bytes of the integers.  Each thread keeps
+ * the records it decoded recently in a small cache, so the repeated
+ * queries of an engine about a neighborhood decode each node once, and
+ * scans in index order continue from the last record.
+ *
+ * The traversal marks (four bytes per node) are allocated when a node
+ * is claimed for the first time.  Reading is thread-safe.
+ */
+class frozen_storage
+{
+public:
+  static constexpr uint32_t block_bits = 3u;
+  static constexpr uint32_t block_nodes = 1u << block_bits;
+  static constexpr uint32_t superblock_bits = 10u; /* at most 1024 * 3 * 5 bytes, offsets fit in 16 bits */
+
+  struct record
+  {
+    bool is_gate() const
+    {
+      return kind > 1u;
+    }
+
+    uint64_t kind;            /* first value: 0 (constant, PI), 1 (dead), or a gate delta */
+    std::array<uint32_t, 2u> literals;
+    uint32_t ref_count;
+  }; /* record */
+
+  /* copies `ntk`, e.g., a `network` or a `mapped_network` */
+  template<typename Ntk>
+  explicit frozen_storage( Ntk const& ntk )
+    : id( next_id() )
+  {
+    uint32_t const size = ntk.size();
+    std::vector<bool> is_input( size, false );
+    ntk.foreach_pi( [&]( node n ){
+      inputs.emplace_back( n );
+      is_input[n] = true;
+    } );
+    ntk.foreach_po( [&]( signal const& f ){
+      outputs.emplace_back( f );
+    } );
+
+    superblock_offsets.reserve( ( size >> superblock_bits ) + 1u );
+    block_offsets.reserve( ( size >> block_bits ) + 1u );
+    bytes.reserve( 4u * uint64_t( size ) );
+    for ( uint32_t n = 0u; n < size; ++n )
+    {
+      if ( ( n & ( ( 1u << superblock_bits ) - 1u ) ) == 0u )
+      {
+        superblock_offsets.emplace_back( bytes.size() );
+      }
+      if ( ( n & ( block_nodes - 1u ) ) == 0u )
+      {
+        block_offsets.emplace_back( static_cast<uint16_t>( bytes.size() - superblock_offsets.back() ) );
+      }
+
+      if ( n == 0u || is_input[n] )
+      {
+        put( 0u );
+        put( 0u );
+      }
+      else if ( ntk.is_dead( node( n ) ) )
+      {
+        put( 1u );
+        put( 0u );
+      }
+      else
+      {
+        std::array<uint32_t, 2u> literals{};
+        ntk.foreach_fanin( node( n ), [&]( signal const& fi, uint32_t i ){
+          literals[i] = fi.data;
+        } );
+        put( zigzag( int64_t( 2u * uint64_t( n ) ) - int64_t( literals[1] ) ) );
+        put( zigzag( int64_t( literals[1] ) - int64_t( literals[0] ) ) );
+        ++gates;
+      }
+      put( ntk.fanout_size( node( n ) ) );
+    }
+    num_nodes = size;
+
+    /* the skipping reads whole words */
+    bytes.resize( bytes.size() + sizeof( uint64_t ), 0u );
+    bytes.shrink_to_fit();
+  }
+
+  frozen_storage( frozen_storage const& ) = delete;
+  frozen_storage& operator=( frozen_storage const& ) = delete;
+
+  frozen_storage( frozen_storage&& other ) noexcept
+    : id( std::exchange( other.id, next_id() ) )
+    , num_nodes( std::exchange( other.num_nodes, 0u ) )
+    , gates( std::exchange( other.gates, 0u ) )
+    , bytes( std::move( other.bytes ) )
+    , superblock_offsets( std::move( other.superblock_offsets ) )
+    , block_offsets( std::move( other.block_offsets ) )
+    , inputs( std::move( other.inputs ) )
+    , outputs( std::move( other.outputs ) )
+    , marks( other.marks.exchange( nullptr ) )
+    , epochs( other.epochs )
+  {}
+
+  ~frozen_storage()
+  {
+    delete[] marks.load();
+  }
+
+  /* decodes the record of `n` */
+  record node_record( uint32_t n ) const
+  {
+    assert( n < num_nodes );
+    thread_local std::array<cache_entry, cache_size> cache;
+    thread_local cursor last;
+    auto& entry = cache[n & ( cache_size - 1u )];
+    if ( entry.owner == id && entry.n == n )
+    {
+      return entry.r;
+    }
+
+    uint64_t offset;
+    if ( last.owner == id && last.n < n && n - last.n <= block_nodes )
+    {
+      offset = skip( last.offset, 3u * ( n - last.n - 1u ) );
+    }
+    else
+    {
+      offset = skip( superblock_offsets[n >> superblock_bits] + block_offsets[n >> block_bits], 3u * ( n & ( block_nodes - 1u ) ) );
+    }
+
+    record r;
+    r.kind = get( offset );
+    uint64_t const delta = get( offset );
+    r.ref_count = static_cast<uint32_t>( get( offset ) );
+    if ( r.is_gate() )
+    {
+      r.literals[1] = static_cast<uint32_t>( int64_t( 2u * uint64_t( n ) ) - unzigzag( r.kind ) );
+      r.literals[0] = static_cast<uint32_t>( int64_t( r.literals[1] ) - unzigzag( delta ) );
+    }
+    last = {id, n, offset};
+    entry = {id, n, r};
+    return r;
+  }
+
+  /* the marks, allocated on first use */
+  std::atomic<uint32_t>* node_marks() const
+  {
+    auto* m = marks.load( std::memory_order_acquire );
+    if ( m == nullptr )
+    {
+      auto* const fresh = new std::atomic<uint32_t>[num_nodes]();
+      if ( marks.compare_exchange_strong( m, fresh, std::memory_order_acq_rel ) )
+      {
+        m = fresh;
+      }
+      else
+      {
+        delete[] fresh;
+      }
+    }
+    return m;
+  }
+
+  /* bytes held by the storage, including the marks if allocated */
+  uint64_t num_bytes() const
+  {
+    uint64_t const m = marks.load( std::memory_order_acquire ) == nullptr ? 0u : uint64_t( num_nodes ) * sizeof( uint32_t );
+    return sizeof( *this ) + bytes.capacity() + superblock_offsets.capacity() * sizeof( uint64_t ) + block_offsets.capacity() * sizeof( uint16_t ) +
+           inputs.capacity() * sizeof( uint32_t ) + outputs.capacity() * sizeof( signal ) + m;
+  }
+
+private:
+  /* the last record decoded by a thread, and the offset after it */
+  struct cursor
+  {
+    uint64_t owner{0};
+    uint32_t n{0};
+    uint64_t offset{0};
+  }; /* cursor */
+
+  /* a direct-mapped cache of the records decoded by a thread */
+  struct cache_entry
+  {
+    uint64_t owner{0};
+    uint32_t n{0};
+    record r{};
+  }; /* cache_entry */
+
+  static constexpr uint32_t cache_size = 256u;
+
+  static uint64_t next_id()
+  {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+
+  static uint64_t zigzag( int64_t v )
+  {
+    return ( static_cast<uint64_t>( v ) << 1u ) ^ static_cast<uint64_t>( v >> 63u );
+  }
+
+  static int64_t unzigzag( uint64_t v )
+  {
+    return static_cast<int64_t>( v >> 1u ) ^ -static_cast<int64_t>( v & 1u );
+  }
+
+  void put( uint64_t v )
+  {
+    while ( v >= 0x80u )
+    {
+      bytes.emplace_back( static_cast<uint8_t>( v | 0x80u ) );
+      v >>= 7u;
+    }
+    bytes.emplace_back( static_cast<uint8_t>( v ) );
+  }
+
+  uint64_t get( uint64_t& offset ) const
+  {
+    uint64_t v{0};
+    uint32_t shift{0};
+    uint8_t b;
+    do
+    {
+      b = bytes[offset++];
+      v |= uint64_t( b & 0x7fu ) << shift;
+      shift += 7u;
+    } while ( b & 0x80u );
+    return v;
+  }
+
+  /* offset after the next `count` integers from `offset` */
+  uint64_t skip( uint64_t offset, uint64_t count ) const
+  {
+    if constexpr ( std::endian::native == std::endian::little )
+    {
+      while ( count != 0u )
+      {
+        uint64_t word;
+        std::memcpy( &word, bytes.data() + offset, sizeof( word ) );
+        uint64_t ends = ~word & 0x8080808080808080ull;
+        uint64_t const c = std::popcount( ends );
+        if ( c < count )
+        {
+          count -= c;
+          offset += sizeof( word );
+          continue;
+        }
+        while ( --count != 0u )
+        {
+          ends &= ends - 1u;
+        }
+        return offset + ( std::countr_zero( ends ) >> 3u ) + 1u;
+      }
+      return offset;
+    }
+    else
+    {
+      for ( ; count != 0u; --count )
+      {
+        while ( bytes[offset++] & 0x80u )
+        {
+        }
+      }
+      return offset;
+    }
+  }
+
+public:
+  uint64_t id; /* keys the decoding caches of the threads */
+  uint32_t num_nodes{0};
+  uint32_t gates{0};
+  std::vector<uint8_t> bytes;               /* the records */
+  std::vector<uint64_t> superblock_offsets; /* offset of the record of every 1024th node */
+  std::vector<uint16_t> block_offsets;      /* offset of every 8th record in its superblock */
+  std::vector<uint32_t> inputs;
+  std::vector<signal> outputs;
+  mutable std::atomic<std::atomic<uint32_t>*> marks{nullptr};
+  mutable epoch_table epochs;
+}; /* frozen_storage */
+
+/* A network on a `frozen_storage`.
+ *
+ * The network has the read API of `basic_network` (the same node
+ * indices, fanin order, reference counts, PIs, and POs as the network
+ * the storage was built from) and the traversal marks, so the cut and
+ * the simulation engines run on it unchanged.  It is a handle like
+ * `basic_network`: copies share the storage.
+ */
+class frozen_network
+{
+public:
+  explicit frozen_network( frozen_storage const& storage )
+    : storage_( &storage )
+  {}
+
+  node get_node( signal f ) const
+  {
+    return node( f.index );
+  }
+
+  signal make_signal( node n ) const
+  {
+    return signal( n, 0 );
+  }
+
+  bool is_complemented( signal f ) const
+  {
+    return f.complement;
+  }
+
+  bool is_constant( node n ) const
+  {
+    return n == 0;
+  }
+
+  bool is_pi( node n ) const
+  {
+    return n != 0u && storage_->node_record( n ).kind == 0u;
+  }
+
+  signal get_constant( bool value ) const
+  {
+    return {0, value};
+  }
+
+  template<typename Fn>
+  void foreach_node( Fn&& fn ) const
+  {
+    auto r = mockturtle::detail::range<uint32_t>( storage_->num_nodes );
+    for ( auto it = r.begin(); it != r.end(); ++it )
+    {
+      fn( aig::node( *it ) );
+    }
+  }
+
+  template<typename Fn>
+  void foreach_pi( Fn&& fn ) const
+  {
+    auto r = mockturtle::detail::range<uint32_t>( num_pis() );
+    mockturtle::detail::foreach_element_transform<decltype( r.begin() ), node>(
+        r.begin(), r.end(), [this]( auto i ) { return node( storage_->inputs[i] ); }, fn );
+  }
+
+  template<typename Fn>
+  void foreach_po( Fn&& fn ) const
+  {
+    mockturtle::detail::foreach_element( storage_->outputs.begin(), storage_->outputs.end(), fn );
+  }
+
+  template<typename Fn>
+  void foreach_fanin( node const& n, Fn&& fn ) const
+  {
+    auto const r = storage_->node_record( n );
+    if ( !r.is_gate() )
+    {
+      return;
+    }
+
+    static_assert( mockturtle::detail::is_callable_without_index_v<Fn, signal, bool> ||
+                   mockturtle::detail::is_callable_with_index_v<Fn, signal, bool> ||
+                   mockturtle::detail::is_callable_without_index_v<Fn, signal, void> ||
+                   mockturtle::detail::is_callable_with_index_v<Fn, signal, void> );
+
+    auto const fanin = [&]( uint32_t i ){
+      signal s;
+      s.data = r.literals[i];
+      return s;
+    };
+    if constexpr ( mockturtle::detail::is_callable_without_index_v<Fn, signal, bool> )
+    {
+      if ( !fn( fanin( 0u ) ) )
+        return;
+      fn( fanin( 1u ) );
+    }
+    else if constexpr ( mockturtle::detail::is_callable_with_index_v<Fn, signal, bool> )
+    {
+      if ( !fn( fanin( 0u ), 0 ) )
+        return;
+      fn( fanin( 1u ), 1 );
+    }
+    else if constexpr ( mockturtle::detail::is_callable_without_index_v<Fn, signal, void> )
+    {
+      fn( fanin( 0u ) );
+      fn( fanin( 1u ) );
+    }
+    else if constexpr ( mockturtle::detail::is_callable_with_index_v<Fn, signal, void> )
+    {
+      fn( fanin( 0u ), 0 );
+      fn( fanin( 1u ), 1 );
+    }
+  }
+
+  /* see `basic_network::check_and_mark` */
+  bool check_and_mark( node n, uint32_t token ) const
+  {
+    auto& m = storage_->node_marks()[n];
+    uint32_t current{m.load()};
+    while ( current != token )
+    {
+      if ( !storage_->epochs.is_stale( current ) )
+      {
+        AIG_COUNT( mark_conflicts );
+        return false;
+      }
+      if ( m.compare_exchange_strong( current, token ) )
+      {
+        return true;
+      }
+      AIG_COUNT( mark_cas_failures );
+    }
+    return true;
+  }
+
+  void reset_mark( node n ) const
+  {
+    if ( auto* const m = storage_->marks.load( std::memory_order_acquire ); m != nullptr )
+    {
+      m[n].store( 0u );
+    }
+  }
+
+  uint32_t mark( node n ) const
+  {
+    auto* const m = storage_->marks.load( std::memory_order_acquire );
+    return m == nullptr ? 0u : m[n].load();
+  }
+
+  uint32_t traversal_token( uint32_t thread_id ) const
+  {
+    return storage_->epochs.token( thread_id );
+  }
+
+  uint32_t release_marks( uint32_t thread_id ) const
+  {
+    return storage_->epochs.advance( thread_id, [this]( uint32_t id ){
+      if ( auto* const m = storage_->marks.load( std::memory_order_acquire ); m != nullptr )
+      {
+        clear_thread_marks( size(), id, [m]( uint64_t n ) -> auto& { return m[n]; } );
+      }
+    } );
+  }
+
+  /* clears all marks; must not run concurrently with any traversal */
+  void reset_marks() const
+  {
+    if ( auto* const m = storage_->marks.load( std::memory_order_acquire ); m != nullptr )
+    {
+      for ( uint32_t n = 0u; n < storage_->num_nodes; ++n )
+      {
+        m[n].store( 0u, std::memory_order_relaxed );
+      }
+    }
+  }
+
+  uint32_t size() const
+  {
+    return storage_->num_nodes;
+  }
+
+  uint32_t num_pis() const
+  {
+    return static_cast<uint32_t>( storage_->inputs.size() );
+  }
+
+  uint32_t num_pos() const
+  {
+    return static_cast<uint32_t>( storage_->outputs.size() );
+  }
+
+  uint32_t num_gates() const
+  {
+    return storage_->gates;
+  }
+
+  uint32_t fanin_size( node n ) const
+  {
+    return storage_->node_record( n ).is_gate() ? 2u : 0u;
+  }
+
+  uint32_t fanout_size( node n ) const
+  {
+    return storage_->node_record( n ).ref_count;
+  }
+
+  bool is_dead( node n ) const
+  {
+    return storage_->node_record( n ).kind == 1u;
+  }
+
+protected:
+  frozen_storage const* storage_;
+}; /* frozen_network */
+
+} /* aig */
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <initializer_list>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace aig
+{
+
+/* Event counts of the hot paths of network construction and cut
+ * enumeration, summed over threads (see `hot_path_counters`).
+ */
+struct hot_path_statistics
+{
+  /* `create_and` */
+  uint64_t strash_hits{0};
+  uint64_t strash_misses{0};    /* new gates */
+  uint64_t trivial_ands{0};     /* equal, complementary, or constant inputs */
+  uint64_t reused_slots{0};     /* new gates in the slots of dead nodes */
+  uint64_t strash_rehashes{0};  /* the strash table grew; the node store never relocates */
+
+  /* `check_and_mark` */
+  uint64_t mark_conflicts{0};     /* the node is owned by another thread */
+  uint64_t mark_cas_failures{0};  /* lost races for a stale mark */
+
+  /* `expand0` and `expand` */
+  uint64_t expand0_rounds{0};           /* passes over the leaves until the fix-point */
+  uint64_t expand_iterations{0};        /* leaves added by `select_next_fanin` */
+  uint64_t expand_conflicts{0};         /* expansions stopped by a node of another thread */
+  uint64_t max_iterations_bailouts{0};  /* expansions stopped after `MaxIterations` oversized cuts */
+  uint64_t cuts{0};
+  uint64_t cut_leaves{0};               /* summed over `cuts`, for the average cut size */
+
+  hot_path_statistics& operator+=( hot_path_statistics const& other )
+  {
+    strash_hits += other.strash_hits;
+    strash_misses += other.strash_misses;
+    trivial_ands += other.trivial_ands;
+    reused_slots += other.reused_slots;
+    strash_rehashes += other.strash_rehashes;
+    mark_conflicts += other.mark_conflicts;
+    mark_cas_failures += other.mark_cas_failures;
+    expand0_rounds += other.expand0_rounds;
+    expand_iterations += other.expand_iterations;
+    expand_conflicts += other.expand_conflicts;
+    max_iterations_bailouts += other.max_iterations_bailouts;
+    cuts += other.cuts;
+    cut_leaves += other.cut_leaves;
+    return *this;
+  }
+
+  void report( std::ostream& os ) const
+  {
+    os << "[i] create_and:     " << strash_hits << " strash hits, " << strash_misses << " misses, "
+       << trivial_ands << " trivial, " << reused_slots << " reused slots, " << strash_rehashes << " rehashes\n";
+    os << "[i] check_and_mark: " << mark_conflicts << " conflicts, " << mark_cas_failures << " CAS failures\n";
+    os << "[i] cut expansion:  " << cuts << " cuts, " << cut_leaves << " leaves, " << expand0_rounds << " expand0 rounds, "
+       << expand_iterations << " iterations, " << expand_conflicts << " conflicts, " << max_iterations_bailouts << " bailouts\n";
+  }
+}; /* hot_path_statistics */
+
+namespace detail
+{
+
+/* The counters of one thread, on cache lines of their own.
+ *
+ * Only the owning thread writes them, with a relaxed load and store
+ * instead of a read-modify-write; readers see a recent value.
+ */
+struct alignas( 64 ) thread_hot_path_counters
+{
+  using counter = std::atomic<uint64_t>;
+
+  counter strash_hits{0};
+  counter strash_misses{0};
+  counter trivial_ands{0};
+  counter reused_slots{0};
+  counter strash_rehashes{0};
+  counter mark_conflicts{0};
+  counter mark_cas_failures{0};
+  counter expand0_rounds{0};
+  counter expand_iterations{0};
+  counter expand_conflicts{0};
+  counter max_iterations_bailouts{0};
+  counter cuts{0};
+  counter cut_leaves{0};
+
+  static void add( counter& c, uint64_t value )
+  {
+    c.store( c.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+  }
+
+  void clear()
+  {
+    for ( counter* c : { &strash_hits, &strash_misses, &trivial_ands, &reused_slots, &strash_rehashes, &mark_conflicts, &mark_cas_failures,
+                         &expand0_rounds, &expand_iterations, &expand_conflicts, &max_iterations_bailouts, &cuts, &cut_leaves } )
+    {
+      c->store( 0u, std::memory_order_relaxed );
+    }
+  }
+}; /* thread_hot_path_counters */
+
+/* Counters of all threads that have counted.  The blocks of threads
+ * that have exited stay in the registry and in the totals.
+ */
+class hot_path_registry
+{
+public:
+  static hot_path_registry& instance()
+  {
+    /* never destroyed: threads may count during static destruction */
+    static hot_path_registry* const registry = new hot_path_registry();
+    return *registry;
+  }
+
+  thread_hot_path_counters& local()
+  {
+    thread_local thread_hot_path_counters* const counters = add_thread();
+    return *counters;
+  }
+
+  hot_path_statistics total()
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    hot_path_statistics sum;
+    for ( auto const& c : threads )
+    {
+      sum += snapshot( *c );
+    }
+    return sum;
+  }
+
+  /* events counted concurrently may get lost */
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    for ( auto& c : threads )
+    {
+      c->clear();
+    }
+  }
+
+private:
+  hot_path_registry() = default;
+
+  thread_hot_path_counters* add_thread()
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    return threads.emplace_back( std::make_unique<thread_hot_path_counters>() ).get();
+  }
+
+  static hot_path_statistics snapshot( thread_hot_path_counters const& c )
+  {
+    auto const get = []( thread_hot_path_counters::counter const& v ){
+      return v.load( std::memory_order_relaxed );
+    };
+    hot_path_statistics st;
+    st.strash_hits = get( c.strash_hits );
+    st.strash_misses = get( c.strash_misses );
+    st.trivial_ands = get( c.trivial_ands );
+    st.reused_slots = get( c.reused_slots );
+    st.strash_rehashes = get( c.strash_rehashes );
+    st.mark_conflicts = get( c.mark_conflicts );
+    st.mark_cas_failures = get( c.mark_cas_failures );
+    st.expand0_rounds = get( c.expand0_rounds );
+    st.expand_iterations = get( c.expand_iterations );
+    st.expand_conflicts = get( c.expand_conflicts );
+    st.max_iterations_bailouts = get( c.max_iterations_bailouts );
+    st.cuts = get( c.cuts );
+    st.cut_leaves = get( c.cut_leaves );
+    return st;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<std::unique_ptr<thread_hot_path_counters>> threads;
+}; /* hot_path_registry */
+
+} /* detail */
+
+/* Hot-path instrumentation, compiled in with `AIG_HOT_PATH_COUNTERS`
+ * (the CMake option of the same name).
+ *
+ * `AIG_COUNT( field )` and `AIG_COUNT_ADD( field, value )` count into
+ * the per-thread counters; without `AIG_HOT_PATH_COUNTERS` they expand
+ * to nothing and do not evaluate their arguments, so production
+ * binaries contain no trace of them.  `hot_path_counters()` sums the
+ * counters of all threads (all zero if disabled), and
+ * `reset_hot_path_counters()` restarts them.
+ */
+#ifdef AIG_HOT_PATH_COUNTERS
+inline constexpr bool hot_path_counters_enabled = true;
+#define AIG_COUNT_ADD( field, value ) \
+  ::aig::detail::thread_hot_path_counters::add( ::aig::detail::hot_path_registry::instance().local().field, ( value ) )
+#else
+inline constexpr bool hot_path_counters_enabled = false;
+#define AIG_COUNT_ADD( field, value ) ( (void)0 )
+#endif
+
+#define AIG_COUNT( field ) AIG_COUNT_ADD( field, 1u )
+
+inline hot_path_statistics hot_path_counters()
+{
+  if constexpr ( hot_path_counters_enabled )
+  {
+    return detail::hot_path_registry::instance().total();
+  }
+  else
+  {
+    return {};
+  }
+}
+
+inline void reset_hot_path_counters()
+{
+  if constexpr ( hot_path_counters_enabled )
+  {
+    detail::hot_path_registry::instance().reset();
+  }
+}
+
+} /* aig */
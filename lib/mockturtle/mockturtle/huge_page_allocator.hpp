@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace aig
+{
+
+enum class huge_page_size
+{
+  size_2mb = 21u, /* log2 of the page size */
+  size_1gb = 30u
+}; /* huge_page_size */
+
+enum class page_placement
+{
+  first_touch, /* the NUMA node of the thread that touches a page first */
+  interleave   /* round robin over the NUMA nodes the process may use */
+}; /* page_placement */
+
+/* Configuration of a `huge_page_allocator`.
+ *
+ * `Prefault` touches every page of a fresh mapping right away (on
+ * several threads for large mappings) instead of on first use, which
+ * moves the page faults of a growing network into `reserve`.  With
+ * `page_placement::first_touch`, prefaulted pages are spread over the
+ * NUMA nodes of the prefaulting threads.
+ */
+template<huge_page_size PageSize = huge_page_size::size_2mb, bool Prefault = false, page_placement Placement = page_placement::first_touch>
+struct huge_page_policy
+{
+  static constexpr uint32_t page_bits = static_cast<uint32_t>( PageSize );
+  static constexpr uint64_t page_bytes = uint64_t( 1 ) << page_bits;
+  static constexpr bool prefault = Prefault;
+  static constexpr page_placement placement = Placement;
+}; /* huge_page_policy */
+
+namespace detail
+{
+
+/* mappings of at least this size are prefaulted on several threads */
+inline constexpr uint64_t parallel_prefault_bytes = uint64_t( 64 ) << 20u;
+
+/* writes one byte per small page of fresh memory */
+inline void prefault_pages( void* p, uint64_t bytes )
+{
+  constexpr uint64_t stride = 4096u;
+  auto const touch = [p]( uint64_t begin, uint64_t end ){
+    volatile char* const data = static_cast<char*>( p );
+    for ( uint64_t i = begin; i < end; i += stride )
+    {
+      data[i] = 0;
+    }
+  };
+
+  uint64_t const num_threads = std::min<uint64_t>( std::max( 1u, std::thread::hardware_concurrency() ), bytes / parallel_prefault_bytes );
+  if ( num_threads <= 1u )
+  {
+    touch( 0u, bytes );
+    return;
+  }
+  uint64_t const share = ( bytes / num_threads + stride - 1u ) / stride * stride;
+  std::vector<std::thread> threads;
+  for ( uint64_t t = 1u; t < num_threads; ++t )
+  {
+    threads.emplace_back( touch, t * share, std::min( bytes, ( t + 1u ) * share ) );
+  }
+  touch( 0u, share );
+  for ( auto& t : threads )
+  {
+    t.join();
+  }
+}
+
+/* Maps `bytes` (a multiple of the page size) of zeroed memory.
+ *
+ * Tries pages of `page_bits` from the reserved huge pages of the
+ * system first; without them, falls back to small pages aligned to the
+ * huge page size, which the kernel may still back with transparent huge
+ * pages.  Returns nullptr if the memory cannot be mapped.
+ */
+template<typename Policy>
+void* map_pages( uint64_t bytes )
+{
+#ifdef __linux__
+  void* p = ::mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | ( Policy::page_bits << MAP_HUGE_SHIFT ), -1, 0 );
+  if ( p == MAP_FAILED )
+  {
+    void* const q = ::mmap( nullptr, bytes + Policy::page_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( q == MAP_FAILED )
+    {
+      return nullptr;
+    }
+
+    /* trim to an aligned range */
+    uintptr_t const begin = reinterpret_cast<uintptr_t>( q );
+    uintptr_t const aligned = ( begin + Policy::page_bytes - 1u ) & ~uintptr_t( Policy::page_bytes - 1u );
+    if ( aligned != begin )
+    {
+      ::munmap( q, aligned - begin );
+    }
+    if ( uint64_t const tail = Policy::page_bytes - ( aligned - begin ); tail != 0u )
+    {
+      ::munmap( reinterpret_cast<void*>( aligned + bytes ), tail );
+    }
+    p = reinterpret_cast<void*>( aligned );
+    ::madvise( p, bytes, MADV_HUGEPAGE );
+  }
+
+  if constexpr ( Policy::placement == page_placement::interleave )
+  {
+    /* MPOL_INTERLEAVE over the first 64 nodes, which the kernel restricts to the allowed ones */
+    constexpr int mpol_interleave = 3;
+    unsigned long const nodes = ~0ul;
+    ::syscall( SYS_mbind, p, bytes, mpol_interleave, &nodes, 8u * sizeof( nodes ) + 1u, 0u );
+  }
+#else
+  void* const p = ::operator new( bytes, std::align_val_t( 4096u ), std::nothrow );
+  if ( p == nullptr )
+  {
+    return nullptr;
+  }
+  std::fill_n( static_cast<char*>( p ), bytes, 0 );
+#endif
+
+  if constexpr ( Policy::prefault )
+  {
+    prefault_pages( p, bytes );
+  }
+  return p;
+}
+
+inline void unmap_pages( void* p, uint64_t bytes )
+{
+#ifdef __linux__
+  ::munmap( p, bytes );
+#else
+  (void)bytes;
+  ::operator delete( p, std::align_val_t( 4096u ) );
+#endif
+}
+
+/* Process-wide memory of one `huge_page_policy`.
+ *
+ * Blocks larger than half a huge page get their own mapping, rounded
+ * up to whole huge pages, which is unmapped when the block is freed.
+ * Smaller blocks from 4KB on are rounded up to a power of two and cut
+ * from shared chunks of huge pages; freed ones are kept in a free list
+ * per size for reuse and never returned to the system.  Anything
+ * smaller goes to `operator new`.  Thread-safe; the arena is never
+ * destroyed, so it outlives all static containers using it.
+ */
+template<typename Policy>
+class huge_page_arena
+{
+public:
+  static constexpr uint64_t min_block = 4096u;
+  static constexpr uint32_t min_block_bits = 12u;
+  static constexpr uint32_t num_classes = Policy::page_bits - 1u - min_block_bits + 1u;
+
+  static huge_page_arena& instance()
+  {
+    static huge_page_arena* const arena = new huge_page_arena();
+    return *arena;
+  }
+
+  void* allocate( uint64_t bytes )
+  {
+    if ( bytes < min_block )
+    {
+      return ::operator new( bytes );
+    }
+    if ( bytes > Policy::page_bytes / 2u )
+    {
+      void* const p = map_pages<Policy>( round_up( bytes ) );
+      if ( p == nullptr )
+      {
+        throw std::bad_alloc();
+      }
+      return p;
+    }
+
+    uint64_t const block = std::bit_ceil( bytes );
+    uint32_t const c = static_cast<uint32_t>( std::countr_zero( block ) ) - min_block_bits;
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( free_lists[c] != nullptr )
+    {
+      void* const p = free_lists[c];
+      free_lists[c] = *static_cast<void**>( p );
+      return p;
+    }
+    if ( end - cursor < block && !add_chunk( Policy::page_bytes ) )
+    {
+      throw std::bad_alloc();
+    }
+    void* const p = reinterpret_cast<void*>( cursor );
+    cursor += block;
+    return p;
+  }
+
+  void deallocate( void* p, uint64_t bytes )
+  {
+    if ( bytes < min_block )
+    {
+      ::operator delete( p );
+      return;
+    }
+    if ( bytes > Policy::page_bytes / 2u )
+    {
+      unmap_pages( p, round_up( bytes ) );
+      return;
+    }
+    std::lock_guard<std::mutex> lock( mutex );
+    push_free( p, std::bit_ceil( bytes ) );
+  }
+
+  /* maps (and prefaults) a chunk for `bytes` of upcoming small blocks at once */
+  void reserve( uint64_t bytes )
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( end - cursor < bytes )
+    {
+      add_chunk( round_up( bytes ) );
+    }
+  }
+
+private:
+  huge_page_arena() = default;
+
+  static uint64_t round_up( uint64_t bytes )
+  {
+    return ( bytes + Policy::page_bytes - 1u ) & ~( Policy::page_bytes - 1u );
+  }
+
+  void push_free( void* p, uint64_t block )
+  {
+    uint32_t const c = static_cast<uint32_t>( std::countr_zero( block ) ) - min_block_bits;
+    *static_cast<void**>( p ) = free_lists[c];
+    free_lists[c] = p;
+  }
+
+  /* moves to a fresh chunk; the rest of the current one goes to the free lists */
+  bool add_chunk( uint64_t bytes )
+  {
+    void* const p = map_pages<Policy>( bytes );
+    if ( p == nullptr )
+    {
+      return false;
+    }
+    while ( end - cursor >= min_block )
+    {
+      uint64_t const block = std::bit_floor( std::min( end - cursor, Policy::page_bytes / 2u ) );
+      push_free( reinterpret_cast<void*>( cursor ), block );
+      cursor += block;
+    }
+    cursor = reinterpret_cast<uintptr_t>( p );
+    end = cursor + bytes;
+    return true;
+  }
+
+private:
+  std::mutex mutex;
+  std::array<void*, num_classes> free_lists{};
+  uintptr_t cursor{0};
+  uintptr_t end{0};
+}; /* huge_page_arena */
+
+} /* detail */
+
+/* A stateless allocator that serves its memory from huge pages.
+ *
+ * All allocators of one `Policy` share a `detail::huge_page_arena`;
+ * large arrays (e.g., the slots of a strash table) get mappings of
+ * their own, and many smaller ones (e.g., the pages of a
+ * `segmented_vector`) share huge pages, so a traversal over them needs
+ * few TLB entries.  `reserve( n )` prepares a chunk for `n` more
+ * elements of small blocks, which `segmented_vector::reserve` uses to
+ * map (and prefault) the memory of all new pages at once.
+ */
+template<typename T, typename Policy = huge_page_policy<>>
+class huge_page_allocator
+{
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = huge_page_allocator<U, Policy>;
+  }; /* rebind */
+
+  huge_page_allocator() = default;
+
+  template<typename U>
+  huge_page_allocator( huge_page_allocator<U, Policy> const& ) noexcept
+  {}
+
+  T* allocate( std::size_t n )
+  {
+    static_assert( alignof( T ) <= alignof( std::max_align_t ) );
+    return static_cast<T*>( detail::huge_page_arena<Policy>::instance().allocate( n * sizeof( T ) ) );
+  }
+
+  void deallocate( T* p, std::size_t n ) noexcept
+  {
+    detail::huge_page_arena<Policy>::instance().deallocate( p, n * sizeof( T ) );
+  }
+
+  void reserve( uint64_t n )
+  {
+    detail::huge_page_arena<Policy>::instance().reserve( n * sizeof( T ) );
+  }
+
+  template<typename U>
+  bool operator==( huge_page_allocator<U, Policy> const& ) const noexcept
+  {
+    return true;
+  }
+}; /* huge_page_allocator */
+
+} /* aig */
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "aig.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace aig
+{
+
+/* bytes of one part of a storage that hold elements and that are allocated */
+struct memory_component
+{
+  uint64_t used{0};
+  uint64_t reserved{0};
+
+  memory_component& operator+=( memory_component const& other )
+  {
+    used += other.used;
+    reserved += other.reserved;
+    return *this;
+  }
+}; /* memory_component */
+
+/* Memory of a `basic_storage` by component.
+ *
+ * `nodes` reserves whole pages plus the page directories, `hash` the
+ * slots and control bytes of the strash table (`used` counts the
+ * occupied slots), and the vectors their capacity.  `slack()` is the
+ * reserved memory the storage can still grow into without allocating.
+ */
+struct storage_memory
+{
+  memory_component nodes;
+  memory_component hash;
+  memory_component inputs;
+  memory_component outputs;
+  memory_component free_nodes;
+
+  memory_component total() const
+  {
+    memory_component sum;
+    for ( memory_component const* c : { &nodes, &hash, &inputs, &outputs, &free_nodes } )
+    {
+      sum += *c;
+    }
+    return sum;
+  }
+
+  uint64_t slack() const
+  {
+    memory_component const sum = total();
+    return sum.reserved - sum.used;
+  }
+
+  void report( std::ostream& os ) const
+  {
+    auto const line = [&]( char const* name, memory_component const& c ){
+      os << "[i] " << name << c.used << " bytes used, " << c.reserved << " bytes reserved\n";
+    };
+    line( "nodes:      ", nodes );
+    line( "hash:       ", hash );
+    line( "inputs:     ", inputs );
+    line( "outputs:    ", outputs );
+    line( "free nodes: ", free_nodes );
+    line( "total:      ", total() );
+  }
+}; /* storage_memory */
+
+namespace detail
+{
+
+template<typename T>
+memory_component vector_memory( std::vector<T> const& v )
+{
+  return {v.size() * sizeof( T ), v.capacity() * sizeof( T )};
+}
+
+} /* detail */
+
+template<typename Allocator>
+storage_memory memory_usage( basic_storage<Allocator> const& storage )
+{
+  using storage_type = basic_storage<Allocator>;
+  using node_type = typename storage_type::node_type;
+
+  storage_memory m;
+  m.nodes.used = storage.nodes.size() * sizeof( node_type );
+  m.nodes.reserved = storage.nodes.capacity() * sizeof( node_type ) + storage.nodes.directory_bytes();
+  m.hash.used = storage.hash.size() * ( sizeof( uint32_t ) + 1u );
+  m.hash.reserved = storage_type::strash_table_bytes( storage.hash.capacity() );
+  m.inputs = detail::vector_memory( storage.inputs );
+  m.outputs = detail::vector_memory( storage.outputs );
+  m.free_nodes = detail::vector_memory( storage.free_nodes );
+  return m;
+}
+
+/* resident memory of the process and its peak, in bytes */
+struct process_memory
+{
+  uint64_t rss{0};
+  uint64_t peak_rss{0};
+}; /* process_memory */
+
+/* Reads `VmRSS` and `VmHWM` from /proc/self/status; elsewhere, only the
+ * peak is known (from `getrusage`) or nothing at all.
+ */
+inline process_memory process_memory_usage()
+{
+  process_memory m;
+#ifdef __linux__
+  if ( FILE* const file = std::fopen( "/proc/self/status", "r" ) )
+  {
+    char line[128];
+    while ( std::fgets( line, sizeof( line ), file ) != nullptr )
+    {
+      unsigned long long kb;
+      if ( std::strncmp( line, "VmRSS:", 6u ) == 0 && std::sscanf( line + 6, "%llu", &kb ) == 1 )
+      {
+        m.rss = kb * 1024u;
+      }
+      else if ( std::strncmp( line, "VmHWM:", 6u ) == 0 && std::sscanf( line + 6, "%llu", &kb ) == 1 )
+      {
+        m.peak_rss = kb * 1024u;
+      }
+    }
+    std::fclose( file );
+  }
+  if ( m.peak_rss == 0u )
+  {
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+      m.peak_rss = static_cast<uint64_t>( usage.ru_maxrss ) * 1024u;
+    }
+  }
+#endif
+  return m;
+}
+
+} /* aig */
@@ -0,0 +1,556 @@
+#pragma once
+
+#include "cut_function.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace aig
+{
+
+/* An NPN transformation of a function `f` of k <= 6 variables into the
+ * representative of its class:
+ *
+ *   representative( x ) = output_negated ^ f( y ),
+ *   y[permutation[i]] = x[i] ^ phase[permutation[i]]
+ *
+ * i.e., the inputs of `f` are complemented as in `phase` (bit `j` for
+ * variable `j` of `f`), variable `permutation[i]` of the result becomes
+ * variable `i`, and the output is complemented if `output_negated`.
+ * For a cut, leaf `permutation[i]` (complemented if its phase bit is
+ * set) drives input `i` of the representative.
+ */
+struct npn_class
+{
+  uint64_t representative{0}; /* lower 2^k bits */
+  std::array<uint8_t, 6u> permutation{0u, 1u, 2u, 3u, 4u, 5u};
+  uint8_t phase{0};
+  bool output_negated{false};
+}; /* npn_class */
+
+namespace detail
+{
+
+/* lower 2^k bits of a truth table word */
+constexpr uint64_t truth_table_mask( uint32_t num_vars )
+{
+  return num_vars == 6u ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << ( 1u << num_vars ) ) - 1u;
+}
+
+/* repeats the lower 2^k bits over the word, so variables k..5 do not matter */
+constexpr uint64_t replicate_truth_table( uint64_t tt, uint32_t num_vars )
+{
+  tt &= truth_table_mask( num_vars );
+  for ( uint32_t i = num_vars; i < 6u; ++i )
+  {
+    tt |= tt << ( 1u << i );
+  }
+  return tt;
+}
+
+/* complements variable `i` */
+constexpr uint64_t flip_variable( uint64_t tt, uint32_t i )
+{
+  uint32_t const shift = 1u << i;
+  return ( ( tt & projections[i] ) >> shift ) | ( ( tt & ~projections[i] ) << shift );
+}
+
+/* exchanges variables `i < j` (delta swap of the minterms in which they differ) */
+constexpr uint64_t swap_variables( uint64_t tt, uint32_t i, uint32_t j )
+{
+  assert( i < j );
+  uint64_t const mask = projections[i] & ~projections[j];
+  uint32_t const shift = ( 1u << j ) - ( 1u << i );
+  return ( tt & ~( mask | ( mask << shift ) ) ) | ( ( tt & mask ) << shift ) | ( ( tt >> shift ) & mask );
+}
+
+/* Adjacent transpositions (Steinhaus-Johnson-Trotter) that step
+ * through all k! permutations of k <= 6 elements: swapping positions
+ * `s` and `s + 1` for the k! - 1 entries `s` starting at
+ * `offsets[k]` visits every permutation once.
+ */
+struct permutation_swaps
+{
+  std::array<uint16_t, 8u> offsets{};
+  std::array<uint8_t, 1u + 1u + 2u + 6u + 24u + 120u + 720u> swaps{};
+}; /* permutation_swaps */
+
+constexpr permutation_swaps make_permutation_swaps()
+{
+  permutation_swaps table;
+  uint32_t fill{0};
+  for ( uint32_t k = 0u; k <= 6u; ++k )
+  {
+    table.offsets[k] = static_cast<uint16_t>( fill );
+    std::array<uint32_t, 6u> elements{};
+    std::array<int32_t, 6u> directions{};
+    for ( uint32_t i = 0u; i < k; ++i )
+    {
+      elements[i] = i;
+      directions[i] = -1;
+    }
+    while ( true )
+    {
+      /* largest element that is larger than its neighbor in its direction */
+      int32_t mobile{-1};
+      for ( uint32_t i = 0u; i < k; ++i )
+      {
+        int32_t const j = static_cast<int32_t>( i ) + directions[elements[i]];
+        if ( j >= 0 && j < static_cast<int32_t>( k ) && elements[j] < elements[i] &&
+             ( mobile < 0 || elements[i] > elements[mobile] ) )
+        {
+          mobile = static_cast<int32_t>( i );
+        }
+      }
+      if ( mobile < 0 )
+      {
+        break;
+      }
+      uint32_t const m = elements[mobile];
+      int32_t const j = mobile + directions[m];
+      table.swaps[fill++] = static_cast<uint8_t>( std::min( mobile, j ) );
+      std::swap( elements[mobile], elements[j] );
+      for ( uint32_t e = m + 1u; e < k; ++e )
+      {
+        directions[e] = -directions[e];
+      }
+    }
+  }
+  table.offsets[7] = static_cast<uint16_t>( fill );
+  return table;
+}
+
+inline constexpr permutation_swaps sjt_swaps = make_permutation_swaps();
+
+/* Exact NPN canonization by a restricted search.
+ *
+ * The representative is the smallest truth table among the members
+ * `h` of the class that are normalized: at most half of the minterms
+ * of `h` are ones, every variable has at least as many ones in its
+ * negative cofactor as in its positive one, and these cofactor counts
+ * are non-decreasing in the variable index.  The conditions only
+ * depend on `h`, so all members of a class have the same
+ * representative.  Most functions leave no choice but the sorting
+ * permutation; ties (a balanced output or variable, equal counts) are
+ * enumerated.  Within a group of equal counts, variables that can be
+ * exchanged without changing the function (symmetric variables, which
+ * form classes) yield the same tables in any order, so only the
+ * distinct arrangements of their classes are tried: a totally
+ * symmetric function such as parity needs one permutation per phase
+ * instead of k!.
+ */
+struct npn_search
+{
+  constexpr void permute_groups( uint64_t tt, std::array<uint8_t, 6u> perm, uint32_t g, uint8_t phase, bool output_negated )
+  {
+    if ( g == num_groups )
+    {
+      uint64_t const candidate = tt & mask;
+      if ( !found || candidate < best.representative )
+      {
+        found = true;
+        best.representative = candidate;
+        best.permutation = perm;
+        best.phase = phase;
+        best.output_negated = output_negated;
+      }
+      return;
+    }
+
+    uint32_t const begin = group_begin[g];
+    uint32_t const size = group_begin[g + 1u] - begin;
+    permute_groups( tt, perm, g + 1u, phase, output_negated );
+    for ( uint32_t i = sjt_swaps.offsets[size]; i < sjt_swaps.offsets[size + 1u]; ++i )
+    {
+      uint32_t const s = begin + sjt_swaps.swaps[i];
+      tt = swap_variables( tt, s, s + 1u );
+      std::swap( perm[s], perm[s + 1u] );
+      permute_groups( tt, perm, g + 1u, phase, output_negated );
+    }
+  }
+
+  /* `permute_groups` for the groups before `symmetric_groups`, taking
+   * the distinct arrangements of their symmetry classes; `classes[p]`
+   * is the class (its first position) of the variable at position `p`
+   */
+  constexpr void permute_classes( uint64_t tt, std::array<uint8_t, 6u> perm, std::array<uint8_t, 6u> classes, uint32_t g, uint8_t phase, bool output_negated )
+  {
+    if ( g == symmetric_groups )
+    {
+      permute_groups( tt, perm, g, phase, output_negated );
+      return;
+    }
+
+    /* the arrangements in lexicographic order, from the sorted one */
+    uint32_t const begin = group_begin[g];
+    uint32_t const end = group_begin[g + 1u];
+    std::array<uint8_t, 6u> next = classes;
+    for ( uint32_t i = begin + 1u; i < end; ++i )
+    {
+      for ( uint32_t j = i; j > begin && next[j - 1u] > next[j]; --j )
+      {
+        std::swap( next[j - 1u], next[j] );
+      }
+    }
+    do
+    {
+      for ( uint32_t p = begin; p < end; ++p )
+      {
+        uint32_t q = p;
+        while ( classes[q] != next[p] )
+        {
+          ++q;
+        }
+        if ( q != p )
+        {
+          tt = swap_variables( tt, p, q );
+          std::swap( perm[p], perm[q] );
+          std::swap( classes[p], classes[q] );
+        }
+      }
+      permute_classes( tt, perm, classes, g + 1u, phase, output_negated );
+    } while ( std::next_permutation( next.begin() + begin, next.begin() + end ) );
+  }
+
+  /* symmetry classes of `tt` within the groups, and the groups up to the last one with symmetric variables */
+  constexpr std::array<uint8_t, 6u> symmetry_classes( uint64_t tt )
+  {
+    std::array<uint8_t, 6u> classes{0u, 1u, 2u, 3u, 4u, 5u};
+    symmetric_groups = 0u;
+    for ( uint32_t g = 0u; g < num_groups; ++g )
+    {
+      for ( uint32_t q = group_begin[g] + 1u; q < group_begin[g + 1u]; ++q )
+      {
+        /* symmetry is transitive: comparing with the first variable of each class suffices */
+        for ( uint32_t p = group_begin[g]; p < q; ++p )
+        {
+          if ( classes[p] == p && swap_variables( tt, p, q ) == tt )
+          {
+            classes[q] = static_cast<uint8_t>( p );
+            symmetric_groups = g + 1u;
+            break;
+          }
+        }
+      }
+    }
+    return classes;
+  }
+
+  constexpr void search( uint64_t tt, bool output_negated )
+  {
+    /* phases forced by the cofactor counts, and the balanced variables */
+    uint32_t const ones = std::popcount( tt );
+    std::array<uint32_t, 6u> counts{};
+    uint8_t phase{0};
+    uint8_t balanced{0};
+    for ( uint32_t i = 0u; i < num_vars; ++i )
+    {
+      uint32_t const positive = std::popcount( tt & projections[i] );
+      uint32_t const negative = ones - positive;
+      if ( positive > negative )
+      {
+        tt = flip_variable( tt, i );
+        phase |= 1u << i;
+      }
+      else if ( positive == negative )
+      {
+        balanced |= 1u << i;
+      }
+      counts[i] = std::max( positive, negative );
+    }
+
+    /* variables by count (stable), and the groups of equal counts */
+    std::array<uint8_t, 6u> order{0u, 1u, 2u, 3u, 4u, 5u};
+    for ( uint32_t i = 1u; i < num_vars; ++i )
+    {
+      for ( uint32_t j = i; j > 0u && counts[order[j - 1u]] > counts[order[j]]; --j )
+      {
+        std::swap( order[j - 1u], order[j] );
+      }
+    }
+    num_groups = 0u;
+    for ( uint32_t i = 0u; i < num_vars; ++i )
+    {
+      if ( i == 0u || counts[order[i]] != counts[order[i - 1u]] )
+      {
+        group_begin[num_groups++] = i;
+      }
+    }
+    group_begin[num_groups] = num_vars;
+
+    /* every phase of the balanced variables */
+    uint8_t subset{0};
+    do
+    {
+      uint64_t h = tt;
+      for ( uint32_t i = 0u; i < num_vars; ++i )
+      {
+        if ( ( subset >> i ) & 1u )
+        {
+          h = flip_variable( h, i );
+        }
+      }
+      std::array<uint8_t, 6u> perm{0u, 1u, 2u, 3u, 4u, 5u};
+      for ( uint32_t i = 0u; i < num_vars; ++i )
+      {
+        uint32_t p = i;
+        while ( perm[p] != order[i] )
+        {
+          ++p;
+        }
+        if ( p != i )
+        {
+          h = swap_variables( h, i, p );
+          std::swap( perm[i], perm[p] );
+        }
+      }
+      std::array<uint8_t, 6u> const classes = symmetry_classes( h );
+      if ( symmetric_groups == 0u )
+      {
+        permute_groups( h, perm, 0u, phase | subset, output_negated );
+      }
+      else
+      {
+        permute_classes( h, perm, classes, 0u, phase | subset, output_negated );
+      }
+      subset = ( subset - balanced ) & balanced;
+    } while ( subset != 0u );
+  }
+
+  uint32_t num_vars{0};
+  uint64_t mask{0};
+  std::array<uint32_t, 7u> group_begin{};
+  uint32_t num_groups{0};
+  uint32_t symmetric_groups{0};
+  npn_class best;
+  bool found{false};
+}; /* npn_search */
+
+constexpr npn_class npn_canonize_search( uint64_t tt, uint32_t num_vars )
+{
+  assert( num_vars <= 6u );
+  npn_search s;
+  s.num_vars = num_vars;
+  s.mask = truth_table_mask( num_vars );
+
+  /* the output phase with at most half of the minterms being ones */
+  tt = replicate_truth_table( tt, num_vars );
+  uint32_t const ones = std::popcount( tt );
+  if ( ones <= 32u )
+  {
+    s.search( tt, false );
+  }
+  if ( ones >= 32u )
+  {
+    s.search( ~tt, true );
+  }
+  return s.best;
+}
+
+/* Table of the NPN classes of all functions of k <= 4 variables.
+ *
+ * Entry `tt` packs the representative (bits 0-15), the permutation
+ * (two bits per variable, bits 16-23), the phase (bits 24-27), the
+ * output phase (bit 28), and a fill marker (bit 31).  The table is
+ * filled class by class: the representative of the first unassigned
+ * function is found by `npn_canonize_search`, and each of its
+ * 2 * 2^k * k! transformations assigns the inverse transformation to
+ * the function it yields.
+ */
+template<uint32_t NumVars>
+using npn_table_type = std::array<uint32_t, ( 1u << ( 1u << NumVars ) )>;
+
+template<uint32_t NumVars>
+constexpr void fill_npn_table( npn_table_type<NumVars>& table )
+{
+  static_assert( NumVars <= 4u );
+  constexpr uint32_t size = 1u << ( 1u << NumVars );
+  constexpr uint32_t filled = 1u << 31u;
+  for ( uint32_t f = 0u; f < size; ++f )
+  {
+    if ( table[f] & filled )
+    {
+      continue;
+    }
+    uint64_t const representative = npn_canonize_search( f, NumVars ).representative;
+
+    /* members o ^ h( x ^ phase ) where h moves variable pos[i] to i */
+    uint64_t h = replicate_truth_table( representative, NumVars );
+    std::array<uint8_t, 6u> pos{0u, 1u, 2u, 3u, 4u, 5u};
+    uint32_t step = sjt_swaps.offsets[NumVars];
+    while ( true )
+    {
+      uint32_t encoded_perm{0};
+      for ( uint32_t i = 0u; i < NumVars; ++i )
+      {
+        encoded_perm |= i << ( 2u * pos[i] );
+      }
+      uint64_t g = h;
+      uint32_t phase{0};
+      for ( uint32_t k = 0u; k < ( 1u << NumVars ); ++k )
+      {
+        if ( k != 0u )
+        {
+          uint32_t const i = std::countr_zero( k );
+          g = flip_variable( g, i );
+          phase ^= 1u << i;
+        }
+        for ( uint32_t o = 0u; o < 2u; ++o )
+        {
+          uint32_t const member = static_cast<uint32_t>( ( o ? ~g : g ) & truth_table_mask( NumVars ) );
+          if ( !( table[member] & filled ) )
+          {
+            table[member] = filled | static_cast<uint32_t>( representative ) | ( encoded_perm << 16u ) | ( phase << 24u ) | ( o << 28u );
+          }
+        }
+      }
+      if ( step == sjt_swaps.offsets[NumVars + 1u] )
+      {
+        break;
+      }
+      uint32_t const s = sjt_swaps.swaps[step++];
+      h = swap_variables( h, s, s + 1u );
+      std::swap( pos[s], pos[s + 1u] );
+    }
+  }
+}
+
+template<uint32_t NumVars>
+constexpr npn_table_type<NumVars> make_npn_table()
+{
+  npn_table_type<NumVars> table{};
+  fill_npn_table<NumVars>( table );
+  return table;
+}
+
+/* not constexpr, so the compiler does not try to evaluate it for a static */
+template<uint32_t NumVars>
+npn_table_type<NumVars> make_npn_table_at_run_time()
+{
+  npn_table_type<NumVars> table{};
+  fill_npn_table<NumVars>( table );
+  return table;
+}
+
+/* The tables of up to three variables are generated at compile time;
+ * the one of four variables (65536 entries, 222 classes) exceeds what
+ * compilers evaluate in reasonable time and is generated on first use,
+ * in about a millisecond.
+ */
+template<uint32_t NumVars>
+npn_table_type<NumVars> const& npn_table()
+{
+  if constexpr ( NumVars <= 3u )
+  {
+    static constexpr npn_table_type<NumVars> table = make_npn_table<NumVars>();
+    return table;
+  }
+  else
+  {
+    static npn_table_type<NumVars> const table = make_npn_table_at_run_time<NumVars>();
+    return table;
+  }
+}
+
+template<uint32_t NumVars>
+npn_class npn_lookup( uint64_t tt )
+{
+  uint32_t const entry = npn_table<NumVars>()[tt & truth_table_mask( NumVars )];
+  npn_class c;
+  c.representative = entry & 0xffffu;
+  for ( uint32_t i = 0u; i < NumVars; ++i )
+  {
+    c.permutation[i] = static_cast<uint8_t>( ( entry >> ( 16u + 2u * i ) ) & 3u );
+  }
+  c.phase = static_cast<uint8_t>( ( entry >> 24u ) & 0xfu );
+  c.output_negated = ( entry >> 28u ) & 1u;
+  return c;
+}
+
+} /* detail */
+
+/* NPN class of the function `tt` (lower 2^k bits) of k <= 6 variables,
+ * e.g., of a cut computed by `cut_function`: functions of up to four
+ * variables are looked up in tables (see `detail::npn_table`), larger
+ * ones are canonized by the search of `detail::npn_search` (see there
+ * for the representative), which is also what the tables are built
+ * from.  Use an `npn_cache` to canonize many functions of five or six
+ * variables.
+ */
+inline npn_class npn_canonize( uint64_t tt, uint32_t num_vars )
+{
+  switch ( num_vars )
+  {
+  case 0u:
+    return detail::npn_lookup<0u>( tt );
+  case 1u:
+    return detail::npn_lookup<1u>( tt );
+  case 2u:
+    return detail::npn_lookup<2u>( tt );
+  case 3u:
+    return detail::npn_lookup<3u>( tt );
+  case 4u:
+    return detail::npn_lookup<4u>( tt );
+  default:
+    return detail::npn_canonize_search( tt, num_vars );
+  }
+}
+
+/* `npn_canonize` with the classes of five- and six-variable functions
+ * memoized by truth table.  Not thread-safe: use one cache per thread.
+ */
+class npn_cache
+{
+public:
+  npn_class canonize( uint64_t tt, uint32_t num_vars )
+  {
+    assert( num_vars <= 6u );
+    if ( num_vars <= 4u )
+    {
+      return npn_canonize( tt, num_vars );
+    }
+    tt &= detail::truth_table_mask( num_vars );
+    auto const [it, inserted] = classes[num_vars - 5u].try_emplace( tt );
+    if ( inserted )
+    {
+      ++misses;
+      it->second = detail::npn_canonize_search( tt, num_vars );
+    }
+    else
+    {
+      ++hits;
+    }
+    return it->second;
+  }
+
+  void clear()
+  {
+    for ( auto& c : classes )
+    {
+      c.clear();
+    }
+  }
+
+  uint64_t num_hits() const
+  {
+    return hits;
+  }
+
+  uint64_t num_misses() const
+  {
+    return misses;
+  }
+
+private:
+  std::array<phmap::flat_hash_map<uint64_t, npn_class>, 2u> classes;
+  uint64_t hits{0};
+  uint64_t misses{0};
+}; /* npn_cache */
+
+} /* aig */
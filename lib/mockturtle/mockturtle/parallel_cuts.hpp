@@ -0,0 +1,345 @@
+#pragma once
+
+#include "aig.hpp"
+#include "cut.hpp"
+#include "foreach.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+namespace aig
+{
+
+/* One cut per node, stored contiguously; the cut of node `n` is `leaves[offsets[n], offsets[n + 1])` */
+class cut_set
+{
+public:
+  std::span<node const> cut( node n ) const
+  {
+    assert( n + 1u < offsets.size() );
+    return {leaves.data() + offsets[n], leaves.data() + offsets[n + 1u]};
+  }
+
+  uint64_t num_nodes() const
+  {
+    return offsets.empty() ? 0u : offsets.size() - 1u;
+  }
+
+  uint64_t num_leaves() const
+  {
+    return leaves.size();
+  }
+
+  std::vector<uint64_t> offsets;
+  std::vector<node> leaves;
+  bool complete{true}; /* false if the enumeration was stopped; the nodes it skipped have empty cuts */
+}; /* cut_set */
+
+struct parallel_cuts_params
+{
+  /* nodes per task of the parallel loops (adaptive if 0) */
+  uint64_t grain{0u};
+
+  /* compute every cut with private marks instead of the shared ones */
+  bool deterministic{false};
+
+  /* once a stop is requested (e.g., by a `sandbox::cancellation_scope`), the remaining nodes are skipped */
+  std::stop_token stop{};
+}; /* parallel_cuts_params */
+
+namespace detail
+{
+
+/* cuts computed by one worker, in the order they were finished */
+struct alignas( 64 ) cut_arena
+{
+  std::vector<node> roots;
+  std::vector<uint32_t> sizes;
+  std::vector<node> leaves;
+  std::vector<node> retry; /* roots that were owned by another worker */
+  uint32_t token{0};
+}; /* cut_arena */
+
+template<uint32_t SizeLimit, uint32_t MaxIterations, typename Ntk>
+void compute_cut_into( Ntk const& aig, node n, uint32_t owner, cut_arena& arena )
+{
+  auto const cut = create_static_cut<SizeLimit, MaxIterations>( aig, n, arena.token );
+  if ( cut.empty() )
+  {
+    arena.retry.push_back( n );
+    return;
+  }
+
+  arena.roots.push_back( n );
+  arena.sizes.push_back( cut.size() );
+  arena.leaves.insert( arena.leaves.end(), cut.begin(), cut.end() );
+
+  /* drop the claims on the cone in O(1) */
+  arena.token = release_cuts( aig, owner );
+}
+
+/* merges the cuts of all arenas into one `cut_set` in node order */
+inline cut_set merge_cut_arenas( std::vector<cut_arena> const& arenas, uint32_t num_nodes )
+{
+  cut_set result;
+  std::vector<std::span<node const>> cuts( num_nodes );
+  uint64_t num_leaves{0};
+  for ( auto const& a : arenas )
+  {
+    uint64_t offset{0};
+    for ( uint64_t i = 0; i < a.roots.size(); ++i )
+    {
+      cuts[a.roots[i]] = {a.leaves.data() + offset, a.sizes[i]};
+      offset += a.sizes[i];
+    }
+    num_leaves += a.leaves.size();
+  }
+
+  result.offsets.resize( num_nodes + 1u );
+  result.leaves.reserve( num_leaves );
+  for ( uint32_t n = 0; n < num_nodes; ++n )
+  {
+    result.offsets[n] = result.leaves.size();
+    result.leaves.insert( result.leaves.end(), cuts[n].begin(), cuts[n].end() );
+  }
+  result.offsets[num_nodes] = result.leaves.size();
+  return result;
+}
+
+/* A network whose marks are private to one worker.
+ *
+ * The marks live in a small open-addressing table instead of the
+ * nodes, so claims never fail and a cut does not depend on what other
+ * workers are doing.  Every entry carries the epoch it was made in, so
+ * `release_marks` forgets all of them in O(1), like the shared marks.
+ */
+template<typename Ntk>
+class alignas( 64 ) private_marks_view : public Ntk
+{
+public:
+  explicit private_marks_view( Ntk const& ntk )
+    : Ntk( ntk )
+    , entries_( 256u )
+  {}
+
+  bool check_and_mark( node n, uint32_t token ) const
+  {
+    token_ = token;
+    entry& e = find( n );
+    if ( e.epoch != epoch_ )
+    {
+      e = {n, epoch_};
+      if ( 2u * ++size_ > entries_.size() )
+      {
+        grow();
+      }
+    }
+    return true;
+  }
+
+  void reset_mark( node n ) const
+  {
+    if ( entry& e = find( n ); e.epoch == epoch_ )
+    {
+      e.index = removed; /* keeps the probe sequences of the other entries intact */
+    }
+  }
+
+  uint32_t mark( node n ) const
+  {
+    return find( n ).epoch == epoch_ ? token_ : 0u;
+  }
+
+  uint32_t release_marks( uint32_t thread_id ) const
+  {
+    if ( ++epoch_ == 0u )
+    {
+      std::fill( entries_.begin(), entries_.end(), entry{} );
+      epoch_ = 1u;
+    }
+    size_ = 0u;
+    return thread_id;
+  }
+
+private:
+  struct entry
+  {
+    uint32_t index{0};
+    uint32_t epoch{0}; /* 0 = never used */
+  }; /* entry */
+
+  static constexpr uint32_t removed = ~uint32_t( 0 );
+
+  /* the entry of `n`, or the free entry where it would go */
+  entry& find( uint32_t n ) const
+  {
+    uint64_t const mask = entries_.size() - 1u;
+    /* Fibonacci hashing spreads consecutive indices */
+    for ( uint64_t i = ( ( n * 0x9e3779b97f4a7c15ull ) >> 32u ) & mask;; i = ( i + 1u ) & mask )
+    {
+      entry& e = entries_[i];
+      if ( e.epoch != epoch_ || e.index == n )
+      {
+        return e;
+      }
+    }
+  }
+
+  void grow() const
+  {
+    std::vector<entry> old( 2u * entries_.size() );
+    old.swap( entries_ );
+    size_ = 0u;
+    for ( entry const& e : old )
+    {
+      if ( e.epoch == epoch_ && e.index != removed )
+      {
+        find( e.index ) = e;
+        ++size_;
+      }
+    }
+  }
+
+  mutable std::vector<entry> entries_; /* a power of two, at most half full */
+  mutable uint64_t size_{0};
+  mutable uint32_t epoch_{1};
+  mutable uint32_t token_{0};
+}; /* private_marks_view */
+
+template<uint32_t SizeLimit, uint32_t MaxIterations, typename Ntk, typename TaskManager>
+void deterministic_cuts( Ntk const& aig, TaskManager& tm, uint64_t grain, std::stop_token const& stop, std::atomic<bool>& stopped, std::vector<cut_arena>& arenas )
+{
+  std::vector<private_marks_view<Ntk>> views( arenas.size(), private_marks_view<Ntk>( aig ) );
+  for ( uint32_t i = 0; i < arenas.size(); ++i )
+  {
+    arenas[i].token = i + 1u;
+  }
+  tm.parallel_for( mockturtle::detail::range<uint32_t>( 1u, static_cast<uint32_t>( aig.size() ) ), grain, [&]( uint32_t i ){
+    if ( stop.stop_requested() )
+    {
+      stopped.store( true, std::memory_order_relaxed );
+      return;
+    }
+    uint64_t const index = tm.worker_index();
+    compute_cut_into<SizeLimit, MaxIterations>( views[index], node( i ), index + 1u, arenas[index] );
+  });
+}
+
+} /* detail */
+
+/* Computes a reconvergence-driven cut (see `create_static_cut`) for every node of `aig` on the workers of `tm`.
+ *
+ * Worker `i` of `tm` owns the nodes it visits under the ownership id
+ * `i + 1`; the calling thread, which helps while waiting, uses
+ * `num_workers() + 1`.  Each worker writes its cuts into a private
+ * arena.  A root that another worker is holding is set aside and
+ * retried after the parallel pass, first in parallel and the
+ * remainder on the calling thread, where no claim can fail.  The
+ * arenas are merged into one `cut_set` indexed by node at the end.
+ *
+ * Which cuts are cut short by a claim of another worker depends on
+ * the timing.  With `ps.deterministic`, every worker uses private
+ * marks instead (see `detail::private_marks_view`): nothing is claimed
+ * in the network, no root is retried, and the cut of every node is
+ * the one `create_cut` computes on an otherwise idle network.  The
+ * result is then identical for any number of workers.  Either way,
+ * the cuts are returned in node order.
+ *
+ * Once `ps.stop` is requested, the chunks still queued skip their
+ * nodes, no root is retried, and the cuts finished so far are returned
+ * with `complete` unset, so a deadline stops the enumeration within
+ * about one cut per worker.
+ *
+ * The constant node gets an empty cut.  `tm` must have fewer than
+ * `epoch_table::max_threads - 1` workers and `aig` must not be
+ * traversed by anyone else meanwhile.
+ */
+template<uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u, typename Ntk, typename TaskManager>
+cut_set parallel_cuts( Ntk const& aig, TaskManager& tm, parallel_cuts_params const& ps )
+{
+  uint64_t const num_workers = tm.num_workers();
+  assert( num_workers + 1u < epoch_table::max_threads );
+  uint64_t const grain = ps.grain;
+  uint32_t const num_nodes = static_cast<uint32_t>( aig.size() );
+
+  std::vector<detail::cut_arena> arenas( num_workers + 1u );
+  std::atomic<bool> stopped{false}; /* some node was skipped */
+  if ( ps.deterministic )
+  {
+    detail::deterministic_cuts<SizeLimit, MaxIterations>( aig, tm, grain, ps.stop, stopped, arenas );
+    cut_set result = detail::merge_cut_arenas( arenas, num_nodes );
+    result.complete = !stopped.load();
+    return result;
+  }
+  for ( uint32_t i = 0; i < arenas.size(); ++i )
+  {
+    /* start from a fresh epoch, so marks left over from earlier traversals are free */
+    arenas[i].token = aig.release_marks( i + 1u );
+  }
+
+  auto const visit = [&]( node n ){
+    if ( ps.stop.stop_requested() )
+    {
+      stopped.store( true, std::memory_order_relaxed );
+      return;
+    }
+    uint64_t const index = tm.worker_index();
+    detail::compute_cut_into<SizeLimit, MaxIterations>( aig, n, index + 1u, arenas[index] );
+  };
+
+  tm.parallel_for( mockturtle::detail::range<uint32_t>( 1u, num_nodes ), grain, [&]( uint32_t i ){
+    visit( node( i ) );
+  });
+
+  /* one parallel round for the roots that were taken, then finish them here */
+  std::vector<node> retry;
+  for ( auto& a : arenas )
+  {
+    retry.insert( retry.end(), a.retry.begin(), a.retry.end() );
+    a.retry.clear();
+  }
+  tm.parallel_for( mockturtle::detail::range<uint64_t>( retry.size() ), grain, [&]( uint64_t i ){
+    visit( retry[i] );
+  });
+
+  auto& self = arenas[num_workers];
+  for ( auto& a : arenas )
+  {
+    retry.assign( a.retry.begin(), a.retry.end() );
+    a.retry.clear();
+    for ( node const& n : retry )
+    {
+      if ( ps.stop.stop_requested() )
+      {
+        stopped.store( true, std::memory_order_relaxed );
+        break;
+      }
+      detail::compute_cut_into<SizeLimit, MaxIterations>( aig, n, num_workers + 1u, self );
+      assert( self.retry.empty() );
+    }
+  }
+
+  for ( uint32_t i = 0; i < arenas.size(); ++i )
+  {
+    aig.release_marks( i + 1u );
+  }
+  cut_set result = detail::merge_cut_arenas( arenas, num_nodes );
+  result.complete = !stopped.load();
+  return result;
+}
+
+/* same as above, with `ps.grain = grain` */
+template<uint32_t SizeLimit = 6u, uint32_t MaxIterations = 5u, typename Ntk, typename TaskManager>
+cut_set parallel_cuts( Ntk const& aig, TaskManager& tm, uint64_t grain = 0u )
+{
+  parallel_cuts_params ps;
+  ps.grain = grain;
+  return parallel_cuts<SizeLimit, MaxIterations>( aig, tm, ps );
+}
+
+} /* aig */
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aig
+{
+
+enum class traversal_order
+{
+  unordered,  /* chunks of node indices, in any order */
+  topological /* level by level: a node after all of its fanins */
+}; /* traversal_order */
+
+/* The live nodes of a network grouped by level: the nodes of level `l`
+ * are `nodes[offsets[l], offsets[l + 1])`, in ascending order.  Level
+ * 0 holds the constant and the PIs.
+ */
+struct level_frontiers
+{
+  std::span<node const> frontier( uint32_t l ) const
+  {
+    assert( l + 1u < offsets.size() );
+    return {nodes.data() + offsets[l], nodes.data() + offsets[l + 1u]};
+  }
+
+  uint32_t num_levels() const
+  {
+    return offsets.empty() ? 0u : static_cast<uint32_t>( offsets.size() - 1u );
+  }
+
+  std::vector<uint64_t> offsets;
+  std::vector<node> nodes;
+}; /* level_frontiers */
+
+/* frontiers smaller than this are traversed on the calling thread */
+inline constexpr uint64_t min_parallel_frontier = 256u;
+
+/* Groups the live nodes of `ntk` by level (counting sort).
+ *
+ * The levels come from `ntk.level` if the network has them (e.g., a
+ * `fanout_level_view`), and are computed otherwise; the computation
+ * does not rely on the nodes being in topological index order.
+ */
+template<typename Ntk>
+level_frontiers compute_level_frontiers( Ntk const& ntk )
+{
+  uint32_t const size = ntk.size();
+  constexpr uint32_t unknown = ~uint32_t( 0 );
+  std::vector<uint32_t> levels( size, unknown );
+  if constexpr ( requires { ntk.level( node( 0u ) ); } )
+  {
+    for ( uint32_t n = 0u; n < size; ++n )
+    {
+      levels[n] = ntk.level( node( n ) );
+    }
+  }
+  else
+  {
+    /* a node waits on the stack for fanins with a larger index */
+    std::vector<uint32_t> stack;
+    for ( uint32_t n = 0u; n < size; ++n )
+    {
+      stack.push_back( n );
+      while ( !stack.empty() )
+      {
+        uint32_t const g = stack.back();
+        if ( levels[g] != unknown )
+        {
+          stack.pop_back();
+          continue;
+        }
+        uint32_t l{0};
+        bool ready{true};
+        ntk.foreach_fanin( node( g ), [&]( signal const& f ){
+          if ( levels[f.index] == unknown )
+          {
+            stack.push_back( f.index );
+            ready = false;
+          }
+          l = std::max( l, levels[f.index] + 1u );
+        } );
+        if ( ready )
+        {
+          levels[g] = l;
+          stack.pop_back();
+        }
+      }
+    }
+  }
+
+  level_frontiers frontiers;
+  uint32_t depth{0};
+  for ( uint32_t n = 0u; n < size; ++n )
+  {
+    if ( !ntk.is_dead( node( n ) ) )
+    {
+      depth = std::max( depth, levels[n] );
+    }
+  }
+  frontiers.offsets.assign( depth + 2u, 0u );
+  for ( uint32_t n = 0u; n < size; ++n )
+  {
+    if ( !ntk.is_dead( node( n ) ) )
+    {
+      ++frontiers.offsets[levels[n] + 1u];
+    }
+  }
+  for ( uint32_t l = 1u; l < frontiers.offsets.size(); ++l )
+  {
+    frontiers.offsets[l] += frontiers.offsets[l - 1u];
+  }
+  frontiers.nodes.resize( frontiers.offsets.back() );
+  std::vector<uint64_t> fill( frontiers.offsets.begin(), frontiers.offsets.end() - 1 );
+  for ( uint32_t n = 0u; n < size; ++n )
+  {
+    if ( !ntk.is_dead( node( n ) ) )
+    {
+      frontiers.nodes[fill[levels[n]]++] = node( n );
+    }
+  }
+  return frontiers;
+}
+
+/* topological traversal over precomputed frontiers of `ntk` */
+template<typename Ntk, typename TaskManager, typename Fn>
+void foreach_node_parallel( Ntk const& ntk, TaskManager& tm, level_frontiers const& frontiers, Fn&& fn, uint64_t grain = 0u )
+{
+  assert( frontiers.nodes.size() <= ntk.size() );
+  (void)ntk;
+  for ( uint32_t l = 0u; l < frontiers.num_levels(); ++l )
+  {
+    auto const frontier = frontiers.frontier( l );
+    if ( frontier.size() < min_parallel_frontier )
+    {
+      /* a round trip through the workers costs more than it saves */
+      for ( node const n : frontier )
+      {
+        fn( n );
+      }
+      continue;
+    }
+    tm.parallel_for( mockturtle::detail::range<uint64_t>( frontier.size() ), grain, [&]( uint64_t i ){
+      fn( frontier[i] );
+    } );
+  }
+}
+
+/* Calls `fn( n )` for every live node `n` of `ntk` (the nodes of
+ * `foreach_node` without the dead ones) on the workers of `tm`, e.g., a
+ * `bounded_depth_task_manager`, and waits for all calls to finish.
+ *
+ * `traversal_order::unordered` splits the node indices into chunks of
+ * `grain` (adaptive if 0).  `traversal_order::topological` visits the
+ * nodes level by level (see `compute_level_frontiers`), with a barrier
+ * after each level, so `fn( n )` runs after `fn` has returned for all
+ * fanins of `n` and may read what they wrote.  Callers that traverse
+ * the same network repeatedly can compute the frontiers once and use
+ * the overload above.  `fn` must be safe to run concurrently on
+ * different nodes.
+ */
+template<typename Ntk, typename TaskManager, typename Fn>
+void foreach_node_parallel( Ntk const& ntk, TaskManager& tm, Fn&& fn, traversal_order order = traversal_order::unordered, uint64_t grain = 0u )
+{
+  if ( order == traversal_order::topological )
+  {
+    foreach_node_parallel( ntk, tm, compute_level_frontiers( ntk ), fn, grain );
+    return;
+  }
+  tm.parallel_for( mockturtle::detail::range<uint32_t>( ntk.size() ), grain, [&]( uint32_t n ){
+    if ( !ntk.is_dead( node( n ) ) )
+    {
+      fn( node( n ) );
+    }
+  } );
+}
+
+} /* aig */
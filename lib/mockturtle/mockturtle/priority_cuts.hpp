@@ -0,0 +1,321 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aig
+{
+
+/* A k-feasible cut with its leaves in ascending order and a 64-bit leaf signature */
+template<uint32_t MaxLeaves>
+struct priority_cut
+{
+  uint64_t signature{0};
+  uint32_t cost{0};
+  uint32_t num_leaves{0};
+  std::array<node, MaxLeaves> leaves{};
+
+  uint32_t size() const
+  {
+    return num_leaves;
+  }
+
+  node const* begin() const
+  {
+    return leaves.data();
+  }
+
+  node const* end() const
+  {
+    return leaves.data() + num_leaves;
+  }
+
+  static uint64_t signature_of( node n )
+  {
+    return uint64_t( 1u ) << ( n & 63u );
+  }
+
+  /* true if the leaves of `this` are a subset of the leaves of `other` */
+  bool dominates( priority_cut const& other ) const
+  {
+    if ( num_leaves > other.num_leaves || ( signature & other.signature ) != signature )
+    {
+      return false;
+    }
+    return std::includes( other.begin(), other.end(), begin(), end() );
+  }
+}; /* priority_cut */
+
+struct priority_cuts_params
+{
+  /* maximum number of leaves of a cut (at most `MaxLeaves`) */
+  uint32_t cut_size{4u};
+
+  /* maximum number of cuts per node, including the trivial cut */
+  uint32_t cut_limit{8u};
+}; /* priority_cuts_params */
+
+/* default ranking: smaller cuts first */
+struct cut_size_cost
+{
+  template<typename Ntk, typename Cut>
+  uint32_t operator()( Ntk const& ntk, Cut const& cut ) const
+  {
+    (void)ntk;
+    return cut.size();
+  }
+}; /* cut_size_cost */
+
+/* Bottom-up enumeration of the best k-feasible cuts of every node.
+ *
+ * The cuts of an AND gate are the pairwise merges of the cuts of its
+ * fanins with at most `cut_size` leaves.  A merge is skipped early if
+ * the union of the leaf signatures has too many bits; a new cut is
+ * dropped if an existing cut dominates it (subset test, pre-checked on
+ * the signatures) and it removes the cuts it dominates.  The cuts are
+ * ranked by `Cost` (lower is better, ties broken by size and leaves,
+ * so the result does not depend on the evaluation order); each node
+ * keeps the best `cut_limit - 1` cuts followed by its trivial cut.
+ *
+ * All cuts live in one arena with `cut_limit` slots per node.  `run( tm )`
+ * processes the nodes level by level on the workers of `tm`: the
+ * nodes of one level only read the cuts of lower levels and only
+ * write their own slots.
+ */
+template<typename Ntk, uint32_t MaxLeaves = 6u, typename Cost = cut_size_cost>
+class priority_cuts
+{
+public:
+  using cut_type = priority_cut<MaxLeaves>;
+
+  explicit priority_cuts( Ntk const& ntk, priority_cuts_params const& ps = {}, Cost cost = {} )
+    : ntk( ntk )
+    , ps( ps )
+    , cost( cost )
+  {
+    assert( ps.cut_size > 0u && ps.cut_size <= MaxLeaves );
+    assert( ps.cut_limit > 1u );
+  }
+
+  /* computes the cuts of all nodes in topological order */
+  void run()
+  {
+    initialize();
+    for ( uint32_t n = 1u; n < ntk.size(); ++n )
+    {
+      compute( node( n ) );
+    }
+  }
+
+  /* computes the cuts of all nodes level by level on the workers of `tm` */
+  template<typename TaskManager>
+  void run( TaskManager& tm, uint64_t grain = 0u )
+  {
+    initialize();
+
+    /* bucket the nodes by level (counting sort) */
+    uint32_t const num_nodes = ntk.size();
+    std::vector<uint32_t> levels( num_nodes, 0u );
+    uint32_t depth{0};
+    for ( uint32_t n = 1u; n < num_nodes; ++n )
+    {
+      ntk.foreach_fanin( node( n ), [&]( signal const& fi ){
+        levels[n] = std::max( levels[n], levels[fi.index] + 1u );
+      });
+      depth = std::max( depth, levels[n] );
+    }
+
+    std::vector<uint32_t> offsets( depth + 2u, 0u );
+    for ( uint32_t n = 1u; n < num_nodes; ++n )
+    {
+      ++offsets[levels[n] + 1u];
+    }
+    for ( uint32_t l = 1u; l < offsets.size(); ++l )
+    {
+      offsets[l] += offsets[l - 1u];
+    }
+    std::vector<uint32_t> order( offsets.back() );
+    std::vector<uint32_t> fill( offsets.begin(), offsets.end() - 1 );
+    for ( uint32_t n = 1u; n < num_nodes; ++n )
+    {
+      order[fill[levels[n]]++] = n;
+    }
+
+    for ( uint32_t l = 0u; l <= depth; ++l )
+    {
+      tm.parallel_for( mockturtle::detail::range<uint32_t>( offsets[l], offsets[l + 1u] ), grain, [&]( uint32_t i ){
+        compute( node( order[i] ) );
+      });
+    }
+  }
+
+  /* cuts of `n`, best first; the trivial cut comes last */
+  std::span<cut_type const> cuts( node n ) const
+  {
+    return {arena.data() + uint64_t( n ) * ps.cut_limit, counts[n]};
+  }
+
+  uint64_t num_cuts() const
+  {
+    uint64_t total{0};
+    for ( auto const c : counts )
+    {
+      total += c;
+    }
+    return total;
+  }
+
+private:
+  void initialize()
+  {
+    arena.assign( uint64_t( ntk.size() ) * ps.cut_limit, cut_type{} );
+    counts.assign( ntk.size(), 0u );
+
+    /* the constant has one empty cut */
+    counts[0] = 1u;
+  }
+
+  cut_type* slots( node n )
+  {
+    return arena.data() + uint64_t( n ) * ps.cut_limit;
+  }
+
+  static bool better( cut_type const& a, cut_type const& b )
+  {
+    if ( a.cost != b.cost )
+    {
+      return a.cost < b.cost;
+    }
+    if ( a.num_leaves != b.num_leaves )
+    {
+      return a.num_leaves < b.num_leaves;
+    }
+    return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end() );
+  }
+
+  /* merges the sorted leaves of `a` and `b` into `result`; fails if the union exceeds `cut_size` */
+  bool merge( cut_type const& a, cut_type const& b, cut_type& result ) const
+  {
+    if ( std::popcount( a.signature | b.signature ) > static_cast<int>( ps.cut_size ) )
+    {
+      return false;
+    }
+
+    uint32_t i{0}, j{0}, k{0};
+    while ( i < a.num_leaves || j < b.num_leaves )
+    {
+      if ( k == ps.cut_size )
+      {
+        return false;
+      }
+
+      if ( j == b.num_leaves || ( i < a.num_leaves && a.leaves[i] < b.leaves[j] ) )
+      {
+        result.leaves[k++] = a.leaves[i++];
+      }
+      else if ( i == a.num_leaves || b.leaves[j] < a.leaves[i] )
+      {
+        result.leaves[k++] = b.leaves[j++];
+      }
+      else
+      {
+        result.leaves[k++] = a.leaves[i++];
+        ++j;
+      }
+    }
+    result.num_leaves = k;
+    result.signature = a.signature | b.signature;
+    return true;
+  }
+
+  /* inserts `cut` into the `count` sorted cuts at `set` (capacity `limit`) unless it is dominated */
+  void insert( cut_type* set, uint32_t& count, uint32_t limit, cut_type const& cut ) const
+  {
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+      if ( set[i].dominates( cut ) )
+      {
+        return;
+      }
+    }
+
+    /* remove the cuts that `cut` dominates */
+    uint32_t kept{0};
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+      if ( !cut.dominates( set[i] ) )
+      {
+        set[kept++] = set[i];
+      }
+    }
+    count = kept;
+
+    if ( count == limit && !better( cut, set[count - 1u] ) )
+    {
+      return;
+    }
+
+    uint32_t pos = std::min( count, limit - 1u );
+    while ( pos > 0u && better( cut, set[pos - 1u] ) )
+    {
+      set[pos] = set[pos - 1u];
+      --pos;
+    }
+    set[pos] = cut;
+    count = std::min( count + 1u, limit );
+  }
+
+  void compute( node n )
+  {
+    cut_type* set = slots( n );
+    uint32_t count{0};
+
+    if ( !ntk.is_pi( n ) )
+    {
+      std::array<node, 2u> fanins{};
+      ntk.foreach_fanin( n, [&]( signal const& fi, uint32_t i ){
+        fanins[i] = ntk.get_node( fi );
+      });
+
+      for ( auto const& ca : cuts( fanins[0] ) )
+      {
+        for ( auto const& cb : cuts( fanins[1] ) )
+        {
+          cut_type merged;
+          if ( !merge( ca, cb, merged ) )
+          {
+            continue;
+          }
+          merged.cost = cost( ntk, merged );
+          insert( set, count, ps.cut_limit - 1u, merged );
+        }
+      }
+    }
+
+    /* trivial cut */
+    cut_type& trivial = set[count++];
+    trivial.num_leaves = 1u;
+    trivial.leaves[0] = n;
+    trivial.signature = cut_type::signature_of( n );
+    trivial.cost = cost( ntk, trivial );
+    counts[n] = count;
+  }
+
+private:
+  Ntk const& ntk;
+  priority_cuts_params const ps;
+  Cost cost;
+
+  std::vector<cut_type> arena;
+  std::vector<uint32_t> counts;
+}; /* priority_cuts */
+
+} /* aig */
@@ -0,0 +1,510 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+/* Epoch-based reclamation for one writer and many readers.
+ *
+ * A reader `pin`s a slot with the current epoch before it loads any
+ * shared pointer and `unpin`s it when done.  The writer `retire`s a
+ * buffer after it has published its replacement; the buffer is freed
+ * once every pinned slot carries a later epoch, i.e., no reader can
+ * still hold a pointer to it.  Pinning is wait-free unless all
+ * `max_readers` slots are taken; `retire` and `reclaim` are for the
+ * writer only.
+ */
+class epoch_reclaimer
+{
+public:
+  static constexpr uint32_t max_readers = 128u;
+
+  epoch_reclaimer() = default;
+  epoch_reclaimer( epoch_reclaimer const& ) = delete;
+  epoch_reclaimer& operator=( epoch_reclaimer const& ) = delete;
+
+  ~epoch_reclaimer()
+  {
+    assert( std::all_of( slots.begin(), slots.end(), []( slot const& s ){ return s.epoch.load() == 0u; } ) );
+    for ( auto& r : retired )
+    {
+      r.deleter( r.pointer );
+    }
+  }
+
+  /* returns the slot pinned for the calling reader */
+  uint32_t pin()
+  {
+    uint32_t i = static_cast<uint32_t>( std::hash<std::thread::id>{}( std::this_thread::get_id() ) % max_readers );
+    while ( true )
+    {
+      uint64_t expected{0};
+      if ( slots[i].epoch.compare_exchange_strong( expected, epoch.load() ) )
+      {
+        return i;
+      }
+      i = ( i + 1u ) % max_readers;
+      if ( i == 0u )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void unpin( uint32_t i )
+  {
+    slots[i].epoch.store( 0u, std::memory_order_release );
+  }
+
+  /* frees `pointer` with `deleter` once no reader can hold it anymore */
+  void retire( void* pointer, void ( *deleter )( void* ) )
+  {
+    retired.push_back( {pointer, deleter, epoch.fetch_add( 1u )} );
+    reclaim();
+  }
+
+  /* frees the retired buffers no reader can hold anymore */
+  void reclaim()
+  {
+    uint64_t oldest = ~uint64_t( 0 );
+    for ( auto const& s : slots )
+    {
+      if ( uint64_t const e = s.epoch.load(); e != 0u )
+      {
+        oldest = std::min( oldest, e );
+      }
+    }
+    auto const it = std::partition( retired.begin(), retired.end(), [&]( retired_buffer const& r ){ return r.epoch >= oldest; } );
+    for ( auto i = it; i != retired.end(); ++i )
+    {
+      i->deleter( i->pointer );
+    }
+    retired.erase( it, retired.end() );
+  }
+
+  uint64_t num_retired() const
+  {
+    return retired.size();
+  }
+
+private:
+  struct alignas( 64 ) slot
+  {
+    std::atomic<uint64_t> epoch{0}; /* 0 if free */
+  }; /* slot */
+
+  struct retired_buffer
+  {
+    void* pointer;
+    void ( *deleter )( void* );
+    uint64_t epoch; /* the epoch it was replaced in */
+  }; /* retired_buffer */
+
+  std::atomic<uint64_t> epoch{1};
+  std::array<slot, max_readers> slots;
+  std::vector<retired_buffer> retired; /* writer only */
+}; /* epoch_reclaimer */
+
+namespace detail
+{
+
+/* An array that the writer appends to while readers access a prefix.
+ *
+ * Growing copies the elements into a buffer of twice the capacity,
+ * publishes it, and retires the old one to `reclaimer`.  A reader that
+ * loads `size` before `data` finds at least `size` elements in the
+ * buffer it gets, whichever buffer that is.
+ */
+template<typename T>
+class rcu_array
+{
+public:
+  explicit rcu_array( epoch_reclaimer& reclaimer )
+    : reclaimer( reclaimer )
+  {}
+
+  rcu_array( rcu_array const& ) = delete;
+  rcu_array& operator=( rcu_array const& ) = delete;
+
+  ~rcu_array()
+  {
+    delete[] data.load();
+  }
+
+  void push_back( T const& value )
+  {
+    uint64_t const n = count.load( std::memory_order_relaxed );
+    T* buffer = data.load( std::memory_order_relaxed );
+    if ( n == capacity )
+    {
+      T* const grown = new T[capacity = std::max<uint64_t>( 64u, 2u * capacity )];
+      std::copy( buffer, buffer + n, grown );
+      data.store( grown );
+      if ( buffer != nullptr )
+      {
+        reclaimer.retire( buffer, []( void* p ){ delete[] static_cast<T*>( p ); } );
+      }
+      buffer = grown;
+    }
+    buffer[n] = value;
+    count.store( n + 1u, std::memory_order_release );
+  }
+
+  uint64_t size() const
+  {
+    return count.load( std::memory_order_acquire );
+  }
+
+  /* only valid while the caller is pinned */
+  T const* pinned_data() const
+  {
+    return data.load();
+  }
+
+private:
+  epoch_reclaimer& reclaimer;
+  std::atomic<T*> data{nullptr};
+  std::atomic<uint64_t> count{0};
+  uint64_t capacity{0};
+}; /* rcu_array */
+
+} /* detail */
+
+template<typename Storage>
+class basic_rcu_network;
+
+/* A consistent read-only view of a `basic_rcu_network` at one point in time.
+ *
+ * The view covers the first `size()` nodes and the PIs and POs that
+ * existed when it was pinned; all of them are final, since the writer
+ * only appends.  The exception are the reference counts, which are
+ * read atomically and include fanouts added later.  The view has the
+ * read API of `basic_network` and the traversal marks of the storage,
+ * so the simulation and cut engines run on it while the network
+ * grows; it is a handle valid while its `basic_rcu_network::reader`
+ * lives, and copies share the pin.
+ */
+template<typename Storage>
+class basic_pinned_network
+{
+public:
+  node get_node( signal f ) const
+  {
+    return node( f.index );
+  }
+
+  signal make_signal( node n ) const
+  {
+    return signal( n, 0 );
+  }
+
+  bool is_complemented( signal f ) const
+  {
+    return f.complement;
+  }
+
+  bool is_constant( node n ) const
+  {
+    return n == 0;
+  }
+
+  bool is_pi( node n ) const
+  {
+    auto const& fanins = storage_->node_fanins( n );
+    return fanins[0].data == fanins[1].data && fanins[0].data < num_pis_;
+  }
+
+  signal get_constant( bool value ) const
+  {
+    return {0, value};
+  }
+
+  template<typename Fn>
+  void foreach_node( Fn&& fn ) const
+  {
+    auto r = mockturtle::detail::range<uint32_t>( num_nodes_ );
+    for ( auto it = r.begin(); it != r.end(); ++it )
+    {
+      fn( aig::node( *it ) );
+    }
+  }
+
+  template<typename Fn>
+  void foreach_pi( Fn&& fn ) const
+  {
+    auto r = mockturtle::detail::range<uint32_t>( num_pis_ );
+    mockturtle::detail::foreach_element_transform<decltype( r.begin() ), node>(
+        r.begin(), r.end(), [this]( auto i ) { return node( inputs_[i] ); }, fn );
+  }
+
+  template<typename Fn>
+  void foreach_po( Fn&& fn ) const
+  {
+    mockturtle::detail::foreach_element<signal const*, signal>( outputs_, outputs_ + num_pos_, fn );
+  }
+
+  template<typename Fn>
+  void foreach_fanin( node const& n, Fn&& fn ) const
+  {
+    basic_network<Storage>( *storage_ ).foreach_fanin( n, std::forward<Fn>( fn ) );
+  }
+
+  /* see `basic_network::check_and_mark` */
+  bool check_and_mark( node n, uint32_t token ) const
+  {
+    return basic_network<Storage>( *storage_ ).check_and_mark( n, token );
+  }
+
+  void reset_mark( node n ) const
+  {
+    storage_->node_mark( n ).store( 0u );
+  }
+
+  uint32_t mark( node n ) const
+  {
+    return storage_->node_mark( n ).load();
+  }
+
+  uint32_t traversal_token( uint32_t thread_id ) const
+  {
+    return storage_->epochs.token( thread_id );
+  }
+
+  /* on a wrap-around of the epochs, clears the marks of `thread_id` in this view */
+  uint32_t release_marks( uint32_t thread_id ) const
+  {
+    return storage_->epochs.advance( thread_id, [this]( uint32_t id ){
+      clear_thread_marks( num_nodes_, id, [this]( uint64_t n ) -> decltype( auto ) { return storage_->node_mark( n ); } );
+    } );
+  }
+
+  uint32_t size() const
+  {
+    return num_nodes_;
+  }
+
+  uint32_t num_pis() const
+  {
+    return num_pis_;
+  }
+
+  uint32_t num_pos() const
+  {
+    return num_pos_;
+  }
+
+  uint32_t num_gates() const
+  {
+    return num_nodes_ - num_pis_ - 1u - num_dead_;
+  }
+
+  uint32_t fanin_size( node n ) const
+  {
+    auto const& fanins = storage_->node_fanins( n );
+    return fanins[0].data == fanins[1].data ? 0u : 2u;
+  }
+
+  uint32_t fanout_size( node n ) const
+  {
+    return std::atomic_ref<uint32_t>( storage_->node_ref_count( n ) ).load( std::memory_order_relaxed );
+  }
+
+  bool is_dead( node n ) const
+  {
+    return storage_->node_fanins( n )[0].data == basic_network<Storage>::dead_fanin;
+  }
+
+private:
+  friend class basic_rcu_network<Storage>;
+
+  basic_pinned_network( Storage& storage_ )
+    : storage_( &storage_ )
+  {}
+
+  Storage* storage_;
+  uint32_t const* inputs_{nullptr};
+  signal const* outputs_{nullptr};
+  uint32_t num_nodes_{0};
+  uint32_t num_pis_{0};
+  uint32_t num_pos_{0};
+  uint32_t num_dead_{0};
+}; /* basic_pinned_network */
+
+/* A construction session with one writer and concurrent readers.
+ *
+ * The writer thread builds into `storage` through the session (PIs,
+ * strashed AND gates, POs) while analysis threads take `reader`s, each
+ * pinning a `basic_pinned_network` that stays consistent and valid
+ * however far the writer gets; neither side blocks the other.  The
+ * node pages of the storage never move and new gates are always
+ * appended (dead slots are not reused), so only the PI and PO lists
+ * need copies: they are mirrored into arrays that grow by
+ * read-copy-update, and an old array is freed by the
+ * `epoch_reclaimer` once every reader that pinned it has left.
+ * Reference counts are updated through `std::atomic_ref`.
+ *
+ * The storage itself (including `inputs`, `outputs`, and `hash`) is
+ * updated as by `basic_network`, but must only be accessed through the
+ * session while readers exist.  All readers must be gone before the
+ * session is destroyed.  Works with every storage layout.
+ */
+template<typename Storage>
+class basic_rcu_network
+{
+public:
+  /* pins the current state of the network until destroyed */
+  class reader
+  {
+  public:
+    explicit reader( basic_rcu_network& session )
+      : session( session )
+      , slot( session.reclaimer.pin() )
+      , view( session.storage_ )
+    {
+      /* POs first: the nodes they refer to are published before them */
+      view.num_pos_ = static_cast<uint32_t>( session.outputs.size() );
+      view.outputs_ = session.outputs.pinned_data();
+      view.num_nodes_ = session.num_nodes.load( std::memory_order_acquire );
+
+      /* PIs last: every PI below `num_nodes_` is listed before it is published, later ones are cut off (PI indices increase) */
+      uint32_t num_pis = static_cast<uint32_t>( session.inputs.size() );
+      view.inputs_ = session.inputs.pinned_data();
+      while ( num_pis > 0u && view.inputs_[num_pis - 1u] >= view.num_nodes_ )
+      {
+        --num_pis;
+      }
+      view.num_pis_ = num_pis;
+      view.num_dead_ = session.num_dead;
+    }
+
+    reader( reader const& ) = delete;
+    reader& operator=( reader const& ) = delete;
+
+    ~reader()
+    {
+      session.reclaimer.unpin( slot );
+    }
+
+    basic_pinned_network<Storage> const& network() const
+    {
+      return view;
+    }
+
+  private:
+    basic_rcu_network& session;
+    uint32_t slot;
+    basic_pinned_network<Storage> view;
+  }; /* reader */
+
+  explicit basic_rcu_network( Storage& storage_ )
+    : storage_( storage_ )
+    , inputs( reclaimer )
+    , outputs( reclaimer )
+    , num_nodes( static_cast<uint32_t>( storage_.num_nodes() ) )
+    , num_dead( static_cast<uint32_t>( storage_.free_nodes.size() ) )
+  {
+    for ( uint32_t const pi : storage_.inputs )
+    {
+      inputs.push_back( pi );
+    }
+    for ( signal const& po : storage_.outputs )
+    {
+      outputs.push_back( po );
+    }
+  }
+
+  basic_rcu_network( basic_rcu_network const& ) = delete;
+  basic_rcu_network& operator=( basic_rcu_network const& ) = delete;
+
+  signal get_constant( bool value ) const
+  {
+    return {0, value};
+  }
+
+  signal create_not( signal a ) const
+  {
+    return !a;
+  }
+
+  signal create_pi()
+  {
+    uint32_t const index = storage_.add_node();
+    storage_.inputs.emplace_back( index );
+    inputs.push_back( index ); /* before the node is published, see `reader` */
+    num_nodes.store( index + 1u, std::memory_order_release );
+    return {index, 0};
+  }
+
+  /* like `basic_network::create_and`, but always appends a new gate */
+  signal create_and( signal a, signal b )
+  {
+    if ( a.index > b.index )
+    {
+      std::swap( a, b );
+    }
+
+    if ( a.index == b.index )
+    {
+      return ( a.complement == b.complement ) ? a : get_constant( false );
+    }
+    else if ( a.index == 0 )
+    {
+      return a.complement ? b : get_constant( false );
+    }
+
+    if ( auto const it = storage_.hash.find( fanin_key( a, b ) ); it != storage_.hash.end() )
+    {
+      return {*it, 0};
+    }
+
+    uint32_t const index = storage_.add_node( {a, b} );
+    storage_.hash.insert( index );
+    std::atomic_ref<uint32_t>( storage_.node_ref_count( a.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+    std::atomic_ref<uint32_t>( storage_.node_ref_count( b.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+    num_nodes.store( index + 1u, std::memory_order_release );
+    return {index, 0};
+  }
+
+  void create_po( signal const& f )
+  {
+    std::atomic_ref<uint32_t>( storage_.node_ref_count( f.index ) ).fetch_add( 1u, std::memory_order_relaxed );
+    storage_.outputs.emplace_back( f.index, f.complement );
+    outputs.push_back( f );
+  }
+
+  /* number of nodes published so far */
+  uint32_t size() const
+  {
+    return num_nodes.load( std::memory_order_relaxed );
+  }
+
+  /* frees the retired PI and PO arrays that no reader can hold anymore */
+  void reclaim()
+  {
+    reclaimer.reclaim();
+  }
+
+private:
+  Storage& storage_;
+  epoch_reclaimer reclaimer; /* declared before the arrays, which retire to it */
+  detail::rcu_array<uint32_t> inputs;
+  detail::rcu_array<signal> outputs;
+  std::atomic<uint32_t> num_nodes;
+  uint32_t const num_dead; /* dead slots, which the session never reuses */
+}; /* basic_rcu_network */
+
+using rcu_network = basic_rcu_network<storage>;
+
+} /* aig */
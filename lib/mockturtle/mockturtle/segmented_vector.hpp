@@ -0,0 +1,453 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+/* A vector of fixed-size pages that never relocates its elements.
+ *
+ * An index is split into a page number (upper bits) and an offset into
+ * the page (lower `PageBits` bits).  Appending only allocates a new
+ * page every `page_size` elements: memory grows in small steps,
+ * references stay valid, and readers may access elements below
+ * `size()` while a single writer keeps appending.
+ *
+ * The page directory starts empty and doubles when a page does not
+ * fit.  A reader may still hold a replaced directory, which stays
+ * valid (it points to the same pages) until the vector is destroyed;
+ * all directories together take less than twice the last one.  An
+ * empty or moved-from vector allocates nothing.
+ *
+ * Pages are value-initialized when they are allocated, hence `T` has
+ * to be default-constructible.  They come from `Allocator`, which has
+ * to be stateless; if it has a `reserve( n )` member (see
+ * `huge_page_allocator`), `reserve` announces the elements of the new
+ * pages with it before allocating them.
+ */
+template<typename T, uint32_t PageBits = 10u, uint64_t MaxSize = ( 1ull << 31u ), typename Allocator = std::allocator<T>>
+class segmented_vector
+{
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = uint64_t;
+  using reference = T&;
+  using const_reference = T const&;
+
+  static constexpr uint64_t page_size = 1ull << PageBits;
+  static constexpr uint64_t max_pages = ( MaxSize + page_size - 1u ) >> PageBits;
+
+  template<bool Const>
+  class basic_iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, T const*, T*>;
+    using reference = std::conditional_t<Const, T const&, T&>;
+    using container = std::conditional_t<Const, segmented_vector const, segmented_vector>;
+
+    basic_iterator() = default;
+
+    basic_iterator( container* v, uint64_t index )
+      : v( v )
+      , index( index )
+    {}
+
+    reference operator*() const
+    {
+      return ( *v )[index];
+    }
+
+    pointer operator->() const
+    {
+      return &( *v )[index];
+    }
+
+    reference operator[]( difference_type n ) const
+    {
+      return ( *v )[index + n];
+    }
+
+    basic_iterator& operator++()
+    {
+      ++index;
+      return *this;
+    }
+
+    basic_iterator operator++( int )
+    {
+      auto tmp = *this;
+      ++index;
+      return tmp;
+    }
+
+    basic_iterator& operator--()
+    {
+      --index;
+      return *this;
+    }
+
+    basic_iterator operator--( int )
+    {
+      auto tmp = *this;
+      --index;
+      return tmp;
+    }
+
+    basic_iterator& operator+=( difference_type n )
+    {
+      index += n;
+      return *this;
+    }
+
+    basic_iterator& operator-=( difference_type n )
+    {
+      index -= n;
+      return *this;
+    }
+
+    friend basic_iterator operator+( basic_iterator it, difference_type n )
+    {
+      return it += n;
+    }
+
+    friend basic_iterator operator+( difference_type n, basic_iterator it )
+    {
+      return it += n;
+    }
+
+    friend basic_iterator operator-( basic_iterator it, difference_type n )
+    {
+      return it -= n;
+    }
+
+    friend difference_type operator-( basic_iterator const& a, basic_iterator const& b )
+    {
+      return static_cast<difference_type>( a.index ) - static_cast<difference_type>( b.index );
+    }
+
+    friend bool operator==( basic_iterator const& a, basic_iterator const& b )
+    {
+      return a.index == b.index;
+    }
+
+    friend auto operator<=>( basic_iterator const& a, basic_iterator const& b )
+    {
+      return a.index <=> b.index;
+    }
+
+  private:
+    container* v{nullptr};
+    uint64_t index{0};
+  }; /* basic_iterator */
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  segmented_vector() = default;
+
+  segmented_vector( segmented_vector const& other )
+    : segmented_vector()
+  {
+    *this = other;
+  }
+
+  /* `other` is left empty */
+  segmented_vector( segmented_vector&& other ) noexcept
+  {
+    take( other );
+  }
+
+  segmented_vector& operator=( segmented_vector const& other )
+  {
+    if ( this != &other )
+    {
+      clear();
+      reserve( other.size() );
+      for ( uint64_t i = 0; i < other.size(); ++i )
+      {
+        ( *this )[i] = other[i];
+      }
+      count.store( other.size(), std::memory_order_release );
+    }
+    return *this;
+  }
+
+  segmented_vector& operator=( segmented_vector&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      release_pages();
+      take( other );
+    }
+    return *this;
+  }
+
+  ~segmented_vector()
+  {
+    release_pages();
+  }
+
+  /* acquires the directory, which may be newer than the element (its entries were copied under `mutex`) */
+  T& operator[]( uint64_t index )
+  {
+    return directory.load( std::memory_order_acquire )[index >> PageBits].load( std::memory_order_relaxed )[index & ( page_size - 1u )];
+  }
+
+  T const& operator[]( uint64_t index ) const
+  {
+    return directory.load( std::memory_order_acquire )[index >> PageBits].load( std::memory_order_relaxed )[index & ( page_size - 1u )];
+  }
+
+  T& back()
+  {
+    return ( *this )[size() - 1u];
+  }
+
+  T const& back() const
+  {
+    return ( *this )[size() - 1u];
+  }
+
+  uint64_t size() const
+  {
+    return count.load( std::memory_order_acquire );
+  }
+
+  bool empty() const
+  {
+    return size() == 0u;
+  }
+
+  uint64_t capacity() const
+  {
+    return num_pages * page_size;
+  }
+
+  /* bytes of the page directories */
+  uint64_t directory_bytes() const
+  {
+    uint64_t bytes = directory_size * sizeof( std::atomic<T*> );
+    for ( auto const& d : old_directories )
+    {
+      bytes += d.second * sizeof( std::atomic<T*> );
+    }
+    return bytes;
+  }
+
+  /* bytes of the directory that allocating the next page adds (replaced directories are kept) */
+  uint64_t directory_growth_bytes() const
+  {
+    return num_pages < directory_size ? 0u : grown_directory_size( num_pages + 1u ) * sizeof( std::atomic<T*> );
+  }
+
+  /* allocates the pages for `n` elements up front */
+  void reserve( uint64_t n )
+  {
+    assert( n <= max_pages * page_size );
+    if constexpr ( requires( Allocator a ) { a.reserve( uint64_t{} ); } )
+    {
+      if ( capacity() < n )
+      {
+        Allocator().reserve( ( ( n + page_size - 1u ) >> PageBits << PageBits ) - capacity() );
+      }
+    }
+    while ( capacity() < n )
+    {
+      allocate_page( num_pages );
+      ++num_pages;
+    }
+  }
+
+  void resize( uint64_t n )
+  {
+    reserve( n );
+    for ( uint64_t i = size(); i < n; ++i )
+    {
+      ( *this )[i] = T();
+    }
+    count.store( n, std::memory_order_release );
+  }
+
+  template<typename... Args>
+  T& emplace_back( Args&&... args )
+  {
+    uint64_t const index = size();
+    reserve( index + 1u );
+    T& slot = ( *this )[index];
+    slot = T( std::forward<Args>( args )... );
+    count.store( index + 1u, std::memory_order_release );
+    return slot;
+  }
+
+  void push_back( T const& value )
+  {
+    emplace_back( value );
+  }
+
+  /* removes all elements; the pages are kept for reuse */
+  void clear()
+  {
+    count.store( 0u, std::memory_order_release );
+  }
+
+  /* Slot `index` beyond `size()`, allocating its page if needed.
+   *
+   * Safe to call from many threads at the same time (pages are
+   * installed under a lock); the slots become elements through `adopt`.
+   */
+  T& slot( uint64_t index )
+  {
+    assert( index < max_pages * page_size );
+    uint64_t const p = index >> PageBits;
+    /* the size first: a directory loaded after it has at least as many entries */
+    if ( p >= published_size.load( std::memory_order_acquire ) || directory.load( std::memory_order_acquire )[p].load( std::memory_order_acquire ) == nullptr )
+    {
+      /* once per page */
+      allocate_page( p );
+    }
+    return ( *this )[index];
+  }
+
+  /* makes the slots in [size(), n) written through `slot` elements; not thread-safe */
+  void adopt( uint64_t n )
+  {
+    std::atomic<T*> const* d = directory.load( std::memory_order_acquire );
+    while ( num_pages < directory_size && d[num_pages].load( std::memory_order_relaxed ) != nullptr )
+    {
+      ++num_pages;
+    }
+    assert( n <= capacity() );
+    count.store( n, std::memory_order_release );
+  }
+
+  iterator begin()
+  {
+    return {this, 0u};
+  }
+
+  iterator end()
+  {
+    return {this, size()};
+  }
+
+  const_iterator begin() const
+  {
+    return {this, 0u};
+  }
+
+  const_iterator end() const
+  {
+    return {this, size()};
+  }
+
+private:
+  static T* new_page()
+  {
+    Allocator alloc;
+    T* page = std::allocator_traits<Allocator>::allocate( alloc, page_size );
+    std::uninitialized_value_construct_n( page, page_size );
+    return page;
+  }
+
+  static void delete_page( T* page )
+  {
+    if ( page != nullptr )
+    {
+      Allocator alloc;
+      std::destroy_n( page, page_size );
+      std::allocator_traits<Allocator>::deallocate( alloc, page, page_size );
+    }
+  }
+
+  /* installs page `p` if missing; serialized, since `slot` may race */
+  void allocate_page( uint64_t p )
+  {
+    std::scoped_lock lock( mutex );
+    if ( p >= directory_size )
+    {
+      grow_directory( p + 1u );
+    }
+    auto& entry = directory.load( std::memory_order_relaxed )[p];
+    if ( entry.load( std::memory_order_relaxed ) == nullptr )
+    {
+      entry.store( new_page(), std::memory_order_release );
+    }
+  }
+
+  /* entries of the directory that replaces the current one to hold `n` pages */
+  uint64_t grown_directory_size( uint64_t n ) const
+  {
+    return std::min( max_pages, std::max<uint64_t>( {n, 2u * directory_size, 8u} ) );
+  }
+
+  /* replaces the directory by one of at least `n` entries; the old one stays valid for readers */
+  void grow_directory( uint64_t n )
+  {
+    uint64_t const size = grown_directory_size( n );
+    auto grown = std::make_unique<std::atomic<T*>[]>( size );
+    std::atomic<T*>* const old = directory.load( std::memory_order_relaxed );
+    for ( uint64_t p = 0; p < directory_size; ++p )
+    {
+      grown[p].store( old[p].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    }
+    if ( old != nullptr )
+    {
+      old_directories.emplace_back( old, directory_size );
+    }
+    directory.store( grown.release(), std::memory_order_release );
+    directory_size = size;
+    published_size.store( size, std::memory_order_release ); /* after `directory`, see `slot` */
+  }
+
+  void take( segmented_vector& other )
+  {
+    directory.store( other.directory.exchange( nullptr ) );
+    directory_size = std::exchange( other.directory_size, 0u );
+    published_size.store( other.published_size.exchange( 0u ) );
+    old_directories = std::move( other.old_directories );
+    other.old_directories.clear();
+    count.store( other.count.exchange( 0u ) );
+    num_pages = std::exchange( other.num_pages, 0u );
+  }
+
+  void release_pages()
+  {
+    std::atomic<T*>* const d = directory.exchange( nullptr );
+    for ( uint64_t p = 0; p < directory_size; ++p )
+    {
+      delete_page( d[p].load( std::memory_order_relaxed ) );
+    }
+    delete[] d;
+    for ( auto const& old : old_directories )
+    {
+      delete[] old.first;
+    }
+    old_directories.clear();
+    directory_size = 0u;
+    published_size.store( 0u );
+    num_pages = 0u;
+  }
+
+private:
+  std::atomic<std::atomic<T*>*> directory{nullptr};
+  uint64_t directory_size{0};                                          /* entries of `directory`, written under `mutex` */
+  std::atomic<uint64_t> published_size = ATOMIC_VAR_INIT( 0 );         /* `directory_size` for the lock-free check in `slot` */
+  std::vector<std::pair<std::atomic<T*>*, uint64_t>> old_directories; /* replaced directories and their sizes */
+  std::mutex mutex;
+  std::atomic<uint64_t> count = ATOMIC_VAR_INIT( 0 );
+  uint64_t num_pages{0}; /* pages [0, num_pages) are allocated */
+}; /* segmented_vector */
+
+} /* aig */
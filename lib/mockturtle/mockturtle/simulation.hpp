@@ -0,0 +1,221 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+#include "topological_order.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined( __AVX2__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+namespace aig
+{
+
+namespace detail
+{
+
+inline uint64_t splitmix64( uint64_t x )
+{
+  x += 0x9e3779b97f4a7c15ull;
+  x = ( x ^ ( x >> 30u ) ) * 0xbf58476d1ce4e5b9ull;
+  x = ( x ^ ( x >> 27u ) ) * 0x94d049bb133111ebull;
+  return x ^ ( x >> 31u );
+}
+
+/* dst = ( a ^ ca ) & ( b ^ cb ) on `Words` words; `ca`, `cb` are all-zeros or all-ones */
+template<uint32_t Words>
+inline void and_words( uint64_t* dst, uint64_t const* a, uint64_t ca, uint64_t const* b, uint64_t cb )
+{
+  uint32_t w{0};
+#if defined( __AVX512F__ )
+  if constexpr ( Words % 8u == 0u )
+  {
+    __m512i const ma = _mm512_set1_epi64( static_cast<long long>( ca ) );
+    __m512i const mb = _mm512_set1_epi64( static_cast<long long>( cb ) );
+    for ( ; w < Words; w += 8u )
+    {
+      __m512i const va = _mm512_xor_si512( _mm512_loadu_si512( a + w ), ma );
+      __m512i const vb = _mm512_xor_si512( _mm512_loadu_si512( b + w ), mb );
+      _mm512_storeu_si512( dst + w, _mm512_and_si512( va, vb ) );
+    }
+  }
+#endif
+#if defined( __AVX2__ )
+  if constexpr ( Words % 4u == 0u )
+  {
+    __m256i const ma = _mm256_set1_epi64x( static_cast<long long>( ca ) );
+    __m256i const mb = _mm256_set1_epi64x( static_cast<long long>( cb ) );
+    for ( ; w < Words; w += 4u )
+    {
+      __m256i const va = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + w ) ), ma );
+      __m256i const vb = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( b + w ) ), mb );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + w ), _mm256_and_si256( va, vb ) );
+    }
+  }
+#endif
+  for ( ; w < Words; ++w )
+  {
+    dst[w] = ( a[w] ^ ca ) & ( b[w] ^ cb );
+  }
+}
+
+} /* detail */
+
+/* Random simulation of a whole network, many patterns at a time.
+ *
+ * Patterns are processed in blocks of `BlockWords` 64-bit words (512
+ * patterns by default).  A block is simulated in one pass over the
+ * gates in `topological_gate_order` (the index order unless slots
+ * were reused; it is computed by the constructor, so the network must
+ * not change afterwards), with the values of node `n` at words
+ * [n * BlockWords, (n + 1) * BlockWords) of a node-major buffer; dead
+ * nodes get all-zero values.  The AND kernel uses AVX-512 or AVX2 when the compiler
+ * targets them (e.g., `-march=native`) and plain 64-bit words
+ * otherwise.  Only one block per thread is live at a time, so the
+ * working set is `BlockWords` words per node however many patterns are
+ * simulated.
+ *
+ * The patterns of a PI are a pure function of the seed, the block and
+ * the node, hence every block can be simulated independently: the
+ * parallel `signatures` distributes the blocks over the workers of a
+ * task manager and still returns the same result as the sequential one.
+ */
+template<typename Ntk, uint32_t BlockWords = 8u>
+class simd_simulator
+{
+public:
+  static constexpr uint32_t block_words = BlockWords;
+  static constexpr uint32_t block_bits = 64u * BlockWords;
+
+  explicit simd_simulator( Ntk const& ntk, uint64_t seed = 0x5eed5eedull )
+    : ntk( ntk )
+    , seed( seed )
+    , gates( topological_gate_order( ntk ) )
+  {}
+
+  /* number of words of a block buffer for `simulate_block` */
+  uint64_t buffer_size() const
+  {
+    return uint64_t( ntk.size() ) * BlockWords;
+  }
+
+  /* simulates the patterns of `block` into `values` (`buffer_size()` words) */
+  void simulate_block( uint64_t block, uint64_t* values ) const
+  {
+    uint32_t const num_nodes = ntk.size();
+
+    /* constant 0 */
+    for ( uint32_t w = 0; w < BlockWords; ++w )
+    {
+      values[w] = 0u;
+    }
+
+    /* the PIs, and zeros for the dead nodes */
+    for ( uint32_t n = 1u; n < num_nodes; ++n )
+    {
+      if ( ntk.fanin_size( node( n ) ) != 0u )
+      {
+        continue;
+      }
+      uint64_t* const dst = values + uint64_t( n ) * BlockWords;
+      if ( ntk.is_pi( node( n ) ) )
+      {
+        uint64_t const base = detail::splitmix64( seed ^ detail::splitmix64( ( block << 32u ) | n ) );
+        for ( uint32_t w = 0; w < BlockWords; ++w )
+        {
+          dst[w] = detail::splitmix64( base + w );
+        }
+      }
+      else
+      {
+        for ( uint32_t w = 0; w < BlockWords; ++w )
+        {
+          dst[w] = 0u;
+        }
+      }
+    }
+
+    for ( uint32_t const n : gates )
+    {
+      uint64_t* const dst = values + uint64_t( n ) * BlockWords;
+      std::array<signal, 2u> fanins{};
+      ntk.foreach_fanin( node( n ), [&]( signal const& fi, uint32_t i ){
+        fanins[i] = fi;
+      });
+      detail::and_words<BlockWords>( dst,
+                                     values + uint64_t( fanins[0].index ) * BlockWords, fanins[0].complement ? ~uint64_t( 0 ) : 0u,
+                                     values + uint64_t( fanins[1].index ) * BlockWords, fanins[1].complement ? ~uint64_t( 0 ) : 0u );
+    }
+  }
+
+  /* simulates `num_blocks` blocks and returns a 64-bit signature of the values of every node */
+  std::vector<uint64_t> signatures( uint64_t num_blocks ) const
+  {
+    std::vector<uint64_t> result( ntk.size(), 0u );
+    std::vector<uint64_t> values( buffer_size() );
+    for ( uint64_t b = 0; b < num_blocks; ++b )
+    {
+      simulate_block( b, values.data() );
+      accumulate( b, values.data(), result );
+    }
+    return result;
+  }
+
+  /* same as `signatures( num_blocks )`, with the blocks distributed over the workers of `tm` */
+  template<typename TaskManager>
+  std::vector<uint64_t> signatures( uint64_t num_blocks, TaskManager& tm ) const
+  {
+    /* one value buffer and one partial signature per worker (and the helping caller) */
+    uint64_t const num_workers = tm.num_workers();
+    std::vector<std::vector<uint64_t>> values( num_workers + 1u );
+    std::vector<std::vector<uint64_t>> partial( num_workers + 1u );
+
+    tm.parallel_for( mockturtle::detail::range<uint64_t>( num_blocks ), 1u, [&]( uint64_t b ){
+      uint64_t const index = tm.worker_index();
+      if ( values[index].empty() )
+      {
+        values[index].resize( buffer_size() );
+        partial[index].assign( ntk.size(), 0u );
+      }
+      simulate_block( b, values[index].data() );
+      accumulate( b, values[index].data(), partial[index] );
+    });
+
+    /* signatures combine blocks with XOR, so the merge order does not matter */
+    std::vector<uint64_t> result( ntk.size(), 0u );
+    for ( auto const& p : partial )
+    {
+      for ( uint64_t n = 0; n < p.size(); ++n )
+      {
+        result[n] ^= p[n];
+      }
+    }
+    return result;
+  }
+
+private:
+  static void accumulate( uint64_t block, uint64_t const* values, std::vector<uint64_t>& sigs )
+  {
+    for ( uint64_t n = 0; n < sigs.size(); ++n )
+    {
+      uint64_t h = block;
+      for ( uint32_t w = 0; w < BlockWords; ++w )
+      {
+        h = detail::splitmix64( h ^ values[n * BlockWords + w] );
+      }
+      sigs[n] ^= h;
+    }
+  }
+
+private:
+  Ntk const& ntk;
+  uint64_t const seed;
+  std::vector<uint32_t> const gates;
+}; /* simd_simulator */
+
+} /* aig */
@@ -0,0 +1,532 @@
+#pragma once
+
+#include "aig.hpp"
+#include "segmented_vector.hpp"
+
+#include <parallel_hashmap/phmap.h>
+#include <parallel_hashmap/phmap_dump.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aig
+{
+
+/* Header of a binary network snapshot.
+ *
+ * The header is followed by raw arrays, each starting at a multiple of
+ * `snapshot_alignment`: the fanins of all nodes (8 bytes per node, the
+ * in-memory `fanin_array`), their reference counts, the PI nodes, the
+ * PO signals, and (since version 3) the free list of dead node slots in
+ * reuse order.  The layout is that of the host (little-endian on
+ * x86-64), so a snapshot can be mapped and used in place.
+ *
+ * Since version 2, an optional last section holds the strash table as
+ * dumped by `phmap_dump.h` (control bytes and slots, in the binary
+ * layout of the vendored phmap), together with the number of entries
+ * and nodes it was written for.
+ */
+struct snapshot_header
+{
+  static constexpr std::array<char, 8u> expected_magic{'A', 'I', 'G', 'S', 'N', 'A', 'P', '\0'};
+  static constexpr uint32_t current_version = 3u;
+
+  std::array<char, 8u> magic{expected_magic};
+  uint32_t version{current_version};
+  uint32_t header_size{sizeof( snapshot_header )};
+  uint64_t num_nodes{0};
+  uint64_t num_inputs{0};
+  uint64_t num_outputs{0};
+  uint64_t num_free_nodes{0};
+  uint64_t fanins_offset{0};
+  uint64_t ref_counts_offset{0};
+  uint64_t inputs_offset{0};
+  uint64_t outputs_offset{0};
+  uint64_t free_nodes_offset{0};
+  uint64_t hash_offset{0};  /* 0 if the snapshot has no strash table */
+  uint64_t hash_bytes{0};
+  uint64_t hash_entries{0};
+  uint64_t hash_num_nodes{0}; /* number of nodes when the table was dumped */
+  uint64_t file_size{0};
+}; /* snapshot_header */
+
+inline constexpr uint64_t snapshot_alignment = 64u;
+
+namespace detail
+{
+
+inline uint64_t align_snapshot_offset( uint64_t offset )
+{
+  return ( offset + snapshot_alignment - 1u ) & ~( snapshot_alignment - 1u );
+}
+
+/* computes the section offsets of a snapshot with the given sizes */
+inline snapshot_header make_snapshot_header( uint64_t num_nodes, uint64_t num_inputs, uint64_t num_outputs, uint64_t num_free_nodes )
+{
+  snapshot_header h;
+  h.num_nodes = num_nodes;
+  h.num_inputs = num_inputs;
+  h.num_outputs = num_outputs;
+  h.num_free_nodes = num_free_nodes;
+  h.fanins_offset = align_snapshot_offset( sizeof( snapshot_header ) );
+  h.ref_counts_offset = align_snapshot_offset( h.fanins_offset + num_nodes * sizeof( fanin_array ) );
+  h.inputs_offset = align_snapshot_offset( h.ref_counts_offset + num_nodes * sizeof( uint32_t ) );
+  h.outputs_offset = align_snapshot_offset( h.inputs_offset + num_inputs * sizeof( uint32_t ) );
+  h.free_nodes_offset = align_snapshot_offset( h.outputs_offset + num_outputs * sizeof( signal ) );
+  h.file_size = h.free_nodes_offset + num_free_nodes * sizeof( uint32_t );
+  return h;
+}
+
+inline void pad_snapshot( std::ofstream& os, uint64_t offset )
+{
+  static constexpr std::array<char, snapshot_alignment> zeros{};
+  uint64_t const pos = static_cast<uint64_t>( os.tellp() );
+  os.write( zeros.data(), static_cast<std::streamsize>( offset - pos ) );
+}
+
+/* phmap archive appending to a snapshot file */
+struct snapshot_output_archive
+{
+  bool dump( char const* p, std::size_t size )
+  {
+    os.write( p, static_cast<std::streamsize>( size ) );
+    return static_cast<bool>( os );
+  }
+
+  template<typename V>
+  bool dump( V const& v )
+  {
+    return dump( reinterpret_cast<char const*>( &v ), sizeof( V ) );
+  }
+
+  std::ofstream& os;
+}; /* snapshot_output_archive */
+
+/* phmap archive reading a section of a mapped snapshot with bounds checks */
+struct snapshot_input_archive
+{
+  bool load( char* p, std::size_t size )
+  {
+    if ( static_cast<std::size_t>( end - pos ) < size )
+    {
+      return false;
+    }
+    std::memcpy( p, pos, size );
+    pos += size;
+    return true;
+  }
+
+  template<typename V>
+  bool load( V* v )
+  {
+    return load( reinterpret_cast<char*>( v ), sizeof( V ) );
+  }
+
+  char const* pos;
+  char const* end;
+}; /* snapshot_input_archive */
+
+struct free_deleter
+{
+  void operator()( void* p ) const
+  {
+    std::free( p );
+  }
+}; /* free_deleter */
+
+} /* detail */
+
+/* Writes the nodes, PIs, POs, and free slots of `storage` (any storage layout) as a binary snapshot.
+ *
+ * The strash table is written as well if `with_hash` is set and the
+ * table indexes every AND gate; a table that does not (e.g., of a
+ * `mapped_storage` that has not been rehashed) is left out.
+ */
+template<typename Storage>
+bool write_snapshot( Storage& storage, std::string const& filename, bool with_hash = true )
+{
+  std::ofstream os( filename, std::ofstream::binary );
+  if ( !os.is_open() )
+  {
+    return false;
+  }
+
+  uint64_t const num_nodes = storage.num_nodes();
+  auto const h = detail::make_snapshot_header( num_nodes, storage.inputs.size(), storage.outputs.size(), storage.free_nodes.size() );
+  os.write( reinterpret_cast<char const*>( &h ), sizeof( h ) );
+
+  /* node data in chunks, so that the layout of `Storage` does not matter */
+  constexpr uint64_t chunk = 1u << 16u;
+  std::vector<fanin_array> fanins;
+  std::vector<uint32_t> ref_counts;
+  fanins.reserve( chunk );
+  ref_counts.reserve( chunk );
+
+  uint64_t num_gates{0};
+  detail::pad_snapshot( os, h.fanins_offset );
+  for ( uint64_t begin = 0; begin < num_nodes; begin += chunk )
+  {
+    fanins.clear();
+    for ( uint64_t n = begin; n < std::min( num_nodes, begin + chunk ); ++n )
+    {
+      auto const& f = fanins.emplace_back( storage.node_fanins( static_cast<uint32_t>( n ) ) );
+      num_gates += f[0].data != f[1].data ? 1u : 0u;
+    }
+    os.write( reinterpret_cast<char const*>( fanins.data() ), static_cast<std::streamsize>( fanins.size() * sizeof( fanin_array ) ) );
+  }
+
+  detail::pad_snapshot( os, h.ref_counts_offset );
+  for ( uint64_t begin = 0; begin < num_nodes; begin += chunk )
+  {
+    ref_counts.clear();
+    for ( uint64_t n = begin; n < std::min( num_nodes, begin + chunk ); ++n )
+    {
+      ref_counts.emplace_back( storage.node_ref_count( static_cast<uint32_t>( n ) ) );
+    }
+    os.write( reinterpret_cast<char const*>( ref_counts.data() ), static_cast<std::streamsize>( ref_counts.size() * sizeof( uint32_t ) ) );
+  }
+
+  detail::pad_snapshot( os, h.inputs_offset );
+  os.write( reinterpret_cast<char const*>( storage.inputs.data() ), static_cast<std::streamsize>( storage.inputs.size() * sizeof( uint32_t ) ) );
+  detail::pad_snapshot( os, h.outputs_offset );
+  os.write( reinterpret_cast<char const*>( storage.outputs.data() ), static_cast<std::streamsize>( storage.outputs.size() * sizeof( signal ) ) );
+  detail::pad_snapshot( os, h.free_nodes_offset );
+  os.write( reinterpret_cast<char const*>( storage.free_nodes.data() ), static_cast<std::streamsize>( storage.free_nodes.size() * sizeof( uint32_t ) ) );
+
+  if ( with_hash && storage.hash.size() == num_gates )
+  {
+    /* the table goes last, and the header is rewritten with its location */
+    auto complete = h;
+    complete.hash_offset = detail::align_snapshot_offset( h.file_size );
+    detail::pad_snapshot( os, complete.hash_offset );
+    detail::snapshot_output_archive ar{os};
+    if ( !storage.hash.dump( ar ) )
+    {
+      return false;
+    }
+    complete.file_size = static_cast<uint64_t>( os.tellp() );
+    complete.hash_bytes = complete.file_size - complete.hash_offset;
+    complete.hash_entries = storage.hash.size();
+    complete.hash_num_nodes = num_nodes;
+    os.seekp( 0 );
+    os.write( reinterpret_cast<char const*>( &complete ), sizeof( complete ) );
+  }
+
+  return static_cast<bool>( os );
+}
+
+/* Node storage backed by a memory-mapped snapshot.
+ *
+ * `open` maps the snapshot privately: the fanins and reference counts
+ * of the loaded nodes are used in place, and pages are only read from
+ * disk when they are first touched; the reference counts are
+ * copy-on-write, so updating them (or the fanins, when nodes are
+ * substituted) never modifies the file.  The marks
+ * of the loaded nodes come from `calloc`, which hands out lazily
+ * zeroed pages for large blocks.  Only the PI and PO lists, the free
+ * list (so dead slots stay dead and are reused in the same order as
+ * before the snapshot), and the strash table (see below) are copied.
+ *
+ * Nodes added after loading go to growable pages behind the mapped
+ * nodes, so the storage works with every `basic_network` algorithm.
+ * If the snapshot contains a strash table, it is restored with one
+ * copy of its control bytes and slots, without hashing any node, and
+ * `create_and` can be used right away.  Otherwise the table starts out
+ * empty: read-only algorithms need no hashing, and `rehash` indexes
+ * the loaded AND gates before the network is edited.  The snapshot is
+ * trusted; only its header, sizes, and the shape of the table are
+ * validated.
+ */
+class mapped_storage
+{
+public:
+  using strash_table = phmap::flat_hash_set<uint32_t, strash_hash<mapped_storage>, strash_eq<mapped_storage>>;
+
+  mapped_storage()
+    : hash( 0u, strash_hash<mapped_storage>{this}, strash_eq<mapped_storage>{this} )
+  {
+    /* constant 0 node, until a snapshot is opened */
+    add_node();
+  }
+
+  mapped_storage( mapped_storage const& ) = delete;
+  mapped_storage& operator=( mapped_storage const& ) = delete;
+
+  ~mapped_storage()
+  {
+    unmap();
+  }
+
+  /* replaces the contents of the storage by the snapshot in `filename` */
+  bool open( std::string const& filename )
+  {
+    unmap();
+    tail_fanins.clear();
+    tail_marks.clear();
+    tail_ref_counts.clear();
+    inputs.clear();
+    outputs.clear();
+    hash.clear();
+    free_nodes.clear();
+
+    if ( !map( filename ) )
+    {
+      add_node();
+      return false;
+    }
+
+    snapshot_header h;
+    if ( mapped_size < sizeof( h ) )
+    {
+      return fail();
+    }
+    std::memcpy( &h, mapped, sizeof( h ) );
+    auto const expected = detail::make_snapshot_header( h.num_nodes, h.num_inputs, h.num_outputs, h.num_free_nodes );
+    uint64_t const expected_size = h.hash_offset == 0u ? expected.file_size : h.hash_offset + h.hash_bytes;
+    if ( h.magic != snapshot_header::expected_magic || h.version != snapshot_header::current_version || h.header_size != sizeof( h ) ||
+         h.num_nodes == 0u || h.num_nodes > ( 1ull << 31u ) || h.fanins_offset != expected.fanins_offset ||
+         h.ref_counts_offset != expected.ref_counts_offset || h.inputs_offset != expected.inputs_offset ||
+         h.outputs_offset != expected.outputs_offset || h.free_nodes_offset != expected.free_nodes_offset ||
+         h.num_free_nodes >= h.num_nodes || h.file_size != expected_size || mapped_size < h.file_size ||
+         ( h.hash_offset != 0u && h.hash_offset != detail::align_snapshot_offset( expected.file_size ) ) )
+    {
+      return fail();
+    }
+
+    base_size = h.num_nodes;
+    base_fanins = reinterpret_cast<fanin_array*>( mapped + h.fanins_offset );
+    base_ref_counts = reinterpret_cast<uint32_t*>( mapped + h.ref_counts_offset );
+    base_marks.reset( static_cast<uint32_t*>( std::calloc( base_size, sizeof( uint32_t ) ) ) );
+    if ( !base_marks )
+    {
+      return fail();
+    }
+
+    inputs.resize( h.num_inputs );
+    std::memcpy( inputs.data(), mapped + h.inputs_offset, h.num_inputs * sizeof( uint32_t ) );
+    outputs.resize( h.num_outputs, signal( 0u ) );
+    std::memcpy( outputs.data(), mapped + h.outputs_offset, h.num_outputs * sizeof( signal ) );
+    free_nodes.resize( h.num_free_nodes );
+    std::memcpy( free_nodes.data(), mapped + h.free_nodes_offset, h.num_free_nodes * sizeof( uint32_t ) );
+
+    if ( h.hash_offset != 0u && !load_hash( h ) )
+    {
+      return fail();
+    }
+    return true;
+  }
+
+  /* indexes all AND gates in the strash table */
+  void rehash()
+  {
+    hash.clear();
+    hash.reserve( num_nodes() );
+    for ( uint64_t n = 1u; n < num_nodes(); ++n )
+    {
+      auto const& fanins = node_fanins( static_cast<uint32_t>( n ) );
+      if ( fanins[0].data != fanins[1].data )
+      {
+        hash.insert( static_cast<uint32_t>( n ) );
+      }
+    }
+  }
+
+  uint64_t num_nodes() const
+  {
+    return base_size + tail_fanins.size();
+  }
+
+  fanin_array const& node_fanins( uint32_t n ) const
+  {
+    return n < base_size ? base_fanins[n] : tail_fanins[n - base_size];
+  }
+
+  /* copy-on-write for the loaded nodes, like their reference counts */
+  void set_node_fanins( uint32_t n, fanin_array const& fanins )
+  {
+    ( n < base_size ? base_fanins[n] : tail_fanins[n - base_size] ) = fanins;
+  }
+
+  std::atomic_ref<uint32_t> node_mark( uint32_t n )
+  {
+    return std::atomic_ref<uint32_t>( n < base_size ? base_marks.get()[n] : tail_marks[n - base_size] );
+  }
+
+  uint32_t& node_ref_count( uint32_t n )
+  {
+    return n < base_size ? base_ref_counts[n] : tail_ref_counts[n - base_size];
+  }
+
+  uint32_t add_node( fanin_array const& node_fanins = {} )
+  {
+    uint32_t const index = static_cast<uint32_t>( num_nodes() );
+    tail_marks.emplace_back( 0u );
+    tail_ref_counts.emplace_back( 0u );
+    /* fanins last: their size is the number of nodes seen by concurrent readers */
+    tail_fanins.emplace_back( node_fanins );
+    return index;
+  }
+
+  void reserve( uint64_t n )
+  {
+    if ( n > base_size )
+    {
+      tail_fanins.reserve( n - base_size );
+      tail_marks.reserve( n - base_size );
+      tail_ref_counts.reserve( n - base_size );
+    }
+  }
+
+private:
+  /* restores the dumped strash table, which must belong to exactly these nodes */
+  bool load_hash( snapshot_header const& h )
+  {
+    if ( h.hash_num_nodes != h.num_nodes || h.hash_entries >= h.num_nodes )
+    {
+      return false;
+    }
+
+    /* a dump starts with the size and the capacity (2^k - 1) of the table */
+    std::size_t size{0}, capacity{0};
+    if ( h.hash_bytes < sizeof( size ) )
+    {
+      return false;
+    }
+    std::memcpy( &size, mapped + h.hash_offset, sizeof( size ) );
+    if ( size != h.hash_entries )
+    {
+      return false;
+    }
+    if ( size > 0u )
+    {
+      if ( h.hash_bytes < sizeof( size ) + sizeof( capacity ) )
+      {
+        return false;
+      }
+      std::memcpy( &capacity, mapped + h.hash_offset + sizeof( size ), sizeof( capacity ) );
+      if ( capacity < size || ( capacity & ( capacity + 1u ) ) != 0u ||
+           h.hash_bytes < sizeof( size ) + sizeof( capacity ) + capacity * ( 1u + sizeof( uint32_t ) ) )
+      {
+        return false;
+      }
+    }
+
+    detail::snapshot_input_archive ar{mapped + h.hash_offset, mapped + h.hash_offset + h.hash_bytes};
+    if ( !hash.load( ar ) || ar.pos != ar.end )
+    {
+      hash.clear();
+      return false;
+    }
+    return true;
+  }
+
+  bool map( std::string const& filename )
+  {
+#ifndef _WIN32
+    int const fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      return false;
+    }
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size == 0 )
+    {
+      ::close( fd );
+      return false;
+    }
+    void* const p = ::mmap( nullptr, static_cast<std::size_t>( st.st_size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( p == MAP_FAILED )
+    {
+      return false;
+    }
+    mapped = static_cast<char*>( p );
+    mapped_size = static_cast<std::size_t>( st.st_size );
+    return true;
+#else
+    std::ifstream in( filename, std::ifstream::binary | std::ifstream::ate );
+    if ( !in.is_open() )
+    {
+      return false;
+    }
+    mapped_size = static_cast<std::size_t>( in.tellg() );
+    buffer.reset( new uint64_t[( mapped_size + 7u ) / 8u] );
+    mapped = reinterpret_cast<char*>( buffer.get() );
+    in.seekg( 0 );
+    in.read( mapped, static_cast<std::streamsize>( mapped_size ) );
+    return static_cast<bool>( in );
+#endif
+  }
+
+  void unmap()
+  {
+#ifndef _WIN32
+    if ( mapped != nullptr )
+    {
+      ::munmap( mapped, mapped_size );
+    }
+#else
+    buffer.reset();
+#endif
+    mapped = nullptr;
+    mapped_size = 0u;
+    base_size = 0u;
+    base_fanins = nullptr;
+    base_ref_counts = nullptr;
+    base_marks.reset();
+  }
+
+  bool fail()
+  {
+    unmap();
+    inputs.clear();
+    outputs.clear();
+    free_nodes.clear();
+    add_node();
+    return false;
+  }
+
+public:
+  std::vector<uint32_t> inputs;
+  std::vector<signal> outputs;
+  strash_table hash; /* indices of the AND gates, see `rehash` */
+  std::vector<uint32_t> free_nodes; /* slots of dead nodes, reused last in first out */
+  epoch_table epochs;
+
+private:
+  char* mapped{nullptr};
+  std::size_t mapped_size{0};
+#ifdef _WIN32
+  std::unique_ptr<uint64_t[]> buffer;
+#endif
+
+  /* nodes of the snapshot */
+  uint64_t base_size{0};
+  fanin_array* base_fanins{nullptr};
+  uint32_t* base_ref_counts{nullptr};
+  std::unique_ptr<uint32_t[], detail::free_deleter> base_marks;
+
+  /* nodes added after loading */
+  segmented_vector<fanin_array> tail_fanins;
+  segmented_vector<uint32_t> tail_marks;
+  segmented_vector<uint32_t> tail_ref_counts;
+}; /* mapped_storage */
+
+using mapped_network = basic_network<mapped_storage>;
+
+} /* aig */
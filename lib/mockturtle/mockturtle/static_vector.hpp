@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+
+namespace aig
+{
+
+/* A vector with inline storage for at most `Capacity` elements; never allocates */
+template<typename T, uint32_t Capacity>
+class static_vector
+{
+public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = T const*;
+
+  static constexpr uint32_t capacity()
+  {
+    return Capacity;
+  }
+
+  static_vector() = default;
+
+  static_vector( std::initializer_list<T> init )
+  {
+    for ( auto const& v : init )
+    {
+      push_back( v );
+    }
+  }
+
+  uint32_t size() const
+  {
+    return count;
+  }
+
+  bool empty() const
+  {
+    return count == 0u;
+  }
+
+  void clear()
+  {
+    count = 0u;
+  }
+
+  void push_back( T const& value )
+  {
+    assert( count < Capacity && "static_vector capacity exceeded" );
+    items[count++] = value;
+  }
+
+  void pop_back()
+  {
+    assert( count > 0u );
+    --count;
+  }
+
+  /* O(1) removal that does not preserve the order: the last element takes the place of `index` */
+  void swap_remove( uint32_t index )
+  {
+    assert( index < count );
+    items[index] = items[--count];
+  }
+
+  T& back()
+  {
+    return items[count - 1u];
+  }
+
+  T const& back() const
+  {
+    return items[count - 1u];
+  }
+
+  T& operator[]( uint32_t index )
+  {
+    return items[index];
+  }
+
+  T const& operator[]( uint32_t index ) const
+  {
+    return items[index];
+  }
+
+  iterator begin()
+  {
+    return items.data();
+  }
+
+  iterator end()
+  {
+    return items.data() + count;
+  }
+
+  const_iterator begin() const
+  {
+    return items.data();
+  }
+
+  const_iterator end() const
+  {
+    return items.data() + count;
+  }
+
+private:
+  std::array<T, Capacity> items{};
+  uint32_t count{0};
+}; /* static_vector */
+
+} /* aig */
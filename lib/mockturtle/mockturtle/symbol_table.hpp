@@ -0,0 +1,18 @@
+#pragma once
+
+#include <lorina/detail/symbol_table.hpp>
+#include <parallel_hashmap/phmap.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace aig
+{
+
+/* Interns names as dense ids `0, 1, 2, ...` (see
+ * `lorina::detail::basic_symbol_table`), hashed with phmap.  The
+ * Verilog parser resolves gate dependencies on the same kind of table.
+ */
+using symbol_table = lorina::detail::basic_symbol_table<phmap::flat_hash_map<std::string_view, uint32_t>>;
+
+} /* aig */
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "aig.hpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+/* The live gates of `ntk`, every gate after its fanins.
+ *
+ * The gates are taken in index order, and a gate whose fanins are not
+ * placed yet (a reused slot, or a gate after `substitute_node`) first
+ * places them depth-first.  Hence the order is the index order for a
+ * network built without slot reuse, and the constant, the PIs and the
+ * dead nodes are left out.  Takes one bit per node and a stack as deep
+ * as the longest chain of out-of-order fanins.
+ */
+template<typename Ntk>
+std::vector<uint32_t> topological_gate_order( Ntk const& ntk )
+{
+  uint32_t const size = ntk.size();
+  std::vector<uint32_t> order;
+  order.reserve( size );
+  std::vector<bool> placed( size, false );
+  std::vector<std::pair<uint32_t, bool>> stack; /* node, fanins pushed */
+  for ( uint32_t root = 1u; root < size; ++root )
+  {
+    stack.emplace_back( root, false );
+    while ( !stack.empty() )
+    {
+      auto [n, expanded] = stack.back();
+      if ( placed[n] || ntk.fanin_size( node( n ) ) == 0u )
+      {
+        stack.pop_back();
+        continue;
+      }
+      if ( expanded )
+      {
+        placed[n] = true;
+        order.emplace_back( n );
+        stack.pop_back();
+        continue;
+      }
+      stack.back().second = true;
+
+      std::array<uint32_t, 2u> fanins{};
+      ntk.foreach_fanin( node( n ), [&]( signal const& fi, uint32_t i ){
+        fanins[i] = fi.index;
+      } );
+      stack.emplace_back( fanins[1], false );
+      stack.emplace_back( fanins[0], false );
+    }
+  }
+  return order;
+}
+
+} /* aig */
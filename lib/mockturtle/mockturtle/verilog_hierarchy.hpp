@@ -0,0 +1,508 @@
+#pragma once
+
+#include "aig.hpp"
+#include "foreach.hpp"
+#include "verilog_reader.hpp"
+
+#include <lorina/diagnostics.hpp>
+#include <lorina/verilog.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aig
+{
+
+namespace detail
+{
+
+inline constexpr uint32_t no_instance = ~uint32_t( 0 );
+
+/* One parsed module: its own AIG with the instances cut out.
+ *
+ * The PIs are the input ports (declarations precede all statements,
+ * so they come first) followed by the outputs of the instances; the
+ * POs are the output ports followed by the inputs of the instances.
+ */
+struct verilog_module
+{
+  struct instance
+  {
+    std::string module;
+    uint32_t definition{no_instance};                      /* index of the module, set after parsing */
+    std::vector<std::pair<std::string, uint32_t>> inputs;  /* (port, PO of the parent) */
+    std::vector<std::pair<std::string, uint32_t>> outputs; /* (port, PI of the parent) */
+  }; /* instance */
+
+  std::string name;
+  aig::storage store;
+  std::vector<std::string> inputs;   /* input ports, in the order of their PIs */
+  std::vector<std::string> outputs;  /* output ports, in the order of their POs */
+  std::vector<uint32_t> pi_instance; /* instance driving each PI, or `no_instance` for ports */
+  std::vector<instance> instances;
+  std::vector<std::pair<lorina::diagnostic_level, std::string>> diagnostics;
+  bool parsed{false};
+}; /* verilog_module */
+
+/* port of a named connection `.port(signal)` without the dot */
+inline std::string_view port_name( std::string_view formal )
+{
+  return formal.starts_with( '.' ) ? formal.substr( 1u ) : formal;
+}
+
+/* output ports of all modules, keyed by module name */
+using verilog_port_table = std::unordered_map<std::string_view, std::vector<std::string_view>>;
+
+/* keeps the diagnostics of one module until they can be reported in order */
+class buffered_diagnostics : public lorina::diagnostic_engine
+{
+public:
+  explicit buffered_diagnostics( verilog_module& m )
+    : m( m )
+  {}
+
+  void emit( lorina::diagnostic_level level, const std::string& message ) const override
+  {
+    m.diagnostics.emplace_back( level, message );
+  }
+
+private:
+  verilog_module& m;
+}; /* buffered_diagnostics */
+
+/* `aig::verilog_reader` that turns the instances of a module into PIs and POs */
+class module_reader : public verilog_reader<aig::network>
+{
+public:
+  module_reader( aig::network& ntk, verilog_module& m, verilog_port_table const& ports )
+    : verilog_reader<aig::network>( ntk )
+    , m( m )
+    , ports( ports )
+  {}
+
+  void on_module_header( const std::string& module_name, const std::vector<std::string>& inouts ) const override
+  {
+    (void)inouts;
+    m.name = module_name;
+  }
+
+  void on_inputs( const std::vector<std::string>& names, std::string const& size = "" ) const override
+  {
+    assert( size.empty() );
+    (void)size;
+    for ( const auto& name : names )
+    {
+      define( name, aig_.create_pi() );
+      m.inputs.emplace_back( name );
+      m.pi_instance.emplace_back( no_instance );
+    }
+  }
+
+  void on_outputs( const std::vector<std::string>& names, std::string const& size = "" ) const override
+  {
+    assert( size.empty() );
+    (void)size;
+    for ( const auto& name : names )
+    {
+      m.outputs.emplace_back( name );
+    }
+  }
+
+  void on_module_instantiation( std::string const& module_name, std::vector<std::string> const& params, std::string const& inst_name,
+                                std::vector<std::pair<std::string,std::string>> const& args ) const override
+  {
+    (void)params;
+    (void)inst_name;
+
+    uint32_t const index = static_cast<uint32_t>( m.instances.size() );
+    auto& inst = m.instances.emplace_back();
+    inst.module = module_name;
+    for ( auto const& [port, actual] : args )
+    {
+      if ( is_instance_output( module_name, port ) )
+      {
+        define( actual, aig_.create_pi() );
+        inst.outputs.emplace_back( port_name( port ), static_cast<uint32_t>( m.pi_instance.size() ) );
+        m.pi_instance.emplace_back( index );
+      }
+      else
+      {
+        /* the POs are created in `on_endmodule`, when all drivers are known */
+        inst.inputs.emplace_back( port_name( port ), static_cast<uint32_t>( pending_inputs.size() ) );
+        pending_inputs.emplace_back( actual );
+      }
+    }
+  }
+
+  bool is_instance_output( std::string const& module_name, std::string const& port ) const override
+  {
+    auto const it = ports.find( module_name );
+    return it != ports.end() && std::find( it->second.begin(), it->second.end(), port_name( port ) ) != it->second.end();
+  }
+
+  void on_endmodule() const override
+  {
+    for ( auto const& o : m.outputs )
+    {
+      aig_.create_po( operand( o ) );
+    }
+
+    /* instance inputs follow the output ports */
+    uint32_t const offset = static_cast<uint32_t>( m.outputs.size() );
+    for ( auto& inst : m.instances )
+    {
+      for ( auto& input : inst.inputs )
+      {
+        input.second += offset;
+      }
+    }
+    for ( auto const& name : pending_inputs )
+    {
+      aig_.create_po( operand( name ) );
+    }
+  }
+
+private:
+  verilog_module& m;
+  verilog_port_table const& ports;
+  mutable std::vector<std::string> pending_inputs;
+}; /* module_reader */
+
+/* Copies a module into `ntk`, its instances recursively.
+ *
+ * The nodes of a module are mapped on demand from its POs with an
+ * explicit stack: the PIs of an instance are only available once all
+ * of its inputs are mapped, and the drivers of these inputs may come
+ * after the instance in node order.
+ */
+template<typename Ntk>
+class verilog_flattener
+{
+public:
+  verilog_flattener( Ntk& ntk, std::vector<verilog_module> const& modules, lorina::diagnostic_engine* diag )
+    : ntk( ntk )
+    , modules( modules )
+    , diag( diag )
+    , active( modules.size(), false )
+  {}
+
+  /* signals of the output ports of `m` for the signals `inputs` of its input ports */
+  bool instantiate( uint32_t m, std::vector<signal> const& inputs, std::vector<signal>& outputs )
+  {
+    auto const& mod = modules[m];
+    if ( active[m] )
+    {
+      report( fmt::format( "module `{0}` instantiates itself", mod.name ) );
+      return false;
+    }
+    active[m] = true;
+
+    std::vector<signal> map( mod.store.num_nodes() );
+    std::vector<bool> mapped( mod.store.num_nodes(), false );
+    std::vector<bool> expanded( mod.store.num_nodes(), false );
+    std::vector<uint32_t> pi_number( mod.store.num_nodes(), no_instance );
+    map[0] = ntk.get_constant( false );
+    mapped[0] = true;
+
+    for ( uint32_t i = 0; i < mod.store.inputs.size(); ++i )
+    {
+      uint32_t const n = mod.store.inputs[i];
+      pi_number[n] = i;
+      if ( i < mod.inputs.size() )
+      {
+        map[n] = inputs[i];
+        mapped[n] = true;
+      }
+    }
+
+    auto const translate = [&]( signal s ){
+      return map[s.index] ^ s.complement;
+    };
+
+    /* maps the driver of every PO */
+    std::vector<uint32_t> stack;
+    for ( auto const& po : mod.store.outputs )
+    {
+      if ( mapped[po.index] )
+      {
+        continue;
+      }
+      stack.push_back( po.index );
+      while ( !stack.empty() )
+      {
+        uint32_t const n = stack.back();
+        if ( mapped[n] )
+        {
+          stack.pop_back();
+          continue;
+        }
+        if ( expanded[n] && pi_number[n] != no_instance )
+        {
+          /* back on top with unmapped inputs: they depend on `n` */
+          bool waiting{false};
+          for ( auto const& input : mod.instances[mod.pi_instance[pi_number[n]]].inputs )
+          {
+            waiting = waiting || !mapped[mod.store.outputs[input.second].index];
+          }
+          if ( waiting )
+          {
+            report( fmt::format( "combinational loop through an instance of `{0}` in module `{1}`", mod.instances[mod.pi_instance[pi_number[n]]].module, mod.name ) );
+            return false;
+          }
+        }
+        expanded[n] = true;
+
+        if ( pi_number[n] != no_instance )
+        {
+          /* an output of an instance: instantiate it once its inputs are mapped */
+          auto const& inst = mod.instances[mod.pi_instance[pi_number[n]]];
+          bool ready{true};
+          for ( auto const& input : inst.inputs )
+          {
+            uint32_t const driver = mod.store.outputs[input.second].index;
+            if ( !mapped[driver] )
+            {
+              stack.push_back( driver );
+              ready = false;
+            }
+          }
+          if ( !ready )
+          {
+            continue;
+          }
+
+          stack.pop_back();
+          auto const& def = modules[inst.definition];
+          std::vector<signal> child_inputs( def.inputs.size(), ntk.get_constant( false ) );
+          for ( auto const& [formal, po] : inst.inputs )
+          {
+            auto const it = std::find( def.inputs.begin(), def.inputs.end(), formal );
+            if ( it == def.inputs.end() )
+            {
+              report( fmt::format( "module `{0}` has no input `{1}`", def.name, formal ) );
+              return false;
+            }
+            child_inputs[it - def.inputs.begin()] = translate( mod.store.outputs[po] );
+          }
+
+          std::vector<signal> child_outputs;
+          if ( !instantiate( inst.definition, child_inputs, child_outputs ) )
+          {
+            return false;
+          }
+          for ( auto const& [formal, pi] : inst.outputs )
+          {
+            auto const it = std::find( def.outputs.begin(), def.outputs.end(), formal );
+            assert( it != def.outputs.end() );
+            uint32_t const pi_node = mod.store.inputs[pi];
+            map[pi_node] = child_outputs[it - def.outputs.begin()];
+            mapped[pi_node] = true;
+          }
+          continue;
+        }
+
+        auto const& fanins = mod.store.node_fanins( n );
+        bool ready{true};
+        for ( auto const& fi : fanins )
+        {
+          if ( !mapped[fi.index] )
+          {
+            stack.push_back( fi.index );
+            ready = false;
+          }
+        }
+        if ( !ready )
+        {
+          continue;
+        }
+
+        stack.pop_back();
+        map[n] = ntk.create_and( translate( fanins[0] ), translate( fanins[1] ) );
+        mapped[n] = true;
+      }
+    }
+    outputs.clear();
+    for ( uint32_t o = 0; o < mod.outputs.size(); ++o )
+    {
+      outputs.emplace_back( translate( mod.store.outputs[o] ) );
+    }
+
+    active[m] = false;
+    return true;
+  }
+
+private:
+  void report( std::string const& message )
+  {
+    if ( diag )
+    {
+      diag->report( lorina::diagnostic_level::error, message );
+    }
+  }
+
+private:
+  Ntk& ntk;
+  std::vector<verilog_module> const& modules;
+  lorina::diagnostic_engine* diag;
+  std::vector<bool> active;
+}; /* verilog_flattener */
+
+} /* detail */
+
+/* Reads a hierarchical Verilog netlist into one flat AIG.
+ *
+ * `lorina::scan_verilog_modules` first finds the module boundaries and
+ * the output ports in one pass over the buffer.  The modules are then
+ * parsed in parallel on the workers of `tm`, each into its own
+ * `aig::storage`, where the outputs of an instance become PIs and its
+ * inputs POs.  Finally, the top module is flattened into `ntk`: every
+ * instance is copied with its inputs connected, so structural hashing
+ * also merges logic across module boundaries.  Only the logic in the
+ * transitive fanin of the outputs of the top module is copied.
+ *
+ * The top module is `top`, or else the last module that no other
+ * module instantiates.  Diagnostics are reported per module in the
+ * order of the buffer.  AIG readers only understand `assign` and 2-input
+ * AND statements, see `aig::verilog_reader`.
+ */
+template<typename Ntk, typename TaskManager>
+[[nodiscard]] lorina::return_code read_verilog_hierarchy_buffer( std::string_view buffer, Ntk& ntk, TaskManager& tm,
+                                                                 lorina::diagnostic_engine* diag = nullptr, std::string const& top = "" )
+{
+  auto const infos = lorina::scan_verilog_modules( buffer );
+  if ( infos.empty() )
+  {
+    if ( diag )
+    {
+      diag->report( lorina::diagnostic_level::error, "no module found" );
+    }
+    return lorina::return_code::parse_error;
+  }
+
+  detail::verilog_port_table ports;
+  for ( auto const& info : infos )
+  {
+    ports.emplace( info.name, info.outputs );
+  }
+
+  /* parse the modules in parallel */
+  std::vector<detail::verilog_module> modules( infos.size() );
+  tm.parallel_for( mockturtle::detail::range<uint64_t>( infos.size() ), 1u, [&]( uint64_t i ){
+    aig::network mod( modules[i].store );
+    detail::module_reader reader( mod, modules[i], ports );
+    detail::buffered_diagnostics mod_diag( modules[i] );
+    modules[i].parsed = lorina::read_verilog_buffer( infos[i].text, reader, &mod_diag ) == lorina::return_code::success;
+  });
+
+  bool success{true};
+  for ( auto const& m : modules )
+  {
+    for ( auto const& [level, message] : m.diagnostics )
+    {
+      if ( diag )
+      {
+        diag->report( level, message );
+      }
+    }
+    success = success && m.parsed;
+  }
+  if ( !success )
+  {
+    return lorina::return_code::parse_error;
+  }
+
+  /* link the instances to their definitions */
+  std::unordered_map<std::string, uint32_t> index;
+  for ( uint32_t i = 0; i < modules.size(); ++i )
+  {
+    index.emplace( modules[i].name, i );
+  }
+  std::vector<bool> instantiated( modules.size(), false );
+  for ( auto& m : modules )
+  {
+    for ( auto& inst : m.instances )
+    {
+      auto const it = index.find( inst.module );
+      if ( it == index.end() )
+      {
+        if ( diag )
+        {
+          diag->report( lorina::diagnostic_level::error, fmt::format( "module `{0}` is not defined", inst.module ) );
+        }
+        return lorina::return_code::parse_error;
+      }
+      inst.definition = it->second;
+      instantiated[it->second] = true;
+    }
+  }
+
+  uint32_t root = detail::no_instance;
+  if ( !top.empty() )
+  {
+    if ( auto const it = index.find( top ); it != index.end() )
+    {
+      root = it->second;
+    }
+  }
+  else
+  {
+    for ( uint32_t i = 0; i < modules.size(); ++i )
+    {
+      if ( !instantiated[i] )
+      {
+        root = i;
+      }
+    }
+  }
+  if ( root == detail::no_instance )
+  {
+    if ( diag )
+    {
+      diag->report( lorina::diagnostic_level::error, "cannot determine the top module" );
+    }
+    return lorina::return_code::parse_error;
+  }
+
+  /* flatten the top module into `ntk` */
+  std::vector<signal> inputs;
+  for ( uint32_t i = 0; i < modules[root].inputs.size(); ++i )
+  {
+    inputs.emplace_back( ntk.create_pi() );
+  }
+  std::vector<signal> outputs;
+  detail::verilog_flattener<Ntk> flattener( ntk, modules, diag );
+  if ( !flattener.instantiate( root, inputs, outputs ) )
+  {
+    return lorina::return_code::parse_error;
+  }
+  for ( auto const& o : outputs )
+  {
+    ntk.create_po( o );
+  }
+  return lorina::return_code::success;
+}
+
+/* `read_verilog_hierarchy_buffer` on the memory-mapped contents of `filename` */
+template<typename Ntk, typename TaskManager>
+[[nodiscard]] lorina::return_code read_verilog_hierarchy( std::string const& filename, Ntk& ntk, TaskManager& tm,
+                                                          lorina::diagnostic_engine* diag = nullptr, std::string const& top = "" )
+{
+  lorina::detail::mapped_file file( lorina::detail::word_exp_filename( filename ) );
+  if ( !file.is_open() )
+  {
+    if ( diag )
+    {
+      diag->report( lorina::diagnostic_level::fatal, fmt::format( "could not open file `{0}`", filename ) );
+    }
+    return lorina::return_code::parse_error;
+  }
+  return read_verilog_hierarchy_buffer( file.view(), ntk, tm, diag, top );
+}
+
+} /* aig */
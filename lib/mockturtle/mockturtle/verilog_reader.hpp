@@ -1,25 +1,40 @@
 #pragma once
 
 #include <mockturtle/aig.hpp>
+#include <mockturtle/symbol_table.hpp>
 #include <lorina/verilog.hpp>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace aig
 {
 
+/* Builds an AIG from the callbacks of `lorina::read_verilog`.
+ *
+ * Signal names are interned in a `symbol_table`; the signals are kept
+ * in a flat vector indexed by the interned id, so every operand costs
+ * one hash lookup and no string copy.
+ */
+template<typename Ntk = aig::network>
 class verilog_reader : public lorina::verilog_reader
 {
 public:
-  explicit verilog_reader( aig::network& aig )
+  explicit verilog_reader( Ntk& aig )
     : aig_( aig )
-  {}
+  {
+    /* the constants that `lorina::read_verilog` declares as known */
+    define( "0", aig_.get_constant( false ) );
+    define( "1'b0", aig_.get_constant( false ) );
+    define( "1", aig_.get_constant( true ) );
+    define( "1'b1", aig_.get_constant( true ) );
+  }
 
   void on_inputs( const std::vector<std::string>& names, std::string const& size = "" ) const override
   {
     assert( size.empty() );
     for ( const auto& name : names )
     {
-      signals_[name] = aig_.create_pi();
+      define( name, aig_.create_pi() );
     }
   }
 
@@ -36,40 +51,55 @@ public:
   {
     for ( auto const& o : outputs_ )
     {
-      aig_.create_po( signals_[o] );
+      aig_.create_po( signals_[id_of( o )] );
     }
   }
 
-  void on_assign( const std::string& lhs, const std::pair<std::string, bool>& rhs ) const override
+  void on_assign( std::string_view lhs, std::pair<std::string_view, bool> const& rhs ) const override
   {
-    if ( signals_.find( rhs.first ) == std::end( signals_ )  )
-    {
-      fmt::print( stderr, "[w] undefined signal {} assigned 0\n", rhs.first );
-    }
+    auto const r = operand( rhs.first );
+    define( lhs, rhs.second ? aig_.create_not( r ) : r );
+  }
 
-    auto const r = signals_[rhs.first];
-    signals_[lhs] = rhs.second ? aig_.create_not( r ) : r;
+  void on_and( std::string_view lhs, std::pair<std::string_view, bool> const& op1, std::pair<std::string_view, bool> const& op2 ) const override
+  {
+    auto const a = operand( op1.first );
+    auto const b = operand( op2.first );
+    define( lhs, aig_.create_and( op1.second ? aig_.create_not( a ) : a, op2.second ? aig_.create_not( b ) : b ) );
   }
 
-  void on_and( const std::string& lhs, const std::pair<std::string, bool>& op1, const std::pair<std::string, bool>& op2 ) const override
+protected:
+  /* id of `name`, interning it (with a default signal) if needed */
+  uint32_t id_of( std::string_view name ) const
   {
-    if ( signals_.find( op1.first ) == std::end( signals_ ) )
+    uint32_t const id = symbols_.intern( name );
+    if ( id == signals_.size() )
     {
-      fmt::print( stderr, "[w] undefined signal {} assigned 0\n", op1.first );
+      signals_.emplace_back();
     }
-    if ( signals_.find( op2.first ) == std::end( signals_ ) )
+    return id;
+  }
+
+  signal operand( std::string_view name ) const
+  {
+    if ( uint32_t const id = symbols_.find( name ); id != symbol_table::npos )
     {
-      fmt::print( stderr, "[w] undefined signal {} assigned 0\n", op2.first );
+      return signals_[id];
     }
 
-    auto const a = signals_[op1.first];
-    auto const b = signals_[op2.first];
-    signals_[lhs] = aig_.create_and( op1.second ? aig_.create_not( a ) : a, op2.second ? aig_.create_not( b ) : b );
+    fmt::print( stderr, "[w] undefined signal {} assigned 0\n", name );
+    return signals_[id_of( name )];
+  }
+
+  void define( std::string_view name, signal s ) const
+  {
+    signals_[id_of( name )] = s;
   }
 
-private:
-  aig::network& aig_;
-  mutable std::unordered_map<std::string, aig::signal> signals_;
+protected:
+  Ntk& aig_;
+  mutable symbol_table symbols_;
+  mutable std::vector<aig::signal> signals_; /* indexed by symbol id */
   mutable std::vector<std::string> outputs_;
 };
 
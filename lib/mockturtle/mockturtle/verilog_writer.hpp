@@ -0,0 +1,196 @@
+#pragma once
+
+#include "aig.hpp"
+#include "chunked_writer.hpp"
+#include "topological_order.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aig
+{
+
+namespace detail
+{
+
+/* names per line in the port list and the declarations */
+constexpr uint32_t verilog_names_per_line = 16u;
+
+/* `~n3`, `n5`, `1'b0` or `1'b1` */
+inline void append_verilog_operand( fmt::memory_buffer& buf, signal f )
+{
+  if ( f.index == 0 )
+  {
+    append( buf, f.complement ? "1'b1" : "1'b0" );
+    return;
+  }
+  if ( f.complement )
+  {
+    buf.push_back( '~' );
+  }
+  append_name( buf, 'n', f.index );
+}
+
+/* `names` as `n<index>` declarations, one `keyword` statement per line */
+template<typename Names>
+void append_verilog_declarations( fmt::memory_buffer& buf, std::string_view keyword, Names&& names )
+{
+  uint32_t count{0};
+  names( [&]( char prefix, uint64_t id ){
+    append( buf, count == 0u ? "  " : ", " );
+    if ( count == 0u )
+    {
+      append( buf, keyword );
+      buf.push_back( ' ' );
+    }
+    append_name( buf, prefix, id );
+    if ( ++count == verilog_names_per_line )
+    {
+      append( buf, ";\n" );
+      count = 0u;
+    }
+  } );
+  if ( count != 0u )
+  {
+    append( buf, ";\n" );
+  }
+}
+
+template<typename Ntk, typename WriteChunks>
+void write_verilog( Ntk const& ntk, std::ostream& os, WriteChunks&& write_chunks )
+{
+  uint32_t const num_pis = ntk.num_pis();
+  uint32_t const num_pos = ntk.num_pos();
+  std::vector<uint32_t> pis;
+  pis.reserve( num_pis );
+  ntk.foreach_pi( [&]( node n ){ pis.emplace_back( n ); } );
+  std::vector<signal> pos;
+  pos.reserve( num_pos );
+  ntk.foreach_po( [&]( signal f ){ pos.emplace_back( f ); } );
+  std::vector<uint32_t> const gates = topological_gate_order( ntk );
+  uint32_t const num_gates = static_cast<uint32_t>( gates.size() );
+
+  fmt::memory_buffer buf;
+  append( buf, "module top(" );
+  write_chunks( buf, num_pis + num_pos, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    for ( uint32_t i = begin; i < end; ++i )
+    {
+      append( b, i == 0u ? " " : ( i % verilog_names_per_line == 0u ? ",\n    " : ", " ) );
+      if ( i < num_pis )
+      {
+        append_name( b, 'n', pis[i] );
+      }
+      else
+      {
+        append_name( b, 'y', i - num_pis );
+      }
+    }
+  } );
+  append( buf, " );\n" );
+
+  write_chunks( buf, num_pis, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    append_verilog_declarations( b, "input", [&]( auto&& name ){
+      for ( uint32_t i = begin; i < end; ++i )
+      {
+        name( 'n', pis[i] );
+      }
+    } );
+  } );
+  write_chunks( buf, num_pos, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    append_verilog_declarations( b, "output", [&]( auto&& name ){
+      for ( uint32_t i = begin; i < end; ++i )
+      {
+        name( 'y', i );
+      }
+    } );
+  } );
+  write_chunks( buf, num_gates, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    append_verilog_declarations( b, "wire", [&]( auto&& name ){
+      for ( uint32_t g = begin; g < end; ++g )
+      {
+        name( 'n', gates[g] );
+      }
+    } );
+  } );
+
+  write_chunks( buf, num_gates, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    for ( uint32_t g = begin; g < end; ++g )
+    {
+      uint32_t const n = gates[g];
+      append( b, "  assign " );
+      append_name( b, 'n', n );
+      append( b, " = " );
+      ntk.foreach_fanin( node( n ), [&]( signal f, uint32_t i ){
+        if ( i != 0u )
+        {
+          append( b, " & " );
+        }
+        append_verilog_operand( b, f );
+      } );
+      append( b, ";\n" );
+    }
+  } );
+  write_chunks( buf, num_pos, [&]( fmt::memory_buffer& b, uint32_t begin, uint32_t end ){
+    for ( uint32_t i = begin; i < end; ++i )
+    {
+      append( b, "  assign " );
+      append_name( b, 'y', i );
+      append( b, " = " );
+      append_verilog_operand( b, pos[i] );
+      append( b, ";\n" );
+    }
+  } );
+  append( buf, "endmodule\n" );
+  flush( os, buf );
+}
+
+} /* detail */
+
+/* Writes `ntk` as a structural Verilog module `top`.
+ *
+ * Node `n` is named `n<n>` (so the PIs keep their node index) and the
+ * `j`-th PO `y<j>`; each live AND gate becomes one `assign` statement,
+ * in `topological_gate_order`, and dead nodes are left out.  The
+ * text is formatted with `fmt::format_int` into large
+ * `fmt::memory_buffer`s, chunk by chunk, and written with one
+ * `ostream::write` per MB; no string is created per node.  The output
+ * reads back with `lorina::read_verilog` and `aig::verilog_reader`.
+ */
+template<typename Ntk>
+void write_verilog( Ntk const& ntk, std::ostream& os )
+{
+  detail::write_verilog( ntk, os, [&]( fmt::memory_buffer& buf, uint32_t num_items, auto&& fn ){
+    detail::write_chunks( os, buf, num_items, fn );
+  } );
+}
+
+/* Same as `write_verilog`, but formats the chunks in parallel on `tm`;
+ * the output is identical.
+ */
+template<typename Ntk, typename TaskManager>
+void write_verilog( Ntk const& ntk, std::ostream& os, TaskManager& tm )
+{
+  detail::write_verilog( ntk, os, [&]( fmt::memory_buffer& buf, uint32_t num_items, auto&& fn ){
+    detail::write_chunks( os, buf, num_items, fn, tm );
+  } );
+}
+
+template<typename Ntk>
+[[nodiscard]] bool write_verilog( Ntk const& ntk, std::string const& filename )
+{
+  std::ofstream os( filename, std::ofstream::out );
+  if ( !os.is_open() )
+  {
+    return false;
+  }
+  write_verilog( ntk, os );
+  return os.good();
+}
+
+} /* aig */
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "aig.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aig
+{
+
+/* Maximum fanout-free cones and windows.
+ *
+ * Both are computed in place on the reference counts of the network:
+ * the cone of a root is dereferenced (a node whose count drops to 0
+ * belongs to the MFFC) and then referenced again, so the counts are
+ * restored and nothing is copied.  Before a reference count is
+ * touched, its node is claimed with `check_and_mark( n, token )`,
+ * where `token` is the traversal token of the calling worker (see
+ * `traversal_token`).  Hence workers that compute windows at the same
+ * time never touch the same counts: a worker that cannot claim a node
+ * gives up and reports failure.  The claims stay until the worker
+ * releases them all at once with `release_marks`.
+ */
+
+/* nodes of the MFFC of a root (the root first) and its leaves, i.e., the nodes feeding it */
+struct mffc
+{
+  std::vector<node> nodes;
+  std::vector<node> leaves; /* ascending */
+}; /* mffc */
+
+namespace detail
+{
+
+/* Dereferences the cone of `root` and collects the nodes whose count
+ * drops to 0 (without the PIs) into `nodes` and every decremented node
+ * into `decremented`.  The recursion stops at the nodes for which
+ * `is_leaf` holds.  Returns false if a node could not be claimed.
+ */
+template<typename Ntk, typename IsLeaf>
+bool deref_cone( Ntk const& ntk, node root, uint32_t token, IsLeaf&& is_leaf, std::vector<node>& nodes, std::vector<node>& decremented )
+{
+  nodes.push_back( root );
+  for ( uint64_t i = nodes.size() - 1u; i < nodes.size(); ++i )
+  {
+    bool claimed{true};
+    node const n = nodes[i]; /* `nodes` grows below */
+    ntk.foreach_fanin( n, [&]( signal const& f ){
+      node const g = ntk.get_node( f );
+      if ( !ntk.check_and_mark( g, token ) )
+      {
+        claimed = false;
+        return false;
+      }
+      decremented.push_back( g );
+      if ( ntk.decr_fanout_size( g ) == 0u && !ntk.is_pi( g ) && !is_leaf( g ) )
+      {
+        nodes.push_back( g );
+      }
+      return true;
+    });
+    if ( !claimed )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* restores the counts decremented by `deref_cone` */
+template<typename Ntk>
+void ref_cone( Ntk const& ntk, std::vector<node> const& decremented )
+{
+  for ( node const g : decremented )
+  {
+    ntk.incr_fanout_size( g );
+  }
+}
+
+template<typename Nodes>
+void sort_unique( Nodes& nodes )
+{
+  std::sort( nodes.begin(), nodes.end() );
+  nodes.erase( std::unique( nodes.begin(), nodes.end() ), nodes.end() );
+}
+
+} /* detail */
+
+/* Computes the MFFC of the AND gate `root` into `m`.
+ *
+ * Returns false, leaving the reference counts unchanged, if `root` or
+ * one of the nodes it dereferences is claimed by another worker.
+ */
+template<typename Ntk>
+bool compute_mffc( Ntk const& ntk, node root, uint32_t token, mffc& m )
+{
+  assert( !ntk.is_constant( root ) && !ntk.is_pi( root ) );
+  m.nodes.clear();
+  m.leaves.clear();
+  if ( !ntk.check_and_mark( root, token ) )
+  {
+    return false;
+  }
+
+  std::vector<node> decremented;
+  bool const claimed = detail::deref_cone( ntk, root, token, []( node ){ return false; }, m.nodes, decremented );
+  detail::ref_cone( ntk, decremented );
+  if ( !claimed )
+  {
+    m.nodes.clear();
+    return false;
+  }
+
+  /* the decremented nodes outside of the MFFC feed it */
+  std::vector<node> inner( m.nodes );
+  detail::sort_unique( inner );
+  for ( node const g : decremented )
+  {
+    if ( !std::binary_search( inner.begin(), inner.end(), g ) )
+    {
+      m.leaves.push_back( g );
+    }
+  }
+  detail::sort_unique( m.leaves );
+  return true;
+}
+
+/* number of nodes in the MFFC of `root`, or 0 if a node could not be claimed */
+template<typename Ntk>
+uint32_t mffc_size( Ntk const& ntk, node root, uint32_t token )
+{
+  mffc m;
+  return compute_mffc( ntk, root, token, m ) ? static_cast<uint32_t>( m.nodes.size() ) : 0u;
+}
+
+/* A window around a cut: the nodes between the `leaves` and the `root`.
+ *
+ * `nodes` holds the inner nodes including the root in topological
+ * order, `mffc` the ones that are only used inside the window (they
+ * go away if the root is replaced), and `divisors` the leaves and the
+ * inner nodes outside of the MFFC, i.e., the signals a resynthesized
+ * root may use, in topological order.
+ */
+struct window
+{
+  node root;
+  std::vector<node> leaves;   /* ascending */
+  std::vector<node> nodes;    /* ascending, the root last */
+  std::vector<node> mffc;     /* ascending, the root last */
+  std::vector<node> divisors; /* ascending */
+}; /* window */
+
+/* Builds the window of `root` over the cut `leaves` (e.g., a cut of
+ * `create_cut`) into `w`.  PIs that are reached although they are not
+ * leaves become leaves.
+ *
+ * Returns false if a node of the window is claimed by another worker;
+ * the reference counts are always left unchanged.
+ */
+template<typename Ntk>
+bool create_window( Ntk const& ntk, node root, std::span<node const> leaves, uint32_t token, window& w )
+{
+  assert( !ntk.is_constant( root ) && !ntk.is_pi( root ) );
+  w.root = root;
+  w.leaves.assign( leaves.begin(), leaves.end() );
+  detail::sort_unique( w.leaves );
+  w.nodes.clear();
+  w.mffc.clear();
+  w.divisors.clear();
+
+  auto const is_leaf = [&]( node n ){
+    return std::binary_search( w.leaves.begin(), w.leaves.end(), n );
+  };
+
+  /* claim the leaves, then collect the inner nodes from the root down */
+  for ( node const l : w.leaves )
+  {
+    if ( !ntk.check_and_mark( l, token ) )
+    {
+      return false;
+    }
+  }
+  if ( !ntk.check_and_mark( root, token ) )
+  {
+    return false;
+  }
+  std::vector<node> extra_leaves;
+  phmap::flat_hash_set<uint32_t> visited{static_cast<uint32_t>( root )};
+  w.nodes.push_back( root );
+  for ( uint64_t i = 0; i < w.nodes.size(); ++i )
+  {
+    bool claimed{true};
+    node const n = w.nodes[i]; /* `w.nodes` grows below */
+    ntk.foreach_fanin( n, [&]( signal const& f ){
+      node const g = ntk.get_node( f );
+      if ( is_leaf( g ) || !visited.insert( g ).second )
+      {
+        return true;
+      }
+      if ( !ntk.check_and_mark( g, token ) )
+      {
+        claimed = false;
+        return false;
+      }
+      ( ntk.is_pi( g ) || ntk.is_constant( g ) ? extra_leaves : w.nodes ).push_back( g );
+      return true;
+    });
+    if ( !claimed )
+    {
+      return false;
+    }
+  }
+  w.leaves.insert( w.leaves.end(), extra_leaves.begin(), extra_leaves.end() );
+  detail::sort_unique( w.leaves );
+  detail::sort_unique( w.nodes );
+
+  /* the MFFC within the window; all of its nodes are claimed already */
+  std::vector<node> decremented;
+  bool const claimed = detail::deref_cone( ntk, root, token, is_leaf, w.mffc, decremented );
+  detail::ref_cone( ntk, decremented );
+  assert( claimed );
+  (void)claimed;
+  detail::sort_unique( w.mffc );
+
+  w.divisors = w.leaves;
+  for ( node const n : w.nodes )
+  {
+    if ( !std::binary_search( w.mffc.begin(), w.mffc.end(), n ) )
+    {
+      w.divisors.push_back( n );
+    }
+  }
+  detail::sort_unique( w.divisors );
+  return true;
+}
+
+} /* aig */